@@ -0,0 +1,96 @@
+#version 430 core
+
+#define SSAO_SAMPLE_COUNT 32u
+
+// Occlusion and view depth, the depth lets the next frame and the upsampling reject texels of other surfaces
+layout(location = 0) out vec2 ssaoResult;
+
+in vec2 screenUV;
+
+uniform sampler2D u_depthTexture;  // Full resolution depth of the opaque pass
+uniform sampler2D u_historyTexture;
+uniform bool u_historyValid;
+
+uniform vec3 u_kernelSamples[SSAO_SAMPLE_COUNT];
+uniform uint u_sampleCount;  // Each frame takes every n-th kernel sample, starting at a different one
+uniform uint u_frameIndex;
+
+uniform mat4 u_projection;
+uniform mat4 u_inverseProjection;
+uniform mat4 u_viewToPreviousClip;
+
+const float radius = 0.8;
+const float bias = 0.1;
+const float skyDepth = 10000.0;
+const float historyWeight = 0.85;
+const float historyDepthTolerance = 0.05;  // Relative to the view depth
+
+vec3 viewPositionAt(vec2 uv) {
+    float depth = texture(u_depthTexture, uv).r;
+    vec4 position = u_inverseProjection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    return position.xyz / position.w;
+}
+
+vec3 reconstructNormal(vec2 uv, vec3 center) {
+    vec2 texel = 1.0 / vec2(textureSize(u_depthTexture, 0));
+    vec3 right = viewPositionAt(uv + vec2(texel.x, 0.0)) - center;
+    vec3 left = center - viewPositionAt(uv - vec2(texel.x, 0.0));
+    vec3 up = viewPositionAt(uv + vec2(0.0, texel.y)) - center;
+    vec3 down = center - viewPositionAt(uv - vec2(0.0, texel.y));
+
+    // A neighbour across a depth edge lies on another surface, take the side closer in depth
+    vec3 dx = abs(right.z) < abs(left.z) ? right : left;
+    vec3 dy = abs(up.z) < abs(down.z) ? up : down;
+    return normalize(cross(dx, dy));
+}
+
+float interleavedGradientNoise(vec2 pixel) {
+    return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+void main() {
+    if (texture(u_depthTexture, screenUV).r >= 1.0) {
+        ssaoResult = vec2(1.0, skyDepth);
+        return;
+    }
+
+    vec3 fragPos = viewPositionAt(screenUV);
+    vec3 normal = reconstructNormal(screenUV, fragPos);
+
+    // Noise rotating the kernel around the normal, shifted every frame so the accumulated samples differ
+    float angle = 6.2831853 * interleavedGradientNoise(gl_FragCoord.xy + 5.588238 * float(u_frameIndex % 64u));
+    vec3 randomVec = vec3(cos(angle), sin(angle), 0.0);
+    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal) + 0.0001);
+    vec3 biTangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, biTangent, normal);
+
+    uint stride = SSAO_SAMPLE_COUNT / u_sampleCount;
+    uint firstSample = u_frameIndex % stride;
+    float occlusion = 0.0;
+    for (uint i = 0u; i < u_sampleCount; i++) {
+        vec3 samplePos = fragPos + TBN * u_kernelSamples[i * stride + firstSample] * radius;
+
+        vec4 offset = u_projection * vec4(samplePos, 1.0);
+        vec2 texCoord = offset.xy / offset.w * 0.5 + 0.5;
+        vec3 occluderPos = viewPositionAt(texCoord);
+
+        float rangeCheck = smoothstep(0.0, 1.0, radius / length(fragPos - occluderPos));
+        occlusion += (occluderPos.z >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;
+    }
+    float ao = 1.0 - occlusion / float(u_sampleCount);
+
+    // Blend with the previous result at the same surface point, rejected if another surface was visible there
+    if (u_historyValid) {
+        vec4 previousClip = u_viewToPreviousClip * vec4(fragPos, 1.0);
+        vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+        if (all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0)))) {
+            vec2 history = texture(u_historyTexture, previousUV).rg;
+            float previousDepth = previousClip.w;  // View depth in the previous frame
+            if (abs(history.g - previousDepth) < historyDepthTolerance * previousDepth) {
+                ao = mix(ao, history.r, historyWeight);
+            }
+        }
+    }
+
+    ssaoResult = vec2(ao, -fragPos.z);
+}
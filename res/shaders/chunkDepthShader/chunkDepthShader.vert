@@ -1,18 +1,37 @@
 #version 430 core
 
+#ifdef CHUNK_QUAD_FORMAT
+layout(location = 0) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#else
 layout(location = 0) in uint compressedData1;
+layout(location = 2) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#endif
 
 uniform mat4 u_viewProjection;
-uniform vec3 u_chunkPosition;
+
+// Per draw data of the chunk geometry arena, indexed by drawIndex
+layout(std430) readonly buffer ChunkDrawDataBlock {
+    vec4 chunkPositions[];
+};
 
 #define POSITION_BITMASK  0x3Fu
 #define X_POSITION_OFFSET 26
 #define Y_POSITION_OFFSET 20
 #define Z_POSITION_OFFSET 14
 
+#define NORMAL_BITMASK 0x07u
+#define NORMAL_OFFSET 0
+
 #define SET_BITS(target, value, bitmask, position) (target = (target & ~(bitmask << position)) | ((value & bitmask) << position))
 #define GET_BITS(target, bitmask, position) ((target >> position) & bitmask)
 
+#define PositiveX 0u
+#define NegativeX 1u
+#define PositiveY 2u
+#define NegativeY 3u
+#define PositiveZ 4u
+#define NegativeZ 5u
+
 vec3 decodePosition(uint compressedData) {
     uvec3 pos;
     pos.x = GET_BITS(compressedData, POSITION_BITMASK, X_POSITION_OFFSET);
@@ -21,9 +40,18 @@ vec3 decodePosition(uint compressedData) {
     return vec3(pos);
 }
 
+#ifdef CHUNK_QUAD_FORMAT
+#include "common/chunkQuadLayout.glsl"
+#endif
+
 void main() {
+#ifdef CHUNK_QUAD_FORMAT
+	vec2 cornerUV;
+	vec3 localPosInChunk = expandQuadCorner(quads[gl_VertexID / 6], QUAD_CORNERS[gl_VertexID % 6], cornerUV);
+#else
 	vec3 localPosInChunk = decodePosition(compressedData1);
-	vec3 worldVertexPos = u_chunkPosition + localPosInChunk;
+#endif
+	vec3 worldVertexPos = chunkPositions[drawIndex].xyz + localPosInChunk;
 
 	gl_Position = u_viewProjection * vec4(worldVertexPos, 1.0);
 }
\ No newline at end of file
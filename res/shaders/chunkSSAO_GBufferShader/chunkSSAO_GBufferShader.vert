@@ -1,14 +1,23 @@
 #version 430 core
 
+#ifdef CHUNK_QUAD_FORMAT
+layout(location = 0) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#else
 layout(location = 0) in uint compressedData1;
 layout(location = 1) in uint compressedData2;
+layout(location = 2) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#endif
 
 out vec3 position;
 flat out vec3 normal;
 
 uniform mat4 u_view;
 uniform mat4 u_projection;
-uniform vec3 u_chunkPosition;
+
+// Per draw data of the chunk geometry arena, indexed by drawIndex
+layout(std430) readonly buffer ChunkDrawDataBlock {
+    vec4 chunkPositions[];
+};
 
 #define POSITION_BITMASK  0x3Fu
 #define X_POSITION_OFFSET 26
@@ -49,11 +58,22 @@ vec3 decodeNormal(uint compressedData) {
     }
 }
 
+#ifdef CHUNK_QUAD_FORMAT
+#include "common/chunkQuadLayout.glsl"
+#endif
+
 void main() {
+#ifdef CHUNK_QUAD_FORMAT
+    uvec2 quad = quads[gl_VertexID / 6];
+    vec2 cornerUV;
+    vec3 localPosInChunk = expandQuadCorner(quad, QUAD_CORNERS[gl_VertexID % 6], cornerUV);
+    vec3 decodedNormal = decodeNormal(quad.y);
+#else
     vec3 localPosInChunk = decodePosition(compressedData1);
     vec3 decodedNormal = decodeNormal(compressedData2);
+#endif
 
-    vec3 worldVertexPos = u_chunkPosition + localPosInChunk;
+    vec3 worldVertexPos = chunkPositions[drawIndex].xyz + localPosInChunk;
 
     gl_Position = u_projection * u_view * vec4(worldVertexPos, 1.0);
 
@@ -1,6 +1,11 @@
 #version 430 core
 
-#define MAX_LIGHTS 84
+#define MAX_LIGHTS 256
+
+#define LIGHT_CLUSTERS_X 16u
+#define LIGHT_CLUSTERS_Y 9u
+#define LIGHT_CLUSTERS_Z 24u
+#define LIGHT_CLUSTER_NEAR_DEPTH 1.0
 
 #define DIRECTIONALLIGHT 0u
 #define SPOTLIGHT 1u
@@ -10,13 +15,14 @@ in vec3 position;
 flat in uint texIndex;
 in vec2 uv;
 flat in vec3 normal;
+in float vertexOcclusion;
 
 layout(location = 0) out vec4 outColor;
 
 struct Light {
     uint lightType;
-    uint priority;
-    uint shadowMapIndex;
+    uint shadowAtlasPage;
+    uint shadowTile; // x | y << 8 | size << 16, in multiples of u_shadowTileUnit
     float intensity;
     vec3 lightPosition;
     float range; // Used by point- / spotlight
@@ -41,12 +47,26 @@ uniform vec3 u_cameraPosition;
 
 uniform int u_lightCount;
 
+// Offset and count of the light indices of each cluster
+layout(std430) readonly buffer LightClusterBlock {
+    uvec2 u_lightClusters[];
+};
+
+layout(std430) readonly buffer LightIndexBlock {
+    uint u_lightIndices[];
+};
+
+uniform bool u_lightClustersEnabled;
+uniform vec2 u_lightClusterDepthParams;
+uniform vec3 u_cameraForward;
+
 uniform sampler2D u_ssaoTexture;
+uniform bool u_ssaoEnabled;
 uniform uvec2 u_screenResolution;
 
 uniform sampler2D u_shadowMapAtlas[3];
 uniform uint u_shadowMapAtlasSizes[3];
-uniform uint u_shadowMapSizes[3];
+uniform uint u_shadowTileUnit;
 
 vec4 sampleFromTexAtlas(vec2 uv_coord) {
     float textureScale = float(u_textureSize) / float(u_textureAtlasSize);
@@ -62,8 +82,8 @@ vec3 calcLightContribution(int lightIndex) {
     vec4 lightSpacePosition = u_lightViewProjections[lightIndex] * vec4(position, 1.0);
 
     uint lightType = u_lights[lightIndex].lightType;
-    uint priority = u_lights[lightIndex].priority;
-    uint shadowMapIndex = u_lights[lightIndex].shadowMapIndex;
+    uint shadowAtlasPage = u_lights[lightIndex].shadowAtlasPage;
+    uint shadowTile = u_lights[lightIndex].shadowTile;
     vec3 lightPosition = u_lights[lightIndex].lightPosition;
     vec3 direction = u_lights[lightIndex].direction;
     vec3 color = u_lights[lightIndex].color;
@@ -82,19 +102,14 @@ vec3 calcLightContribution(int lightIndex) {
         return vec3(0.0); // In shadow
     }
 
-    // Calculate the shadow map atlas layout for this light
-    float shadowMapSize = float(u_shadowMapSizes[priority]);
-
-    // Compute the number of shadow maps per row in the atlas
-    float shadowAtlasSize = float(u_shadowMapAtlasSizes[priority]);
-    float tilesPerRow = shadowAtlasSize / shadowMapSize;
-
-    // Determine the light's position in the shadow map atlas
-    vec2 lightShadomapPos = vec2(mod(float(shadowMapIndex), tilesPerRow), floor(float(shadowMapIndex) / tilesPerRow));
+    // Decode the light's tile in its shadow map atlas page
+    float shadowAtlasSize = float(u_shadowMapAtlasSizes[shadowAtlasPage]);
+    float tileUnit = float(u_shadowTileUnit) / shadowAtlasSize;
+    vec2 tileMin = vec2(float(shadowTile & 0xFFu), float((shadowTile >> 8) & 0xFFu)) * tileUnit;
+    vec2 shadowMapScale = vec2(float(shadowTile >> 16) * tileUnit);
 
-    // Offset the lightSpaceCoord to target the correct tile in the atlas
-    vec2 shadowMapScale = vec2(shadowMapSize / shadowAtlasSize);
-    vec2 atlasUV = lightSpaceCoord.xy / tilesPerRow + lightShadomapPos * shadowMapScale;
+    // Offset the lightSpaceCoord to target the tile in the atlas
+    vec2 atlasUV = tileMin + lightSpaceCoord.xy * shadowMapScale;
 
     // PCF shadow sampling
     float lightFactor = 0.0;
@@ -102,7 +117,6 @@ vec3 calcLightContribution(int lightIndex) {
     float currentDepth = lightSpaceCoord.z;
 
     vec2 texelSize = vec2(1.0) / shadowAtlasSize; // Size of a single texel in shadow atlas
-    vec2 tileMin = lightShadomapPos * shadowMapScale;
     vec2 tileMax = tileMin + shadowMapScale;
     float validSamples = 0;
     for(int x = -1; x <= 1; x++) {
@@ -112,7 +126,7 @@ vec3 calcLightContribution(int lightIndex) {
 
             // Stay inside the tile
             if(all(greaterThanEqual(sampleUV, tileMin)) && all(lessThan(sampleUV, tileMax))) {
-                float pcfDepth = texture(u_shadowMapAtlas[priority], sampleUV).r;
+                float pcfDepth = texture(u_shadowMapAtlas[shadowAtlasPage], sampleUV).r;
                 lightFactor += (currentDepth <= pcfDepth + bias) ? 1.0 : 0.0;
                 validSamples += 1.0;
             }
@@ -152,6 +166,21 @@ vec3 calcLightContribution(int lightIndex) {
     }
 }
 
+uvec2 lightClusterOfFragment() {
+    uvec2 tile = uvec2(gl_FragCoord.xy / vec2(u_screenResolution) * vec2(LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y));
+    tile = min(tile, uvec2(LIGHT_CLUSTERS_X - 1u, LIGHT_CLUSTERS_Y - 1u));
+
+    // Slices past the first one are spaced logarithmically
+    float depth = dot(position - u_cameraPosition, u_cameraForward);
+    uint slice = 0u;
+    if(depth > LIGHT_CLUSTER_NEAR_DEPTH) {
+        float logSlice = log(depth) * u_lightClusterDepthParams.x + u_lightClusterDepthParams.y;
+        slice = min(uint(max(logSlice, 0.0)) + 1u, LIGHT_CLUSTERS_Z - 1u);
+    }
+
+    return u_lightClusters[(slice * LIGHT_CLUSTERS_Y + tile.y) * LIGHT_CLUSTERS_X + tile.x];
+}
+
 void main() {
     vec2 uv_frag = fract(uv); // Effectively modulo for repeating texture on faces larger 1
 
@@ -165,13 +194,22 @@ void main() {
 
     // Initialize shadow factor
     vec3 lightContrib = vec3(0.0);
-    for(int i = 0; i < u_lightCount; i++) {
-        // Accumulate light contribution
-        lightContrib += calcLightContribution(i);
+    if(u_lightClustersEnabled) {
+        // Only lights reaching the cluster of this fragment
+        uvec2 cluster = lightClusterOfFragment();
+        for(uint i = 0u; i < cluster.y; i++) {
+            lightContrib += calcLightContribution(int(u_lightIndices[cluster.x + i]));
+        }
+    } else {
+        for(int i = 0; i < u_lightCount; i++) {
+            // Accumulate light contribution
+            lightContrib += calcLightContribution(i);
+        }
     }
 
     vec2 screenUV = gl_FragCoord.xy / vec2(u_screenResolution);
-    float occlusion = texture(u_ssaoTexture, screenUV).r;  // SSAO value [0, 1]
+    float occlusion = u_ssaoEnabled ? texture(u_ssaoTexture, screenUV).r : 1.0;  // SSAO value [0, 1]
+    occlusion *= vertexOcclusion;
     color = ((0.15 * color) + (0.85 * clamp(lightContrib * color, 0.0, 1.0))) * occlusion;
 
     // Gradual fade to black for distant elements
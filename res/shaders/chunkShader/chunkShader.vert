@@ -1,23 +1,35 @@
 #version 430 core
 
+#ifdef CHUNK_QUAD_FORMAT
+layout(location = 0) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#else
 layout(location = 0) in uint compressedPosition;
 layout(location = 1) in uint compressedData;
+layout(location = 2) in uint drawIndex; // Per instance, equals the baseInstance of the indirect draw
+#endif
 
 out vec3 position;
 flat out uint texIndex;
 out vec2 uv;
 flat out vec3 normal;
+out float vertexOcclusion; // Baked ambient occlusion, 1.0 if unoccluded
 
 uniform mat4 u_viewProjection;
-uniform vec3 u_chunkPosition;
+
+// Per draw data of the chunk geometry arena, indexed by drawIndex
+layout(std430) readonly buffer ChunkDrawDataBlock {
+    vec4 chunkPositions[];
+};
 
 #define POSITION_BITMASK  0x3Fu
 #define X_POSITION_OFFSET 26
 #define Y_POSITION_OFFSET 20
 #define Z_POSITION_OFFSET 14
 
-#define ANIMATION_FRAME_COUNT_BITMASK   0xFFu
-#define ANIMATION_FRAME_COUNT_OFFSET    6
+#define ANIMATION_FRAME_COUNT_BITMASK   0x3Fu
+#define ANIMATION_FRAME_COUNT_OFFSET    8
+#define OCCLUSION_BITMASK               0x03u
+#define OCCLUSION_OFFSET                6
 #define ANIMATION_FPS_BITMASK           0x3Fu
 #define ANIMATION_FPS_OFFSET            0
 
@@ -42,6 +54,9 @@ uniform vec3 u_chunkPosition;
 #define PositiveZ 4u
 #define NegativeZ 5u
 
+// Brightness for each baked occlusion level
+const float OCCLUSION_BRIGHTNESS[4] = float[4](1.0, 0.75, 0.55, 0.4);
+
 vec3 decodePosition(uint compressedData) {
     uvec3 pos;
     pos.x = GET_BITS(compressedData, POSITION_BITMASK, X_POSITION_OFFSET);
@@ -73,17 +88,45 @@ vec3 decodeNormal(uint compressedData) {
     }
 }
 
+#ifdef CHUNK_QUAD_FORMAT
+#include "common/chunkQuadLayout.glsl"
+
+const uint QUAD_CORNERS_FLIPPED[6] = uint[6](1u, 2u, 3u, 3u, 0u, 1u);
+
+uint cornerOcclusion(uvec2 quad, uint corner) {
+    return GET_BITS(quad.x, OCCLUSION_BITMASK, OCCLUSION_OFFSET + 2u * corner);
+}
+#endif
+
 void main() {
+#ifdef CHUNK_QUAD_FORMAT
+    uvec2 quad = quads[gl_VertexID / 6];
+
+    // Same diagonal as the index buffer of the vertex format, through the more occluded corners
+    uint diagonal02 = cornerOcclusion(quad, 0u) + cornerOcclusion(quad, 2u);
+    uint diagonal13 = cornerOcclusion(quad, 1u) + cornerOcclusion(quad, 3u);
+    bool flipped = diagonal02 < diagonal13;
+    uint corner = flipped ? QUAD_CORNERS_FLIPPED[gl_VertexID % 6] : QUAD_CORNERS[gl_VertexID % 6];
+
+    vec2 decodedUV;
+    vec3 localPosInChunk = expandQuadCorner(quad, corner, decodedUV);
+    uint occlusionLevel = cornerOcclusion(quad, corner);
+    // Tex index and normal share the vertex format's layout
+    uint compressedData = quad.y;
+#else
     vec3 localPosInChunk = decodePosition(compressedPosition);
-    uint decodedTexIndex = decodeTexIndex(compressedData);
     vec2 decodedUV = decodeUV(compressedData);
+    uint occlusionLevel = GET_BITS(compressedPosition, OCCLUSION_BITMASK, OCCLUSION_OFFSET);
+#endif
+    uint decodedTexIndex = decodeTexIndex(compressedData);
     vec3 decodedNormal = decodeNormal(compressedData);
 
-    vec3 worldVertexPos = u_chunkPosition + localPosInChunk;
+    vec3 worldVertexPos = chunkPositions[drawIndex].xyz + localPosInChunk;
 
     gl_Position = u_viewProjection * vec4(worldVertexPos, 1.0);
     position = worldVertexPos;
     texIndex = decodedTexIndex;
     uv = decodedUV;
     normal = decodedNormal;
+    vertexOcclusion = OCCLUSION_BRIGHTNESS[occlusionLevel];
 }
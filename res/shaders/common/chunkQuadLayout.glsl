@@ -0,0 +1,46 @@
+// Quad record layout of the compact chunk vertex format, shared by all chunk shaders drawing CHUNK_QUAD_FORMAT.
+// Position, normal, face direction and GET_BITS defines are taken from the including shader.
+
+// Quad records of the chunk geometry arena, every quad is expanded into two triangles using gl_VertexID
+layout(std430) readonly buffer ChunkQuadBlock {
+    uvec2 quads[];
+};
+
+#define QUAD_WIDTH_BITMASK  0x1Fu
+#define QUAD_WIDTH_OFFSET   11
+#define QUAD_HEIGHT_BITMASK 0x1Fu
+#define QUAD_HEIGHT_OFFSET  6
+
+const uint QUAD_CORNERS[6] = uint[6](0u, 1u, 2u, 2u, 3u, 0u);
+
+// Corner order and uvs mirror generateCompactChunkFace of the vertex format
+vec3 expandQuadCorner(uvec2 quad, uint corner, out vec2 cornerUV) {
+    uint w = GET_BITS(quad.y, QUAD_WIDTH_BITMASK, QUAD_WIDTH_OFFSET) + 1u;
+    uint h = GET_BITS(quad.y, QUAD_HEIGHT_BITMASK, QUAD_HEIGHT_OFFSET) + 1u;
+    uint normalCode = GET_BITS(quad.y, NORMAL_BITMASK, NORMAL_OFFSET);
+
+    uvec3 corners[4];
+    switch (normalCode) {
+        case PositiveX: corners = uvec3[4](uvec3(1u, w, h), uvec3(1u, w, 0u), uvec3(1u, 0u, 0u), uvec3(1u, 0u, h)); break;
+        case NegativeX: corners = uvec3[4](uvec3(0u, w, 0u), uvec3(0u, w, h), uvec3(0u, 0u, h), uvec3(0u)); break;
+        case PositiveY: corners = uvec3[4](uvec3(0u, 1u, 0u), uvec3(h, 1u, 0u), uvec3(h, 1u, w), uvec3(0u, 1u, w)); break;
+        case NegativeY: corners = uvec3[4](uvec3(0u, 0u, w), uvec3(h, 0u, w), uvec3(h, 0u, 0u), uvec3(0u)); break;
+        case PositiveZ: corners = uvec3[4](uvec3(0u, h, 1u), uvec3(w, h, 1u), uvec3(w, 0u, 1u), uvec3(0u, 0u, 1u)); break;
+        default:        corners = uvec3[4](uvec3(w, h, 0u), uvec3(0u, h, 0u), uvec3(0u), uvec3(w, 0u, 0u)); break;
+    }
+
+    // Same uv quickfix as on the cpu side, z faces swap width and height
+    if (normalCode == PositiveZ || normalCode == NegativeZ) {
+        uint tmp = w;
+        w = h;
+        h = tmp;
+    }
+    vec2 uvs[4] = vec2[4](vec2(0.0), vec2(h, 0.0), vec2(h, w), vec2(0.0, w));
+    cornerUV = uvs[corner];
+
+    uvec3 origin;
+    origin.x = GET_BITS(quad.x, POSITION_BITMASK, X_POSITION_OFFSET);
+    origin.y = GET_BITS(quad.x, POSITION_BITMASK, Y_POSITION_OFFSET);
+    origin.z = GET_BITS(quad.x, POSITION_BITMASK, Z_POSITION_OFFSET);
+    return vec3(origin + corners[corner]);
+}
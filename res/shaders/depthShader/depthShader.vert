@@ -1,9 +1,16 @@
 #version 430 core
 
+#define MAX_INSTANCES 128
+
 layout(location = 0) in vec3 v_position;
 
 uniform mat4 u_viewProjection;
 
+// Model matrices of the drawn instances, streamed per draw through the frame constant ring
+layout(std140) uniform InstanceConstants {
+    mat4 u_models[MAX_INSTANCES];
+};
+
 void main() {
-	gl_Position = u_viewProjection * vec4(v_position, 1.0);
+	gl_Position = u_viewProjection * u_models[gl_InstanceID] * vec4(v_position, 1.0);
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 
 layout(location = 0) in vec3 v_position;
 
-uniform mat4 u_mvp;
+// Streamed per draw through the frame constant ring
+layout(std140) uniform ObjectConstants {
+    mat4 u_mvp;
+};
 
 void main() {
     gl_Position = u_mvp * vec4(v_position, 1.0);
@@ -7,9 +7,52 @@ layout(location = 0) out vec4 outColor;
 uniform sampler2D u_opaquePassResult;
 uniform sampler2D u_transparencyAccumTexture;
 uniform sampler2D u_transparencyRevealTexture;
+uniform bool u_hasTransparency;
+
+uniform sampler2D u_ambientOcclusionTexture;  // Half resolution occlusion and view depth
+uniform sampler2D u_sceneDepthTexture;
+uniform vec2 u_depthUnproject;  // Projection terms mapping depth back to view depth
+uniform bool u_hasAmbientOcclusion;
+
+float viewDepth(float depth) {
+    return u_depthUnproject.y / (depth * 2.0 - 1.0 + u_depthUnproject.x);
+}
+
+// Bilinear upsampling, texels of surfaces at another depth are weighted down so occlusion does not bleed over edges
+float upsampleOcclusion() {
+    float depth = texture(u_sceneDepthTexture, screenUV).r;
+    if (depth >= 1.0) return 1.0;
+
+    float pixelDepth = viewDepth(depth);
+    vec2 occlusionSize = vec2(textureSize(u_ambientOcclusionTexture, 0));
+    vec2 texelPos = screenUV * occlusionSize - 0.5;
+    vec2 base = floor(texelPos);
+    vec2 fraction = texelPos - base;
+
+    float occlusion = 0.0;
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vec2 offset = vec2(i & 1, i >> 1);
+        vec2 texel = texture(u_ambientOcclusionTexture, (base + offset + 0.5) / occlusionSize).rg;
+        vec2 bilinear = mix(1.0 - fraction, fraction, offset);
+        float depthWeight = 1.0 / (0.001 + abs(texel.g - pixelDepth) / pixelDepth);
+        float weight = bilinear.x * bilinear.y * depthWeight;
+        occlusion += texel.r * weight;
+        weightSum += weight;
+    }
+    return occlusion / max(weightSum, 0.0001);
+}
 
 void main() {
     vec3 opaqueColor = texture(u_opaquePassResult, screenUV).rgb;
+    if (u_hasAmbientOcclusion) {
+        opaqueColor *= upsampleOcclusion();
+    }
+    if (!u_hasTransparency) {
+        outColor = vec4(opaqueColor, 1.0);
+        return;
+    }
+
     vec4 accum = texture(u_transparencyAccumTexture, screenUV);
     float reveal = texture(u_transparencyRevealTexture, screenUV).r;
 
@@ -17,4 +60,4 @@ void main() {
     vec3 avgColor = accum.rgb / max(accum.a, 0.0001);
     vec3 finalColor = mix(opaqueColor, avgColor, (1.0 - reveal));
     outColor = vec4(finalColor, 1.0);
-}
\ No newline at end of file
+}
@@ -1,13 +1,20 @@
 #version 430 core
 
+#define MAX_INSTANCES 128
+
 layout(location = 0) in vec3 v_position;
 layout(location = 1) in vec2 v_uv;
 
 out vec2 uv;
 
-uniform mat4 u_mvp;
+uniform mat4 u_viewProjection;
+
+// Model matrices of the drawn instances, streamed per draw through the frame constant ring
+layout(std140) uniform InstanceConstants {
+    mat4 u_models[MAX_INSTANCES];
+};
 
 void main() {
-	gl_Position = u_mvp * vec4(v_position, 1.0);
+	gl_Position = u_viewProjection * u_models[gl_InstanceID] * vec4(v_position, 1.0);
 	uv = v_uv;
 }
\ No newline at end of file
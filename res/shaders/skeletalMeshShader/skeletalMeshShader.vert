@@ -15,7 +15,10 @@ layout(std140) uniform JointMatrices {
 out vec2 uv;
 out vec3 normal;
 
-uniform mat4 u_mvp;
+// Streamed per draw through the frame constant ring
+layout(std140) uniform ObjectConstants {
+    mat4 u_mvp;
+};
 
 void main() {
     // Each vertex is influenced by up to 4 joints
@@ -5,7 +5,10 @@ layout(location = 1) in vec2 v_uv;
 
 out vec2 uv;
 
-uniform mat4 u_mvp;
+// Streamed per draw through the frame constant ring
+layout(std140) uniform ObjectConstants {
+    mat4 u_mvp;
+};
 
 void main() {
 	gl_Position = u_mvp * vec4(v_position, 1.0);
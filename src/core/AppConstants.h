@@ -11,6 +11,7 @@ namespace Res {
         constexpr const char* LINE = "res/shaders/lineShader";
         constexpr const char* SSAO_PASS = "res/shaders/SSAO_PassShader";
         constexpr const char* SSAO_BLUR = "res/shaders/SSAO_BlurShader";
+        constexpr const char* SSAO_DEPTH = "res/shaders/SSAO_DepthShader";
         constexpr const char* SKELETAL_MESH = "res/shaders/skeletalMeshShader";
         constexpr const char* TRANSPARENT = "res/shaders/transparencyShader";
         constexpr const char* RESOLVER = "res/shaders/resolverShader";
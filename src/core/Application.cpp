@@ -5,6 +5,7 @@
 #include "AppConstants.h"
 #include "Logger.h"
 #include "engine/GameInstance.h"
+#include "engine/env/Chunk.h"
 #include "engine/rendering/Renderer.h"
 #include "engine/resource/providers/CPUAssetProvider.h"
 #include "engine/ui/AboutScreen.h"
@@ -37,6 +38,13 @@ void Application::updateStats(float deltaTime) {
     context->stats.processUsedBytes = getProcessUsedBytes();
     context->stats.processIo = getProcessIO();
     context->stats.cpuTimes = currentCpuTimes;
+
+    uint64_t blockBytesCopied = BlockStorageStats::copiedBytes.load(std::memory_order_relaxed);
+    uint64_t blockBytesShared = BlockStorageStats::sharedBytes.load(std::memory_order_relaxed);
+    context->stats.blockBytesCopiedPerSecond = (blockBytesCopied - context->stats.blockBytesCopied) / deltaTime;
+    context->stats.blockBytesSharedPerSecond = (blockBytesShared - context->stats.blockBytesShared) / deltaTime;
+    context->stats.blockBytesCopied = blockBytesCopied;
+    context->stats.blockBytesShared = blockBytesShared;
 }
 
 void Application::createContext() {
@@ -62,8 +70,8 @@ void Application::deleteContext() {
     if (ApplicationContext* context = Application::currentContext) {
         delete context->timer;
         delete context->provider;
+        delete context->instance;  // <- Before renderer, pending chunk uploads may still reference its staging ring
         delete context->renderer;
-        delete context->instance;
         delete context->audioEngine;
         delete context->workerPool;  // <- May clean up remaining opengl ressources here
         delete context->inputManager;
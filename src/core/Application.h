@@ -25,6 +25,10 @@ struct ApplicationContext {
         MemoryInfo memInfo;
         ProcessIO processIo;
         CpuTimes cpuTimes;
+        uint64_t blockBytesCopied;  // Totals of the block storage, see BlockStorageStats
+        uint64_t blockBytesShared;
+        float blockBytesCopiedPerSecond;
+        float blockBytesSharedPerSecond;
     } stats;
 
     class Timer* timer;
@@ -29,7 +29,12 @@
 #include "rendering/StaticMesh.h"
 #include "foundation/threading/Future.h"
 
-GameInstance::GameInstance() : m_playerController(nullptr), m_player(nullptr), m_world(nullptr) {}
+GameInstance::GameInstance()
+    : m_playerController(nullptr),
+      m_player(nullptr),
+      m_world(nullptr),
+      m_particlesProxy(nullptr),
+      m_focusedBlockOutlineProxy(nullptr) {}
 
 GameInstance::~GameInstance() { deinitWorld(); }
 
@@ -44,7 +49,8 @@ void GameInstance::initializeWorld(World* newWorld) {
         m_playerController = new PlayerController;
         m_player = new Player;
         m_world = newWorld;
-        m_world->setChunkLoadingDistance(3);
+        // Loaded chunks keep their full resolution blocks, beyond this distance they cost more memory than triangles
+        m_world->setChunkLoadingDistance(6);
         m_playerController->possess(m_player);
 
         CPUAssetProvider* provider = Application::getContext()->provider;
@@ -68,11 +74,12 @@ void GameInstance::initializeWorld(World* newWorld) {
         }
 
         Future<Shader> shader = build(provider->getShader(Res::Shader::SIMPLE));
+        Future<Shader> depthShader = build(provider->getShader(Res::Shader::DEPTH));
         Future<Shader> transparentShader = build(provider->getShader(Res::Shader::TRANSPARENT));
         Future<Texture> texture = build(provider->getTexture(Res::Texture::TESTBLOCK_TEXTURE));
 
         std::shared_ptr<Material> testMaterial1 = std::make_shared<SimpleMaterial>(
-            shader, transparentShader, glm::vec3(0.0f), texture
+            shader, depthShader, transparentShader, glm::vec3(0.0f), texture
         );
         std::shared_ptr<Material> testMaterial2 = std::make_shared<TransparentMaterial>(
             transparentShader, glm::vec4(0.5f, 0.5f, 0.0f, 0.8f)
@@ -80,14 +87,15 @@ void GameInstance::initializeWorld(World* newWorld) {
         std::shared_ptr<Material> testMaterial3 = std::make_shared<TransparentMaterial>(
             transparentShader, glm::vec4(0.2f, 0.1f, 0.7f, 0.4f)
         );
-        Future<CPURenderData<Vertex>> cpuStaticMesh = provider->getStaticMesh(Res::Model::TEST_UNIT_BLOCK);
-        m_mesh1 = std::make_shared<StaticMesh>(build(cpuStaticMesh));
+        // Uploaded once, the meshes share its render data
+        Future<StaticMesh::Internal> unitBlockMesh = build(provider->getStaticMesh(Res::Model::TEST_UNIT_BLOCK));
+        m_mesh1 = std::make_shared<StaticMesh>(unitBlockMesh);
         m_mesh1->assignMaterial(testMaterial1);
 
-        m_mesh2 = std::make_shared<StaticMesh>(build(cpuStaticMesh));
+        m_mesh2 = std::make_shared<StaticMesh>(unitBlockMesh);
         m_mesh2->assignMaterial(testMaterial2);
 
-        m_mesh3 = std::make_shared<StaticMesh>(build(cpuStaticMesh));
+        m_mesh3 = std::make_shared<StaticMesh>(unitBlockMesh);
         m_mesh3->assignMaterial(testMaterial3);
 
         m_mesh1->getLocalTransform().setPosition(glm::vec3(0.0f, 10.0f, 0.0f));
@@ -144,10 +152,31 @@ void GameInstance::initializeWorld(World* newWorld) {
             std::make_shared<ParticleMaterial>(particleShader, particleTfShader, build(cpuTestBlockTextures))
         );
         m_particles->getLocalTransform().setPosition(glm::vec3(10.0f, 12.0f, 5.0f));
+
+        RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+        m_movingProxies = {
+            scene.addProxy(m_mesh1.get()), scene.addProxy(m_mesh2.get()), scene.addProxy(m_mesh3.get()),
+            scene.addProxy(m_skeletalMesh.get())
+        };
+        m_particlesProxy = scene.addProxy(m_particles.get());
+        m_focusedBlockOutlineProxy = scene.addProxy(m_focusedBlockOutline.get());
     }
 }
 
 void GameInstance::deinitWorld() {
+    m_stressLights.clear();
+    removeStressProps();
+    if (m_particlesProxy) {
+        RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+        for (RenderProxy* proxy : m_movingProxies) {
+            scene.removeProxy(proxy);
+        }
+        m_movingProxies.clear();
+        scene.removeProxy(m_particlesProxy);
+        m_particlesProxy = nullptr;
+        scene.removeProxy(m_focusedBlockOutlineProxy);
+        m_focusedBlockOutlineProxy = nullptr;
+    }
     if (m_playerController) {
         delete m_playerController;
         m_playerController = nullptr;
@@ -167,6 +196,53 @@ void GameInstance::deinitWorld() {
     }
 }
 
+void GameInstance::setLightStressTestEnabled(bool enabled) {
+    m_stressLights.clear();
+    if (!enabled) return;
+
+    // 15 x 15 lights, 6 blocks apart, pointing straight down
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> colorDist(0.3f, 1.0f);
+    for (int x = 0; x < 15; x++) {
+        for (int z = 0; z < 15; z++) {
+            glm::vec3 color(colorDist(generator), colorDist(generator), colorDist(generator));
+            auto light = std::make_shared<Spotlight>(color, 1.5f, 70.0f, 14.0f);
+            light->setInnerCutoffAngle(40.0f);
+
+            glm::vec3 position(static_cast<float>(x - 7) * 6.0f, 12.0f, static_cast<float>(z - 7) * 6.0f);
+            light->getLocalTransform().setPosition(position);
+            light->getLocalTransform().lookAt(position + glm::vec3(0.01f, -1.0f, 0.0f));
+            m_stressLights.push_back(light);
+        }
+    }
+}
+
+void GameInstance::removeStressProps() {
+    RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+    for (RenderProxy* proxy : m_stressPropProxies) {
+        scene.removeProxy(proxy);
+    }
+    m_stressPropProxies.clear();
+    m_stressProps.clear();
+}
+
+void GameInstance::setPropStressTestEnabled(bool enabled) {
+    removeStressProps();
+    if (!enabled) return;
+
+    // 48 x 48 blocks, 2 blocks apart, all instances of the first test mesh
+    RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+    for (int x = 0; x < 48; x++) {
+        for (int z = 0; z < 48; z++) {
+            auto prop = std::make_shared<StaticMesh>(m_mesh1->getAssetHandle(), m_mesh1->getMaterial());
+            prop->getLocalTransform().setPosition(glm::vec3(x - 24, 0, z - 24) * 2.0f + glm::vec3(0.0f, 20.0f, 0.0f));
+            prop->getLocalTransform().setScale(0.5f);
+            m_stressProps.push_back(prop);
+            m_stressPropProxies.push_back(scene.addProxy(prop.get()));
+        }
+    }
+}
+
 void GameInstance::pushWorldRenderData() {
     ApplicationContext* context = Application::getContext();
 
@@ -174,21 +250,18 @@ void GameInstance::pushWorldRenderData() {
     for (const auto& light : m_lights) {
         renderer->submitLight(light.get());
     }
-
-    for (auto& val : m_world->loadedChunks()) {
-        if (val.second.getMesh()) {
-            renderer->submitRenderable(val.second.getMesh());
-        }
+    for (const auto& light : m_stressLights) {
+        renderer->submitLight(light.get());
     }
-    renderer->submitRenderable(m_mesh1.get());
-    renderer->submitRenderable(m_mesh2.get());
-    renderer->submitRenderable(m_mesh3.get());
-    renderer->submitRenderable(m_skeletalMesh.get());
-    renderer->submitRenderable(m_particles.get());
 
+    // Chunks are culled hierarchically by the renderer, all other objects are retained in its render scene
+    renderer->submitChunkGrid(&m_world->chunkGrid());
+
+    RenderScene& scene = renderer->getRenderScene();
+    scene.setHidden(m_focusedBlockOutlineProxy, !m_player->isFocusingBlock());
     if (m_player->isFocusingBlock()) {
         m_focusedBlockOutline->getLocalTransform().setPosition(m_player->getFocusedBlock());
-        renderer->submitRenderable(m_focusedBlockOutline.get());
+        scene.updateProxy(m_focusedBlockOutlineProxy);
     }
 }
 
@@ -212,4 +285,9 @@ void GameInstance::update(float deltaTime) {
         m_skeletalMesh->playAnimation("Idle", true);
     }
     m_skeletalMesh->update(deltaTime);
+
+    RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+    for (RenderProxy* proxy : m_movingProxies) {
+        scene.updateProxy(proxy);
+    }
 }
\ No newline at end of file
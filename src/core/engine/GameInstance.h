@@ -11,6 +11,7 @@
 #include "engine/env/lights/Light.h"
 #include "engine/env/lights/Spotlight.h"
 #include "engine/rendering/Line.h"
+#include "engine/rendering/RenderScene.h"
 #include "engine/rendering/SkeletalMesh.h"
 #include "engine/rendering/Wireframe.h"
 #include "engine/rendering/lowlevelapi/Shader.h"
@@ -37,9 +38,20 @@ public:
     std::shared_ptr<StaticMesh> m_mesh3;
     std::shared_ptr<Wireframe> m_focusedBlockOutline;
     std::vector<std::shared_ptr<Spotlight>> m_lights;
+    std::vector<std::shared_ptr<Spotlight>> m_stressLights;  // Static lights spawned to stress the light culling
+    std::vector<std::shared_ptr<StaticMesh>> m_stressProps;  // Static meshes sharing one mesh and material
 
     std::shared_ptr<ParticleSystem> m_particles;
 
+private:
+    // Render scene proxies of the objects above, registered while the world is initialized
+    std::vector<RenderProxy*> m_movingProxies;  // Updated after every update
+    RenderProxy* m_particlesProxy;
+    RenderProxy* m_focusedBlockOutlineProxy;
+    std::vector<RenderProxy*> m_stressPropProxies;
+
+    void removeStressProps();
+
 public:
     GameInstance();
     virtual ~GameInstance();
@@ -52,6 +64,20 @@ public:
 
     void pushWorldRenderData();
 
+    /**
+     * Spawns a grid of small static spotlights around the world origin, or removes it again.
+     */
+    void setLightStressTestEnabled(bool enabled);
+
+    inline bool isLightStressTestEnabled() const { return !m_stressLights.empty(); }
+
+    /**
+     * Spawns a grid of props sharing the test block mesh and material above the world origin, or removes it again.
+     */
+    void setPropStressTestEnabled(bool enabled);
+
+    inline bool isPropStressTestEnabled() const { return !m_stressProps.empty(); }
+
     void update(float deltaTime) override;
 };
 
@@ -1,8 +1,10 @@
 #include "ChunkMeshBlueprint.h"
 
+#include <algorithm>
 #include <array>
 #include <cfloat>
 #include <cstring>
+#include <memory>
 #include <sstream>
 #include <unordered_map>
 #include <utility>
@@ -13,10 +15,6 @@
 #include "compatability/Compatability.h"
 #include "datatypes/BlockTypes.h"
 #include "datatypes/DatatypeDefs.h"
-#include "engine/rendering/lowlevelapi/IndexBuffer.h"
-#include "engine/rendering/lowlevelapi/VertexArray.h"
-#include "engine/rendering/lowlevelapi/VertexBuffer.h"
-#include "engine/rendering/lowlevelapi/VertexBufferLayout.h"
 #include "foundation/util/BitOperations.h"
 
 typedef unsigned int** BinaryPlaneArray;
@@ -27,6 +25,15 @@ struct CompactChunkFace {
     unsigned int indices[6];
 };
 
+// Cubic grid of cells meshed by the greedy mesher, either the blocks of a chunk or a downsampled copy of them
+struct BlockGrid {
+    const Block* cells;
+    int size;   // Cells along each axis
+    int scale;  // Blocks along each axis covered by one cell
+
+    inline const Block& at(int x, int y, int z) const { return cells[(z * size + y) * size + x]; }
+};
+
 static void zeroFillPlanes(BinaryPlaneArray planes, size_t size) {
     for (size_t slice = 0; slice < size; slice++) {
         std::memset(planes[slice], 0, size * sizeof(unsigned int));
@@ -146,6 +153,76 @@ static CompactChunkFace generateCompactChunkFace(
     return face;
 }
 
+static bool isSolidInGrid(const BlockGrid& grid, const glm::ivec3& pos) {
+    // Neighbouring chunks are not available while meshing, blocks beyond the border count as air
+    if (pos.x < 0 || pos.y < 0 || pos.z < 0 || pos.x >= grid.size || pos.y >= grid.size || pos.z >= grid.size) {
+        return false;
+    }
+    return grid.at(pos.x, pos.y, pos.z).isSolid;
+}
+
+static uint8_t calculateFaceOcclusion(
+    const BlockGrid& grid,
+    const CompactChunkFace& face,
+    AxisDirection faceDirection
+) {
+    // Occlusion of each corner [0 - 3] from the three blocks touching it in the layer in front of the face, packed
+    // with 2 bit per corner in vertex order
+    int axis = static_cast<int>(faceDirection) / 2;
+    bool positive = static_cast<int>(faceDirection) % 2 == 0;
+    int tangent1 = (axis + 1) % 3;
+    int tangent2 = (axis + 2) % 3;
+    glm::ivec3 doubledCenter = face.vertices[0].getPosition() + face.vertices[2].getPosition();
+
+    uint8_t occlusion = 0;
+    for (int i = 0; i < 4; i++) {
+        glm::ivec3 corner = face.vertices[i].getPosition();
+
+        // The inner block lies in front of the face itself, the outer ones are its neighbours across the corner
+        glm::ivec3 inner = corner;
+        glm::ivec3 outer = corner;
+        inner[axis] = outer[axis] = positive ? corner[axis] : corner[axis] - 1;
+        for (int tangent : {tangent1, tangent2}) {
+            bool towardsCenter = doubledCenter[tangent] > 2 * corner[tangent];
+            inner[tangent] = towardsCenter ? corner[tangent] : corner[tangent] - 1;
+            outer[tangent] = towardsCenter ? corner[tangent] - 1 : corner[tangent];
+        }
+
+        glm::ivec3 side1 = inner;
+        glm::ivec3 side2 = inner;
+        side1[tangent1] = outer[tangent1];
+        side2[tangent2] = outer[tangent2];
+        bool side1Solid = isSolidInGrid(grid, side1);
+        bool side2Solid = isSolidInGrid(grid, side2);
+        bool cornerSolid = isSolidInGrid(grid, outer);
+        unsigned int cornerOcclusion = side1Solid && side2Solid ? 3 : side1Solid + side2Solid + cornerSolid;
+
+        occlusion |= cornerOcclusion << (2 * i);
+    }
+    return occlusion;
+}
+
+static void applyFaceOcclusion(CompactChunkFace& face, uint8_t occlusion) {
+    for (int i = 0; i < 4; i++) {
+        face.vertices[i].setOcclusion(static_cast<uint8_t>(GET_BITS(occlusion, OCCLUSION_BITMASK, 2 * i)));
+    }
+
+    // Split along the diagonal of the more occluded corners, so the interpolated occlusion stays symmetric
+    unsigned int diagonal02 = GET_BITS(occlusion, OCCLUSION_BITMASK, 0) + GET_BITS(occlusion, OCCLUSION_BITMASK, 4);
+    unsigned int diagonal13 = GET_BITS(occlusion, OCCLUSION_BITMASK, 2) + GET_BITS(occlusion, OCCLUSION_BITMASK, 6);
+    if (diagonal02 < diagonal13) {
+        const unsigned int flippedIndices[6] = {1, 2, 3, 3, 0, 1};
+        std::copy(flippedIndices, flippedIndices + 6, face.indices);
+    }
+}
+
+static bool hasUniformOcclusion(const uint8_t* rowOcclusion, unsigned int column, unsigned int w, uint8_t occlusion) {
+    for (unsigned int i = column; i < column + w; i++) {
+        if (rowOcclusion[i] != occlusion) return false;
+    }
+    return true;
+}
+
 CPURenderData<CompactChunkVertex> generateMeshForChunk(const Block* blocks, const BlockToTextureMap& texMap) {
     std::vector<CompactChunkVertex> vertexBuffer;
     std::vector<unsigned int> indexBuffer;
@@ -185,15 +262,81 @@ CPURenderData<CompactChunkVertex> generateMeshForChunk(const Block* blocks, cons
     return {"Chunk", std::move(vertexBuffer), std::move(indexBuffer), bounds};
 }
 
-CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks, const BlockToTextureMap& texMap) {
+static std::unique_ptr<Block[]> downsampleBlocks(const Block* blocks, int scale) {
+    // Each cell is solid if at least half of its blocks are, ties stay solid so flat ground does not sink by a cell.
+    // Its type is the most common one among the blocks seen from above, so grass covered hills stay green.
+    int size = CHUNK_SIZE / scale;
+    std::unique_ptr<Block[]> cells(new Block[size * size * size]);
+    std::vector<std::pair<uint16_t, int>> surfaceTypes;
+    std::vector<std::pair<uint16_t, int>> solidTypes;
+
+    auto countType = [](std::vector<std::pair<uint16_t, int>>& counts, uint16_t type) {
+        for (std::pair<uint16_t, int>& count : counts) {
+            if (count.first == type) {
+                count.second++;
+                return;
+            }
+        }
+        counts.emplace_back(type, 1);
+    };
+    auto mostCommon = [](const std::vector<std::pair<uint16_t, int>>& counts) {
+        return std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+                   return a.second < b.second;
+               })->first;
+    };
+
+    for (int cz = 0; cz < size; cz++) {
+        for (int cy = 0; cy < size; cy++) {
+            for (int cx = 0; cx < size; cx++) {
+                surfaceTypes.clear();
+                solidTypes.clear();
+                int solidCount = 0;
+                for (int z = cz * scale; z < (cz + 1) * scale; z++) {
+                    for (int y = cy * scale; y < (cy + 1) * scale; y++) {
+                        for (int x = cx * scale; x < (cx + 1) * scale; x++) {
+                            const Block& block = blocks[chunkBlockIndex(x, y, z)];
+                            if (!block.isSolid) continue;
+
+                            solidCount++;
+                            countType(solidTypes, block.type);
+                            if (y + 1 >= CHUNK_HEIGHT || !blocks[chunkBlockIndex(x, y + 1, z)].isSolid) {
+                                countType(surfaceTypes, block.type);
+                            }
+                        }
+                    }
+                }
+
+                Block& cell = cells[(cz * size + cy) * size + cx];
+                if (2 * solidCount < scale * scale * scale) {
+                    cell = {AIR, false};
+                } else {
+                    cell = {mostCommon(surfaceTypes.empty() ? solidTypes : surfaceTypes), true};
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+template <typename EmitQuad>
+static void greedyMeshChunk(const Block* blocks, int lodLevel, bool bakeOcclusion, EmitQuad&& emitQuad) {
+    // Distant chunks mesh a coarse grid, its quads are scaled back to blocks so they fit the regular chunk formats
+    std::unique_ptr<Block[]> downsampled;
+    BlockGrid grid{blocks, CHUNK_SIZE, 1};
+    if (lodLevel > 0) {
+        downsampled = downsampleBlocks(blocks, 1 << lodLevel);
+        grid = {downsampled.get(), CHUNK_SIZE >> lodLevel, 1 << lodLevel};
+    }
+    const int size = grid.size;
+
     // Hold for each blocktype cullplanes for all 3 axes
     std::unordered_map<uint16_t, BinaryPlaneArray[3]> blockTypeCullPlanes;
 
     // Populate culling planes with mesh data
-    for (int x = 0; x < CHUNK_WIDTH; x++) {
-        for (int y = 0; y < CHUNK_HEIGHT; y++) {
-            for (int z = 0; z < CHUNK_DEPTH; z++) {
-                const Block& blockRef = blocks[chunkBlockIndex(x, y, z)];
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            for (int z = 0; z < size; z++) {
+                const Block& blockRef = grid.at(x, y, z);
                 if (blockRef.isSolid) {
                     BinaryPlaneArray* planes = nullptr;
 
@@ -204,7 +347,7 @@ CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks
 
                         // Allocate Planes
                         for (Axis axis : {Axis::X, Axis::Y, Axis::Z}) {
-                            planes[axis] = allocateBinaryPlanes(CHUNK_SIZE);
+                            planes[axis] = allocateBinaryPlanes(size);
                         }
                     } else {
                         planes = it->second;
@@ -219,14 +362,18 @@ CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks
         }
     }
 
-    std::vector<CompactChunkVertex> vertexBuffer;
-    std::vector<unsigned int> indexBuffer;
+    // Two greedy meshing planes because forward and backwards direction can be face culled in a single iteration
+    BinaryPlaneArray forwardGreedyMeshingPlanes = allocateBinaryPlanes(size);
+    BinaryPlaneArray backwardGreedyMeshingPlanes = allocateBinaryPlanes(size);
 
-    unsigned int currentIndexOffset = 0;
+    // Baked occlusion of each face of the current slice, faces only merge if all their corners match
+    uint8_t sliceOcclusion[CHUNK_SIZE][CHUNK_SIZE] = {};  // [row][column]
 
-    // Two greedy meshing planes because forward and backwards direction can be face culled in a single iteration
-    BinaryPlaneArray forwardGreedyMeshingPlanes = allocateBinaryPlanes(CHUNK_SIZE);
-    BinaryPlaneArray backwardGreedyMeshingPlanes = allocateBinaryPlanes(CHUNK_SIZE);
+    // Faces on the chunk border are always kept as skirts. Neighbours may be meshed at another level of detail or
+    // not be loaded yet, so every chunk mesh is closed on its own: surfaces of different levels meet in a step
+    // instead of a crack and a chunk changing its level never has to remesh its neighbours.
+    const unsigned int nearBorderSkirt = 1U;
+    const unsigned int farBorderSkirt = 1U << (size - 1);
 
     for (auto& element : blockTypeCullPlanes) {
         for (Axis axis : allAxis) {
@@ -249,15 +396,16 @@ CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks
             }
 
             // Reset for eaxh axis (Reuse of memory)
-            zeroFillPlanes(forwardGreedyMeshingPlanes, CHUNK_SIZE);
-            zeroFillPlanes(backwardGreedyMeshingPlanes, CHUNK_SIZE);
+            zeroFillPlanes(forwardGreedyMeshingPlanes, size);
+            zeroFillPlanes(backwardGreedyMeshingPlanes, size);
 
             // Face culling
-            for (int slice = 0; slice < CHUNK_SIZE; slice++) {
-                for (int row = 0; row < CHUNK_SIZE; row++) {
+            for (int slice = 0; slice < size; slice++) {
+                for (int row = 0; row < size; row++) {
                     // Cull forward and backwards faces
-                    unsigned int culledForwardMask = cullPlanes[slice][row] & ~(cullPlanes[slice][row] >> 1U);
-                    unsigned int culledBackwardMask = cullPlanes[slice][row] & ~(cullPlanes[slice][row] << 1U);
+                    unsigned int cells = cullPlanes[slice][row];
+                    unsigned int culledForwardMask = cells & (~(cells >> 1U) | farBorderSkirt);
+                    unsigned int culledBackwardMask = cells & (~(cells << 1U) | nearBorderSkirt);
 
                     // Insert culled values into greedy meshing planes
                     while (culledForwardMask != 0) {
@@ -286,46 +434,64 @@ CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks
                     greedyMeshingPlanes = backwardGreedyMeshingPlanes;
                 }
 
-                for (int slice = 0; slice < CHUNK_SIZE; slice++) {
-                    for (int row = 0; row < CHUNK_SIZE; row++) {
+                for (int slice = 0; slice < size; slice++) {
+                    if (bakeOcclusion) {
+                        for (int row = 0; row < size; row++) {
+                            unsigned int faces = greedyMeshingPlanes[slice][row];
+                            while (faces != 0) {
+                                unsigned int column = trailing_zeros(faces);
+                                faces &= faces - 1;
+                                glm::ivec3 coord = axisToCoord(axis, slice, row, column);
+                                CompactChunkFace face = generateCompactChunkFace(coord, currentDirection, FaceInfo{});
+                                sliceOcclusion[row][column] = calculateFaceOcclusion(grid, face, currentDirection);
+                            }
+                        }
+                    }
+
+                    for (int row = 0; row < size; row++) {
                         int column = 0;
-                        while (column < CHUNK_SIZE) {
+                        while (column < size) {
                             column += trailing_zeros(greedyMeshingPlanes[slice][row] >> column);
 
-                            if (column >= CHUNK_SIZE) break;  // Row processed
+                            if (column >= size) break;  // Row processed
 
                             unsigned int w = trailing_ones(greedyMeshingPlanes[slice][row] >> column);  // Width in row
 
                             if (w <= 0) break;  // No more blocks to process
 
+                            uint8_t occlusion = 0;
+                            if (bakeOcclusion) {
+                                occlusion = sliceOcclusion[row][column];
+                                unsigned int uniformWidth = 1;
+                                while (uniformWidth < w && sliceOcclusion[row][column + uniformWidth] == occlusion) {
+                                    uniformWidth++;
+                                }
+                                w = uniformWidth;
+                            }
+
                             unsigned int mask = createMask(w) << column;
 
                             unsigned int h = 1;
-                            while (row + h < CHUNK_SIZE) {
+                            while (row + h < static_cast<unsigned int>(size)) {
                                 if ((greedyMeshingPlanes[slice][row + h] & mask) != mask) {
                                     break;  // Can no longer expand in height
                                 }
+                                if (bakeOcclusion &&
+                                    !hasUniformOcclusion(sliceOcclusion[row + h], column, w, occlusion)) {
+                                    break;  // Next row is occluded differently
+                                }
                                 greedyMeshingPlanes[slice][row + h] &= ~mask;  // Nuke bits that have been expanded too
                                 h++;
                             }
 
-                            glm::ivec3 coord = axisToCoord(axis, slice, row, column);
+                            glm::ivec3 coord = axisToCoord(axis, slice, row, column) * grid.scale;
+                            // Faces are placed one block past the origin in positive directions, the far side of a
+                            // coarse cell lies scale blocks past it
+                            if (dir == 0) coord[axis] += grid.scale - 1;
 
-                            // ##### Adding face #####
-                            CompactChunkFace face = generateCompactChunkFace(
-                                coord, currentDirection, texMap.getInfo(element.first, currentDirection), w, h
+                            emitQuad(
+                                coord, currentDirection, element.first, w * grid.scale, h * grid.scale, occlusion
                             );
-                            // Add face vertices to the global vertex buffer
-                            for (int i = 0; i < 4; i++) {
-                                vertexBuffer.push_back(face.vertices[i]);
-                            }
-
-                            // Add face indices to the global index buffer
-                            for (int i = 0; i < 6; i++) {
-                                indexBuffer.push_back(face.indices[i] + currentIndexOffset);
-                            }
-                            currentIndexOffset += 4;  // Update the index offset (each face has 4 vertices)
-                            // ##### End Adding face #####
 
                             column += w;
                         }
@@ -334,43 +500,189 @@ CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks
             }
 
             // Free allocated plane of this blocktype and axis since thats no longer needed now
-            freeBinaryPlanes(element.second[axis], CHUNK_SIZE);
+            freeBinaryPlanes(element.second[axis], size);
         }
     }
 
-    freeBinaryPlanes(forwardGreedyMeshingPlanes, CHUNK_SIZE);
-    freeBinaryPlanes(backwardGreedyMeshingPlanes, CHUNK_SIZE);
+    freeBinaryPlanes(forwardGreedyMeshingPlanes, size);
+    freeBinaryPlanes(backwardGreedyMeshingPlanes, size);
+}
+
+CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    bool bakeOcclusion,
+    int lodLevel
+) {
+    std::vector<CompactChunkVertex> vertexBuffer;
+    std::vector<unsigned int> indexBuffer;
+
+    unsigned int currentIndexOffset = 0;
+
+    greedyMeshChunk(
+        blocks,
+        lodLevel,
+        bakeOcclusion,
+        [&](const glm::ivec3& coord, AxisDirection direction, uint16_t blockType, unsigned int w, unsigned int h,
+            uint8_t occlusion) {
+            CompactChunkFace face = generateCompactChunkFace(coord, direction, texMap.getInfo(blockType, direction), w, h);
+            applyFaceOcclusion(face, occlusion);
+            // Add face vertices to the global vertex buffer
+            for (int i = 0; i < 4; i++) {
+                vertexBuffer.push_back(face.vertices[i]);
+            }
+
+            // Add face indices to the global index buffer
+            for (int i = 0; i < 6; i++) {
+                indexBuffer.push_back(face.indices[i] + currentIndexOffset);
+            }
+            currentIndexOffset += 4;  // Update the index offset (each face has 4 vertices)
+        }
+    );
 
     BoundingBox bounds = calculateChunkMeshBounds(vertexBuffer);
     return {"Chunk", std::move(vertexBuffer), std::move(indexBuffer), bounds};
 }
 
-std::shared_ptr<StaticMesh::Shared> createSharedState(const CPURenderData<CompactChunkVertex>& cpuStaticMesh) {
-    VertexBuffer vbo = VertexBuffer::create(
-        cpuStaticMesh.vertices.data(), cpuStaticMesh.vertices.size() * sizeof(CompactChunkVertex)
+CPURenderData<CompactChunkQuad> generateQuadMeshForChunkGreedy(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    bool bakeOcclusion,
+    int lodLevel
+) {
+    std::vector<CompactChunkQuad> quadBuffer;
+    BoundingBox bounds = BoundingBox::invalid();
+
+    greedyMeshChunk(
+        blocks,
+        lodLevel,
+        bakeOcclusion,
+        [&](const glm::ivec3& coord, AxisDirection direction, uint16_t blockType, unsigned int w, unsigned int h,
+            uint8_t occlusion) {
+            FaceInfo fInfo = texMap.getInfo(blockType, direction);
+            CompactChunkQuad& quad = quadBuffer.emplace_back(coord, w, h, fInfo.texIndex, direction);
+            for (int corner = 0; corner < 4; corner++) {
+                uint8_t cornerOcclusion = static_cast<uint8_t>(GET_BITS(occlusion, OCCLUSION_BITMASK, 2 * corner));
+                quad.setCornerOcclusion(corner, cornerOcclusion);
+            }
+
+            // Corners are only expanded on the gpu, derive the bounds from the equivalent face
+            CompactChunkFace face = generateCompactChunkFace(coord, direction, fInfo, w, h);
+            for (const CompactChunkVertex& vertex : face.vertices) {
+                bounds.min = glm::min(bounds.min, glm::vec3(vertex.getPosition()));
+                bounds.max = glm::max(bounds.max, glm::vec3(vertex.getPosition()));
+            }
+        }
     );
 
-    VertexBufferLayout layout;
-    // Compressed data
-    layout.push(GL_UNSIGNED_INT, 1);
-    layout.push(GL_UNSIGNED_INT, 1);
-    vbo.setLayout(layout);
+    return {"Chunk", std::move(quadBuffer), {}, bounds};
+}
+
+ChunkMeshData generateChunkMesh(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    ChunkMeshFormat format,
+    bool bakeOcclusion,
+    int lodLevel
+) {
+    ChunkMeshData mesh;
+    mesh.format = format;
+    mesh.bakedOcclusion = bakeOcclusion;
+    mesh.lodLevel = lodLevel;
+    if (format == ChunkMeshFormat::Quads) {
+        CPURenderData<CompactChunkQuad> quadMesh = generateQuadMeshForChunkGreedy(
+            blocks, texMap, bakeOcclusion, lodLevel
+        );
+        mesh.quads = std::move(quadMesh.vertices);
+        mesh.bounds = quadMesh.bounds;
+    } else {
+        CPURenderData<CompactChunkVertex> vertexMesh = generateMeshForChunkGreedy(
+            blocks, texMap, bakeOcclusion, lodLevel
+        );
+        mesh.vertices = std::move(vertexMesh.vertices);
+        mesh.indices = std::move(vertexMesh.indices);
+        mesh.bounds = vertexMesh.bounds;
+    }
+    return mesh;
+}
+
+StagedChunkMesh stageChunkMesh(ChunkMeshData&& mesh, UploadManager& uploads) {
+    StagedChunkMesh staged{};
+    staged.format = mesh.format;
+    staged.bounds = mesh.bounds;
+    staged.recordCount = mesh.recordCount();
+    staged.indexCount = mesh.indices.size();
+
+    // Both record types share the same size, see Vertices.h
+    size_t recordBytes = staged.recordCount * sizeof(CompactChunkVertex);
+    size_t indexBytes = staged.indexCount * sizeof(unsigned int);
+
+    staged.records = uploads.allocate(recordBytes);
+    if (staged.records.isValid() && indexBytes > 0) {
+        staged.indices = uploads.allocate(indexBytes);
+        if (!staged.indices.isValid()) staged.records = StagingAllocation();
+    }
+
+    if (staged.isStaged()) {
+        std::memcpy(staged.records.data(), mesh.recordData(), recordBytes);
+        if (indexBytes > 0) std::memcpy(staged.indices.data(), mesh.indices.data(), indexBytes);
+    } else {
+        staged.fallbackMesh = std::move(mesh);
+    }
 
-    VertexArray vao = VertexArray::create();
-    vao.addBuffer(vbo);
+    return staged;
+}
+
+std::shared_ptr<StaticMesh::Shared> createSharedState(
+    const StagedChunkMesh& stagedMesh,
+    UploadManager& uploads,
+    const std::shared_ptr<ChunkGeometryArena>& arena
+) {
+    ChunkGeometryArena::Allocation allocation = arena->allocate(
+        stagedMesh.format, stagedMesh.recordCount, stagedMesh.indexCount
+    );
 
-    if (cpuStaticMesh.isIndexed()) {
-        IndexBuffer ibo = IndexBuffer::create(cpuStaticMesh.indices.data(), cpuStaticMesh.indices.size());
-        std::unique_ptr<RenderData> renderData = std::make_unique<IndexedRenderData>(
-            std::move(vao), std::move(vbo), std::move(ibo)
+    if (stagedMesh.isStaged()) {
+        // Data is copied on the gpu out of the staging ring into the arena
+        uploads.copyToBuffer(
+            stagedMesh.records, arena->dataBufferId(stagedMesh.format), allocation.dataOffset * sizeof(CompactChunkVertex)
         );
-        return std::make_shared<StaticMesh::Shared>(StaticMesh::Shared{std::move(renderData)});
+        if (stagedMesh.indexCount > 0) {
+            uploads.copyToBuffer(
+                stagedMesh.indices, arena->indexBufferId(), allocation.indexOffset * sizeof(unsigned int)
+            );
+        }
     } else {
-        std::unique_ptr<RenderData> renderData = std::make_unique<NonIndexedRenderData>(std::move(vao), std::move(vbo));
-        return std::make_shared<StaticMesh::Shared>(StaticMesh::Shared{std::move(renderData)});
+        arena->upload(allocation, stagedMesh.fallbackMesh.recordData(), stagedMesh.fallbackMesh.indices.data());
     }
+
+    std::unique_ptr<RenderData> renderData = std::make_unique<ChunkArenaRenderData>(arena, allocation);
+    return std::make_shared<StaticMesh::Shared>(StaticMesh::Shared{std::move(renderData)});
 }
 
 StaticMesh::Instance createInstanceState(const CPURenderData<CompactChunkVertex>& cpuStaticMesh) {
     return {cpuStaticMesh.bounds};
 }
+
+StaticMesh::Instance createInstanceState(const StagedChunkMesh& stagedMesh) { return {stagedMesh.bounds}; }
+
+ChunkMeshData readBackChunkMesh(const StaticMesh& mesh, bool bakedOcclusion, int lodLevel) {
+    // Chunk meshes always live in the arena
+    const ChunkArenaRenderData* renderData = static_cast<const ChunkArenaRenderData*>(mesh.getRenderData());
+    const ChunkGeometryArena::Allocation& allocation = renderData->getAllocation();
+
+    ChunkMeshData meshData;
+    meshData.format = allocation.format;
+    meshData.bakedOcclusion = bakedOcclusion;
+    meshData.lodLevel = lodLevel;
+    meshData.bounds = mesh.getBoundingBox();
+    if (allocation.format == ChunkMeshFormat::Quads) {
+        meshData.quads.resize(allocation.dataCount);
+        renderData->getArena().download(allocation, meshData.quads.data(), nullptr);
+    } else {
+        meshData.vertices.resize(allocation.dataCount);
+        meshData.indices.resize(allocation.indexCount);
+        renderData->getArena().download(allocation, meshData.vertices.data(), meshData.indices.data());
+    }
+    return meshData;
+}
@@ -2,19 +2,98 @@
 #define TOOMANYBLOCKS_CHUNKMESHBLUEPRINT_H
 
 #include <memory>
+#include <vector>
 
 #include "engine/env/Chunk.h"
 #include "engine/rendering/BlockToTextureMapping.h"
+#include "engine/rendering/ChunkGeometryArena.h"
 #include "engine/rendering/RenderData.h"
+#include "engine/rendering/UploadManager.h"
 #include "engine/rendering/Vertices.h"
 #include "engine/resource/cpu/CPURenderData.h"
 
+/**
+ * @brief Cpu side chunk mesh in one of the supported chunk mesh formats.
+ */
+struct ChunkMeshData {
+    ChunkMeshFormat format = ChunkMeshFormat::Vertices;
+    bool bakedOcclusion = false;               // Records carry per corner ambient occlusion
+    int lodLevel = 0;                          // Meshed from blocks downsampled 2^lodLevel times
+    std::vector<CompactChunkVertex> vertices;  // Only used by the vertex format
+    std::vector<unsigned int> indices;         // Only used by the vertex format
+    std::vector<CompactChunkQuad> quads;       // Only used by the quad format
+    BoundingBox bounds;
+
+    inline size_t recordCount() const { return format == ChunkMeshFormat::Quads ? quads.size() : vertices.size(); }
+
+    inline const void* recordData() const {
+        return format == ChunkMeshFormat::Quads ? static_cast<const void*>(quads.data()) : vertices.data();
+    }
+};
+
+/**
+ * @brief Chunk mesh whose records and indices were written into the staging ring by a worker thread.
+ *
+ * If staging failed (ring disabled or full), the cpu mesh is kept instead so the main thread can fall back
+ * to a direct upload.
+ */
+struct StagedChunkMesh {
+    ChunkMeshFormat format;
+    BoundingBox bounds;
+    size_t recordCount;
+    size_t indexCount;
+    StagingAllocation records;
+    StagingAllocation indices;
+    ChunkMeshData fallbackMesh;
+
+    inline bool isStaged() const { return records.isValid(); }
+};
+
 CPURenderData<CompactChunkVertex> generateMeshForChunk(const Block* blocks, const BlockToTextureMap& texMap);
 
-CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(const Block* blocks, const BlockToTextureMap& texMap);
+/**
+ * @brief Greedy meshes a chunk, with baked occlusion only faces of equal corner occlusion are merged.
+ *
+ * Above level of detail 0 the blocks are first downsampled 2^lodLevel times along each axis, the coarse grid is
+ * meshed and its quads are scaled back to block units.
+ */
+CPURenderData<CompactChunkVertex> generateMeshForChunkGreedy(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    bool bakeOcclusion = false,
+    int lodLevel = 0
+);
 
-std::shared_ptr<StaticMesh::Shared> createSharedState(const CPURenderData<CompactChunkVertex>& cpuStaticMesh);
+CPURenderData<CompactChunkQuad> generateQuadMeshForChunkGreedy(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    bool bakeOcclusion = false,
+    int lodLevel = 0
+);
+
+ChunkMeshData generateChunkMesh(
+    const Block* blocks,
+    const BlockToTextureMap& texMap,
+    ChunkMeshFormat format,
+    bool bakeOcclusion = false,
+    int lodLevel = 0
+);
+
+StagedChunkMesh stageChunkMesh(ChunkMeshData&& mesh, UploadManager& uploads);
+
+std::shared_ptr<StaticMesh::Shared> createSharedState(
+    const StagedChunkMesh& stagedMesh,
+    UploadManager& uploads,
+    const std::shared_ptr<ChunkGeometryArena>& arena
+);
 
 StaticMesh::Instance createInstanceState(const CPURenderData<CompactChunkVertex>& cpuStaticMesh);
 
+StaticMesh::Instance createInstanceState(const StagedChunkMesh& stagedMesh);
+
+/**
+ * @brief Reads an uploaded chunk mesh back from the chunk geometry arena, e.g. to cache it once its chunk unloads.
+ */
+ChunkMeshData readBackChunkMesh(const StaticMesh& mesh, bool bakedOcclusion, int lodLevel);
+
 #endif
@@ -53,11 +53,6 @@ SkeletalMesh::Instance createInstanceState(const CPUSkeletalMeshData& cpuSkeleta
         }
     }
 
-    std::vector<glm::mat4> initalMatrices(std::max<int>(cpuSkeletalMesh.jointNodeIndices.size(), 4));
-    for (size_t i = 0; i < initalMatrices.size(); i++) {
-        initalMatrices[i] = glm::mat4(1.0f);
-    }
-
     std::vector<Animation> animInstances;
     animInstances.reserve(cpuSkeletalMesh.animations.size());
 
@@ -88,7 +83,6 @@ SkeletalMesh::Instance createInstanceState(const CPUSkeletalMeshData& cpuSkeleta
         cpuSkeletalMesh.animatedMeshNodeIndex,
         std::move(sceneCompArray),
         std::move(animInstances),
-        UniformBuffer::create(initalMatrices.data(), initalMatrices.size() * sizeof(glm::mat4)),
         cpuSkeletalMesh.meshData.bounds
     };
 }
@@ -1,10 +1,10 @@
 #include "ShaderBuilder.h"
 
-Future<Shader> build(const Future<CPUShader>& cpuShader) {
+Future<Shader> build(const Future<CPUShader>& cpuShader, const ShaderDefines& defines) {
     Future<Shader> shaderFuture(
-        [cpuShader]() {
+        [cpuShader, defines]() {
             const CPUShader& cpu = cpuShader.value();
-            return Shader::create(cpu.vertexShader, cpu.fragmentShader);
+            return Shader::create(cpu.vertexShader, cpu.fragmentShader, defines);
         },
         DEFAULT_TASKCONTEXT,
         Executor::Main
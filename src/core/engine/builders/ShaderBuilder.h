@@ -6,7 +6,7 @@
 #include "engine/resource/cpu/CPUShader.h"
 #include "foundation/threading/Future.h"
 
-Future<Shader> build(const Future<CPUShader>& cpuShader);
+Future<Shader> build(const Future<CPUShader>& cpuShader, const ShaderDefines& defines = ShaderDefines());
 
 Future<TransformFeedbackShader> buildTFShader(const Future<CPUShader>& cpuShader, const std::vector<std::string>& varyings);
 
@@ -8,6 +8,4 @@
 
 Future<StaticMesh::Internal> build(const Future<CPURenderData<Vertex>>& cpuMesh);
 
-Future<StaticMesh::Internal> build(const Future<CPURenderData<CompactChunkVertex>>& cpuMesh);
-
 #endif
@@ -1,7 +1,11 @@
 #include "Chunk.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
+
 #include "Logger.h"
+#include "engine/env/ChunkCache.h"
 
 glm::ivec3 Chunk::worldToChunkOrigin(const glm::vec3& worldPos) {
     glm::vec3 chunkSize(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH);
@@ -13,13 +17,35 @@ glm::ivec3 Chunk::worldToChunkLocal(const glm::ivec3& chunkOrigin, const glm::iv
     return worldBlockPos - chunkOrigin;
 }
 
-void Chunk::tryCommitRebuild() {
+std::shared_ptr<const Block[]> BlockStorage::snapshot() const {
+    BlockStorageStats::sharedBytes.fetch_add(BLOCKS_PER_CHUNK * sizeof(Block), std::memory_order_relaxed);
+    return m_blocks;
+}
+
+Block* BlockStorage::edit() {
+    // Snapshots are only handed out on the main thread, so other threads can release but never add references
+    if (m_blocks.use_count() > 1) {
+        std::shared_ptr<Block[]> copy(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
+        std::copy(m_blocks.get(), m_blocks.get() + BLOCKS_PER_CHUNK, copy.get());
+        m_blocks = std::move(copy);
+        BlockStorageStats::copiedBytes.fetch_add(BLOCKS_PER_CHUNK * sizeof(Block), std::memory_order_relaxed);
+    } else {
+        // Pairs with the release of the last snapshot, whose reads have to finish before the writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    m_version++;
+    return m_blocks.get();
+}
+
+bool Chunk::tryCommitRebuild() {
     if (m_pendingRebuildMesh.isReady()) {
         lgr::lout.debug("Commiting rebuild");
         m_mesh.getAssetHandle() = std::move(m_pendingRebuildMesh);
 
         m_pendingRebuildMesh.reset();
+        return true;
     }
+    return false;
 }
 
 bool isBlockFaceVisible(const Block* blocks, int x, int y, int z, AxisDirection faceDirection) {
@@ -47,4 +73,69 @@ bool isBlockFaceVisible(const Block* blocks, int x, int y, int z, AxisDirection
             return (z - 1 < 0 || !blocks[chunkBlockIndex(x, y, z - 1)].isSolid);
         default: return false;
     }
-}
\ No newline at end of file
+}
+
+ChunkConnectivity Chunk::connectivity() const {
+    if (!m_connectivity.isReady() || m_connectivity.hasError()) return CHUNK_FULLY_CONNECTED;
+    return m_connectivity.value();
+}
+
+static void addConnectedFaces(ChunkConnectivity& connectivity, uint8_t touchedFaces) {
+    for (int a = 0; a < 6; a++) {
+        if (!(touchedFaces & (1u << a))) continue;
+        for (int b = a + 1; b < 6; b++) {
+            if (touchedFaces & (1u << b)) connectivity |= chunkFacePairBit(allAxisDirections[a], allAxisDirections[b]);
+        }
+    }
+}
+
+ChunkConnectivity computeChunkConnectivity(const Block* blocks) {
+    if (blocks == nullptr) {
+        throw std::runtime_error("Block array was null while computing chunk connectivity");
+    }
+
+    ChunkConnectivity connectivity = 0;
+    std::vector<bool> visited(BLOCKS_PER_CHUNK, false);
+    std::vector<int> stack;
+
+    for (int start = 0; start < BLOCKS_PER_CHUNK; start++) {
+        if (blocks[start].isSolid || visited[start]) continue;
+
+        uint8_t touchedFaces = 0;
+        visited[start] = true;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+
+            int x = index % CHUNK_WIDTH;
+            int y = (index / CHUNK_WIDTH) % CHUNK_HEIGHT;
+            int z = index / CHUNK_SLICE_SIZE;
+            if (x == CHUNK_WIDTH - 1) touchedFaces |= 1u << static_cast<int>(AxisDirection::PositiveX);
+            if (x == 0) touchedFaces |= 1u << static_cast<int>(AxisDirection::NegativeX);
+            if (y == CHUNK_HEIGHT - 1) touchedFaces |= 1u << static_cast<int>(AxisDirection::PositiveY);
+            if (y == 0) touchedFaces |= 1u << static_cast<int>(AxisDirection::NegativeY);
+            if (z == CHUNK_DEPTH - 1) touchedFaces |= 1u << static_cast<int>(AxisDirection::PositiveZ);
+            if (z == 0) touchedFaces |= 1u << static_cast<int>(AxisDirection::NegativeZ);
+
+            const int neighbours[6][2] = {
+                {x + 1 < CHUNK_WIDTH, index + 1},
+                {x > 0, index - 1},
+                {y + 1 < CHUNK_HEIGHT, index + CHUNK_WIDTH},
+                {y > 0, index - CHUNK_WIDTH},
+                {z + 1 < CHUNK_DEPTH, index + CHUNK_SLICE_SIZE},
+                {z > 0, index - CHUNK_SLICE_SIZE},
+            };
+            for (const auto& neighbour : neighbours) {
+                if (!neighbour[0] || visited[neighbour[1]] || blocks[neighbour[1]].isSolid) continue;
+                visited[neighbour[1]] = true;
+                stack.push_back(neighbour[1]);
+            }
+        }
+
+        addConnectedFaces(connectivity, touchedFaces);
+        if (connectivity == CHUNK_FULLY_CONNECTED) break;
+    }
+
+    return connectivity;
+}
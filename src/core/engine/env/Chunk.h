@@ -1,12 +1,15 @@
 #ifndef TOOMANYBLOCKS_CHUNK_H
 #define TOOMANYBLOCKS_CHUNK_H
 
+#include <atomic>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <unordered_map>
 
 #include "datatypes/DatatypeDefs.h"
 #include "engine/rendering/StaticMesh.h"
+#include "foundation/threading/CancellationToken.h"
 #include "foundation/threading/Future.h"
 
 constexpr int CHUNK_SIZE = 32;
@@ -16,6 +19,7 @@ constexpr int CHUNK_HEIGHT = CHUNK_SIZE;
 constexpr int CHUNK_SLICE_SIZE = CHUNK_WIDTH * CHUNK_HEIGHT;  // Vertical slice size in a chunk
 constexpr int CHUNK_PLANE_SIZE = CHUNK_WIDTH * CHUNK_DEPTH;   // Horizontal plane size in a chunk
 constexpr int BLOCKS_PER_CHUNK = CHUNK_WIDTH * CHUNK_DEPTH * CHUNK_HEIGHT;
+constexpr int MAX_CHUNK_LOD_LEVEL = 3;  // Distant chunks are meshed from blocks downsampled up to 2^3 times
 
 struct coord_hash {
     size_t operator()(const glm::ivec3& v) const {
@@ -32,34 +36,134 @@ struct Block {
     bool isSolid;
 };
 
+/**
+ * Process wide counters of chunk block data handed to meshing and saving jobs.
+ */
+struct BlockStorageStats {
+    // Bytes copied because blocks were edited while a snapshot still shared them
+    static inline std::atomic<uint64_t> copiedBytes{0};
+    // Bytes handed out as shared snapshots, each of them was a full copy before blocks were copy on write
+    static inline std::atomic<uint64_t> sharedBytes{0};
+};
+
+/**
+ * Versioned copy on write blocks of a chunk.
+ *
+ * Snapshots share the current blocks and never change, so jobs can read them while the main thread keeps editing.
+ * Edits only copy the blocks if a snapshot is still held, otherwise they write in place.
+ */
+class BlockStorage {
+private:
+    std::shared_ptr<Block[]> m_blocks;
+    uint64_t m_version;  // Incremented by every edit
+
+public:
+    BlockStorage() : m_version(0) {}
+    explicit BlockStorage(std::shared_ptr<Block[]> blocks) : m_blocks(std::move(blocks)), m_version(0) {}
+
+    inline bool empty() const { return !m_blocks; }
+    inline const Block* data() const { return m_blocks.get(); }
+    inline uint64_t version() const { return m_version; }
+
+    std::shared_ptr<const Block[]> snapshot() const;
+
+    /**
+     * @return Blocks to modify, copied first if a snapshot still shares them. Main thread only.
+     */
+    Block* edit();
+};
+
+// One bit per pair of chunk faces that are connected through non solid blocks inside the chunk
+using ChunkConnectivity = uint16_t;
+constexpr ChunkConnectivity CHUNK_FULLY_CONNECTED = 0x7FFF;
+
+constexpr ChunkConnectivity chunkFacePairBit(AxisDirection a, AxisDirection b) {
+    // Maps each unordered pair of the 6 faces to one of 15 bits
+    int lo = static_cast<int>(a) < static_cast<int>(b) ? static_cast<int>(a) : static_cast<int>(b);
+    int hi = static_cast<int>(a) < static_cast<int>(b) ? static_cast<int>(b) : static_cast<int>(a);
+    return static_cast<ChunkConnectivity>(1u << (lo * (11 - lo) / 2 + hi - lo - 1));
+}
+
+struct RenderProxy;
+
+/**
+ * Lifecycle of a loaded chunk. Loading runs from Requested through Live, changing blocks of a live chunk makes it
+ * Dirty and its rebuild runs through Meshing and Uploading again while the previous mesh is still drawn.
+ */
+enum class ChunkState : uint8_t {
+    Requested,   // Waiting for its load to start
+    Generating,  // Blocks are generated, read from disk or decoded from the chunk cache
+    Meshing,     // Workers build the mesh and stage it for upload
+    Uploading,   // Gpu resources of the mesh are created on the main thread
+    Live,
+    Dirty,      // Blocks changed since the current mesh was built, queued for a rebuild
+    Unloading   // Changed blocks are written back, the chunk is removed once they are
+};
+
 class Chunk {
     friend class World;
 
 private:
-    bool m_changed;          // If any block has been changed since the last rebuild started
-    bool m_isMarkedForSave;  // If there are changes that need to be written back chunk file
-    Future<std::unique_ptr<Block[]>> m_blocks;
+    bool m_changed;           // If any block has been changed since the last rebuild started
+    uint64_t m_savedVersion;  // Block version last written back to the chunk file
+    ChunkState m_state;
+    uint8_t m_lodLevel;               // Level of detail the chunk should be meshed at, depends on its distance
+    uint8_t m_meshLodLevel;           // Level of detail of the last started mesh build
+    uint8_t m_loadAttempts;           // Failed loads of the blocks in a row
+    uint32_t m_meshSettingsRevision;  // Mesh settings of the world the last started mesh build used
+    BlockStorage m_blocks;
+    Future<std::shared_ptr<Block[]>> m_generatedBlocks;  // Moved into the block storage once generated
     StaticMesh m_mesh;
+    RenderProxy* m_renderProxy;  // Proxy of the mesh in the render scene, registered by the world
     Future<StaticMesh::Internal> m_pendingRebuildMesh;
+    Future<ChunkConnectivity> m_connectivity;  // Of the blocks the current mesh was built from
+    CancellationToken m_cancelToken;           // Cancelled once the chunk is unloaded
 
 public:
     static glm::ivec3 worldToChunkOrigin(const glm::vec3& worldPos);
     static glm::ivec3 worldToChunkLocal(const glm::ivec3& chunkOrigin, const glm::ivec3& worldBlockPos);
 
-    Chunk() : m_changed(false), m_isMarkedForSave(false) {}
+    Chunk()
+        : m_changed(false),
+          m_savedVersion(0),
+          m_state(ChunkState::Requested),
+          m_lodLevel(0),
+          m_meshLodLevel(0),
+          m_loadAttempts(0),
+          m_meshSettingsRevision(0),
+          m_renderProxy(nullptr) {}
 
-    void tryCommitRebuild();
+    /**
+     * @return True if a rebuilt mesh replaced the current one.
+     */
+    bool tryCommitRebuild();
 
-    inline bool isBeingRebuild() const { return m_pendingRebuildMesh.isReady(); }
+    inline ChunkState getState() const { return m_state; }
+    inline bool isBeingRebuild() const { return !m_pendingRebuildMesh.isEmpty(); }
     inline bool isChanged() const { return m_changed; }
-    inline bool isMarkedForSave() const { return m_isMarkedForSave; }
-    inline bool isLoaded() const { return m_blocks.isReady(); }
-    inline const Block* blocks() const { return m_blocks.isReady() ? m_blocks.value().get() : nullptr; }
+    inline bool needsRemesh(uint32_t meshSettingsRevision) const {
+        return m_changed || m_lodLevel != m_meshLodLevel || m_meshSettingsRevision != meshSettingsRevision;
+    }
+    inline uint8_t getLodLevel() const { return m_lodLevel; }
+    inline bool isMarkedForSave() const { return m_blocks.version() != m_savedVersion; }
+    inline bool isLoaded() const { return m_state != ChunkState::Unloading && !m_blocks.empty(); }
+    inline const Block* blocks() const { return isLoaded() ? m_blocks.data() : nullptr; }
     inline StaticMesh* getMesh() { return &m_mesh; }
+    inline const RenderProxy* getRenderProxy() const { return m_renderProxy; }
+
+    /**
+     * @return Which faces of the chunk see each other, fully connected as long as the chunk has not been meshed.
+     */
+    ChunkConnectivity connectivity() const;
 };
 
 constexpr int chunkBlockIndex(int x, int y, int z) { return z * CHUNK_SLICE_SIZE + y * CHUNK_WIDTH + x; }
 
 bool isBlockFaceVisible(const Block* blocks, int x, int y, int z, AxisDirection faceDirection);
 
+/**
+ * Flood fills all non solid regions of a chunk and records which chunk faces each region touches.
+ */
+ChunkConnectivity computeChunkConnectivity(const Block* blocks);
+
 #endif
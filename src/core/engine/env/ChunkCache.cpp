@@ -0,0 +1,70 @@
+#include "ChunkCache.h"
+
+size_t CachedChunk::byteSize() const {
+    size_t size = sizeof(CachedChunk) + rleBlocks.size() * sizeof(uint16_t);
+    if (mesh) {
+        size += mesh->vertices.size() * sizeof(CompactChunkVertex) + mesh->indices.size() * sizeof(unsigned int) +
+                mesh->quads.size() * sizeof(CompactChunkQuad);
+    }
+    return size;
+}
+
+void ChunkCache::erase(std::unordered_map<glm::ivec3, std::list<Entry>::iterator, coord_hash>::iterator it) {
+    m_usedBytes -= it->second->byteSize;
+    m_lru.erase(it->second);
+    m_entries.erase(it);
+}
+
+void ChunkCache::evictToBudget() {
+    while (m_usedBytes > m_budget && !m_lru.empty()) {
+        erase(m_entries.find(m_lru.back().chunkPos));
+        m_evictions++;
+    }
+}
+
+ChunkCache::ChunkCache(size_t budget)
+    : m_budget(budget), m_usedBytes(0), m_hits(0), m_misses(0), m_evictions(0) {}
+
+void ChunkCache::insert(const glm::ivec3& chunkPos, std::shared_ptr<const CachedChunk> chunk) {
+    if (!chunk) return;
+
+    invalidate(chunkPos);
+
+    size_t byteSize = chunk->byteSize();
+    if (byteSize > m_budget) return;
+
+    m_lru.push_front({chunkPos, std::move(chunk), byteSize});
+    m_entries[chunkPos] = m_lru.begin();
+    m_usedBytes += byteSize;
+
+    evictToBudget();
+}
+
+std::shared_ptr<const CachedChunk> ChunkCache::take(const glm::ivec3& chunkPos) {
+    auto it = m_entries.find(chunkPos);
+    if (it == m_entries.end()) {
+        m_misses++;
+        return nullptr;
+    }
+
+    std::shared_ptr<const CachedChunk> chunk = std::move(it->second->chunk);
+    erase(it);
+    m_hits++;
+    return chunk;
+}
+
+void ChunkCache::invalidate(const glm::ivec3& chunkPos) {
+    auto it = m_entries.find(chunkPos);
+    if (it != m_entries.end()) erase(it);
+}
+
+void ChunkCache::clear() {
+    m_lru.clear();
+    m_entries.clear();
+    m_usedBytes = 0;
+}
+
+void ChunkCache::setBudget(size_t budget) {
+    m_budget = budget;
+    evictToBudget();
+}
@@ -0,0 +1,96 @@
+#ifndef TOOMANYBLOCKS_CHUNKCACHE_H
+#define TOOMANYBLOCKS_CHUNKCACHE_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/blueprints/ChunkMeshBlueprint.h"
+#include "engine/env/Chunk.h"
+
+/**
+ * Cpu side state of an unchanged chunk that is enough to bring it back without generating or reading it from disk.
+ *
+ * Loaded chunks keep no cpu copy of their mesh, it is read back from the chunk geometry arena once the chunk
+ * unloads. The mesh is only reused if it matches the mesh format, baked occlusion and level of detail the chunk is
+ * loaded with, otherwise the chunk is meshed again from the cached blocks.
+ */
+struct CachedChunk {
+    std::vector<uint16_t> rleBlocks;    // (type, run length) pairs, see ChunkStorage::encodeBlocks()
+    ChunkConnectivity connectivity;     // Used for occlusion culling, see ChunkGrid
+    std::optional<ChunkMeshData> mesh;  // Missing if the chunk unloaded without an up to date mesh
+
+    size_t byteSize() const;
+};
+
+/**
+ * Memory budgeted LRU of recently unloaded chunks. Main thread only.
+ *
+ * Entries are removed when they are taken, the chunk is expected to hand its state back on the next unload.
+ */
+class ChunkCache {
+private:
+    struct Entry {
+        glm::ivec3 chunkPos;
+        std::shared_ptr<const CachedChunk> chunk;
+        size_t byteSize;
+    };
+
+    std::list<Entry> m_lru;  // Most recently inserted first
+    std::unordered_map<glm::ivec3, std::list<Entry>::iterator, coord_hash> m_entries;
+
+    size_t m_budget;
+    size_t m_usedBytes;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+
+    void erase(std::unordered_map<glm::ivec3, std::list<Entry>::iterator, coord_hash>::iterator it);
+
+    void evictToBudget();
+
+public:
+    ChunkCache(size_t budget);
+
+    /**
+     * Caches the state of an unloaded chunk, evicting the least recently unloaded chunks if the budget is exceeded.
+     * Chunks larger than the whole budget are not cached.
+     */
+    void insert(const glm::ivec3& chunkPos, std::shared_ptr<const CachedChunk> chunk);
+
+    /**
+     * Removes and returns the cached state of a chunk.
+     *
+     * @return The cached state, or nullptr on a cache miss.
+     */
+    std::shared_ptr<const CachedChunk> take(const glm::ivec3& chunkPos);
+
+    /**
+     * Drops the cached state of a chunk, e.g. because its block data changed.
+     */
+    void invalidate(const glm::ivec3& chunkPos);
+
+    void clear();
+
+    void setBudget(size_t budget);
+
+    inline size_t budget() const { return m_budget; }
+
+    inline size_t usedBytes() const { return m_usedBytes; }
+
+    inline size_t size() const { return m_entries.size(); }
+
+    inline uint64_t hits() const { return m_hits; }
+
+    inline uint64_t misses() const { return m_misses; }
+
+    inline uint64_t evictions() const { return m_evictions; }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "ChunkGrid.h"
+
+#include "engine/rendering/RenderScene.h"
+
+// Chunk coordinate offset of the neighbour behind each face, in AxisDirection order
+static const glm::ivec3 FACE_STEPS[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+static inline int floorShift(int value, int level) {
+    // Floors towards negative infinity, independent of how the platform shifts negative numbers
+    return value >= 0 ? value >> level : -((-value - 1) >> level) - 1;
+}
+
+glm::ivec3 ChunkGrid::cellCoord(const glm::ivec3& chunkCoord, int level) {
+    return {floorShift(chunkCoord.x, level), floorShift(chunkCoord.y, level), floorShift(chunkCoord.z, level)};
+}
+
+bool ChunkGrid::traverseFromCamera(const Frustum& frustum, const glm::vec3& cameraPos) const {
+    glm::ivec3 cameraChunk = glm::floor(cameraPos / static_cast<float>(CHUNK_SIZE));
+    auto cameraCell = m_levels[0].find(cameraChunk);
+    if (cameraCell == m_levels[0].end()) return false;
+
+    m_traversal++;
+    m_traversalQueue.clear();
+    cameraCell->second.reachedInTraversal = m_traversal;
+    m_traversalQueue.push_back({cameraChunk, -1, 0});
+
+    // The queue only grows, so it doubles as the list of visited steps
+    for (size_t next = 0; next < m_traversalQueue.size(); next++) {
+        TraversalStep step = m_traversalQueue[next];
+        ChunkConnectivity connectivity = m_levels[0].at(step.chunkCoord).chunk->connectivity();
+
+        for (int face = 0; face < 6; face++) {
+            // Opposite directions only differ in the lowest bit, see AxisDirection
+            int oppositeFace = face ^ 1;
+            if (step.stepDirections & (1u << oppositeFace)) continue;
+            if (step.entryFace >= 0 &&
+                !(connectivity & chunkFacePairBit(allAxisDirections[step.entryFace], allAxisDirections[face]))) {
+                continue;
+            }
+
+            glm::ivec3 neighbourCoord = step.chunkCoord + FACE_STEPS[face];
+            auto neighbour = m_levels[0].find(neighbourCoord);
+            if (neighbour == m_levels[0].end() || neighbour->second.reachedInTraversal == m_traversal) continue;
+
+            glm::vec3 min = glm::vec3(neighbourCoord) * static_cast<float>(CHUNK_SIZE);
+            if (frustum.classifyBox(min, min + static_cast<float>(CHUNK_SIZE)) == FrustumTest::Outside) continue;
+
+            neighbour->second.reachedInTraversal = m_traversal;
+            m_traversalQueue.push_back(
+                {neighbourCoord, oppositeFace, static_cast<uint8_t>(step.stepDirections | (1u << face))}
+            );
+        }
+    }
+
+    return true;
+}
+
+void ChunkGrid::collect(int level, const glm::ivec3& cell, CollectState& state) const {
+    if (level == 0) {
+        const Cell& chunkCell = m_levels[0].at(cell);
+        if (state.cullOccluded && chunkCell.reachedInTraversal != m_traversal) {
+            state.occludedChunks++;
+            return;
+        }
+
+        const RenderProxy* chunk = chunkCell.chunk->getRenderProxy();
+        if (chunk && chunk->ready) state.outputBuffer->push_back(chunk);
+        return;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        glm::ivec3 child = cell * 2 + glm::ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        if (m_levels[level - 1].count(child)) collect(level - 1, child, state);
+    }
+}
+
+void ChunkGrid::query(int level, const glm::ivec3& cell, const Frustum& frustum, CollectState& state) const {
+    float cellSize = static_cast<float>(CHUNK_SIZE << level);
+    glm::vec3 min = glm::vec3(cell) * cellSize;
+
+    state.testedCells++;
+    FrustumTest test = frustum.classifyBox(min, min + cellSize);
+    if (test == FrustumTest::Outside) return;
+    if (test == FrustumTest::Inside || level == 0) {
+        collect(level, cell, state);
+        return;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        glm::ivec3 child = cell * 2 + glm::ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        if (m_levels[level - 1].count(child)) query(level - 1, child, frustum, state);
+    }
+}
+
+void ChunkGrid::runQuery(const Frustum& frustum, CollectState& state) const {
+    for (const auto& topCell : m_levels[LEVEL_COUNT - 1]) {
+        query(LEVEL_COUNT - 1, topCell.first, frustum, state);
+    }
+}
+
+void ChunkGrid::insert(const glm::ivec3& chunkPos, Chunk* chunk) {
+    glm::ivec3 chunkCoord = chunkPos / CHUNK_SIZE;
+    auto it = m_levels[0].find(chunkCoord);
+    if (it != m_levels[0].end()) {
+        it->second.chunk = chunk;
+        return;
+    }
+
+    m_levels[0][chunkCoord] = {1, chunk, 0};
+    for (int level = 1; level < LEVEL_COUNT; level++) {
+        m_levels[level][cellCoord(chunkCoord, level)].chunkCount++;
+    }
+}
+
+void ChunkGrid::remove(const glm::ivec3& chunkPos) {
+    glm::ivec3 chunkCoord = chunkPos / CHUNK_SIZE;
+    if (m_levels[0].erase(chunkCoord) == 0) return;
+
+    for (int level = 1; level < LEVEL_COUNT; level++) {
+        auto it = m_levels[level].find(cellCoord(chunkCoord, level));
+        if (--it->second.chunkCount == 0) m_levels[level].erase(it);
+    }
+}
+
+size_t ChunkGrid::query(const Frustum& frustum, std::vector<const RenderProxy*>& outputBuffer) const {
+    CollectState state{&outputBuffer, 0, false, 0};
+    runQuery(frustum, state);
+    return state.testedCells;
+}
+
+size_t ChunkGrid::query(
+    const Frustum& frustum,
+    const glm::vec3& cameraPos,
+    std::vector<const RenderProxy*>& outputBuffer,
+    size_t& occludedChunks
+) const {
+    CollectState state{&outputBuffer, 0, traverseFromCamera(frustum, cameraPos), 0};
+    runQuery(frustum, state);
+    occludedChunks = state.occludedChunks;
+    return state.testedCells;
+}
@@ -0,0 +1,106 @@
+#ifndef TOOMANYBLOCKS_CHUNKGRID_H
+#define TOOMANYBLOCKS_CHUNKGRID_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/env/Chunk.h"
+#include "engine/rendering/Frustum.h"
+
+/**
+ * Sparse multi level grid over all loaded chunks, used to frustum cull chunks hierarchically.
+ *
+ * Level 0 cells are single chunks, every further level doubles the cell size along each axis, so the grid is an
+ * implicit octree. Only occupied cells exist, which lets a frustum query reject whole empty or invisible regions
+ * with a single test and accept cells that lie completely inside the frustum without testing their chunks.
+ *
+ * Queries can additionally cull occluded chunks. A breadth first search starts at the camera chunk and only
+ * crosses from one chunk face to another if the chunk connects both faces through air (see ChunkConnectivity),
+ * never walking back towards the camera. Chunks the search cannot reach are hidden behind solid terrain.
+ */
+class ChunkGrid {
+public:
+    static constexpr int LEVEL_COUNT = 6;  // Top level cells span 32 chunks per axis
+
+private:
+    struct Cell {
+        unsigned int chunkCount;              // Number of chunks below this cell
+        Chunk* chunk;                         // Only set on level 0
+        mutable uint32_t reachedInTraversal;  // Last occlusion traversal that reached this level 0 cell
+    };
+
+    struct TraversalStep {
+        glm::ivec3 chunkCoord;
+        int entryFace;           // Face the chunk was entered through, -1 for the camera chunk
+        uint8_t stepDirections;  // All directions stepped in on the way from the camera chunk
+    };
+
+    // Collect state of the query currently running, main thread only
+    struct CollectState {
+        std::vector<const RenderProxy*>* outputBuffer;
+        size_t testedCells;
+        bool cullOccluded;
+        size_t occludedChunks;
+    };
+
+    std::unordered_map<glm::ivec3, Cell, coord_hash> m_levels[LEVEL_COUNT];
+    mutable uint32_t m_traversal;
+    mutable std::vector<TraversalStep> m_traversalQueue;
+
+    static glm::ivec3 cellCoord(const glm::ivec3& chunkCoord, int level);
+
+    /**
+     * Marks all chunks reachable from the camera chunk as reached in a new traversal.
+     *
+     * @return False if the camera is not inside a loaded chunk, so nothing can be culled.
+     */
+    bool traverseFromCamera(const Frustum& frustum, const glm::vec3& cameraPos) const;
+
+    void collect(int level, const glm::ivec3& cell, CollectState& state) const;
+
+    void query(int level, const glm::ivec3& cell, const Frustum& frustum, CollectState& state) const;
+
+    void runQuery(const Frustum& frustum, CollectState& state) const;
+
+public:
+    ChunkGrid() : m_traversal(0) {}
+
+    /**
+     * Adds a chunk to the grid. The chunk has to stay valid until it is removed again.
+     *
+     * @param chunkPos World position of the chunk origin.
+     * @param chunk The chunk, its connectivity is read during occlusion culled queries.
+     */
+    void insert(const glm::ivec3& chunkPos, Chunk* chunk);
+
+    void remove(const glm::ivec3& chunkPos);
+
+    /**
+     * Appends all ready chunks whose cells intersect the frustum.
+     *
+     * @return Number of cells that had to be tested against the frustum.
+     */
+    size_t query(const Frustum& frustum, std::vector<const RenderProxy*>& outputBuffer) const;
+
+    /**
+     * Appends all ready chunks whose cells intersect the frustum and that are not occluded from the camera.
+     *
+     * @param cameraPos World position of the camera the frustum belongs to.
+     * @param occludedChunks Set to the number of chunks inside the frustum that were culled as occluded.
+     * @return Number of cells that had to be tested against the frustum.
+     */
+    size_t query(
+        const Frustum& frustum,
+        const glm::vec3& cameraPos,
+        std::vector<const RenderProxy*>& outputBuffer,
+        size_t& occludedChunks
+    ) const;
+
+    inline size_t size() const { return m_levels[0].size(); }
+};
+
+#endif
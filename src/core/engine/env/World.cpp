@@ -21,6 +21,13 @@
 #include "foundation/threading/ThreadPool.h"
 #include "foundation/util/Utility.h"
 
+// Memory budget for the cpu state of recently unloaded chunks
+static constexpr size_t CHUNK_CACHE_BUDGET = 64 << 20;
+// Requested chunks whose generation starts per update, so crossing a chunk border does not flood the workers
+static constexpr int MAX_CHUNK_LOADS_PER_UPDATE = 32;
+// Loads of a chunk that may fail in a row before it is dropped until the active set requests it again
+static constexpr int MAX_CHUNK_LOAD_ATTEMPTS = 3;
+
 static void generateChunkBlocks(Block* blocks, const glm::ivec3& chunkPos, uint32_t seed) {
     PerlinNoise noiseGenerator(seed);
 
@@ -67,13 +74,8 @@ static void generateChunkBlocks(Block* blocks, const glm::ivec3& chunkPos, uint3
     }
 }
 
-std::unordered_set<glm::ivec3, coord_hash> World::determineActiveChunks(const glm::ivec3& position) {
+std::unordered_set<glm::ivec3, coord_hash> World::determineActiveChunks(const glm::ivec3& centerChunk) {
     std::unordered_set<glm::ivec3, coord_hash> activeChunks;
-    glm::ivec3 centerChunk(
-        (position.x < 0 ? (position.x - CHUNK_WIDTH + 1) : position.x) / CHUNK_WIDTH * CHUNK_WIDTH,
-        (position.y < 0 ? (position.y - CHUNK_HEIGHT + 1) : position.y) / CHUNK_HEIGHT * CHUNK_HEIGHT,
-        (position.z < 0 ? (position.z - CHUNK_DEPTH + 1) : position.z) / CHUNK_DEPTH * CHUNK_DEPTH
-    );
 
     // Compute the range of chunk coordinates to load
     for (int x = -chunkLoadingDistance * CHUNK_WIDTH; x <= chunkLoadingDistance * CHUNK_WIDTH; x += CHUNK_WIDTH) {
@@ -94,22 +96,64 @@ std::unordered_set<glm::ivec3, coord_hash> World::determineActiveChunks(const gl
     return activeChunks;
 }
 
-World::World(const std::filesystem::path& worldDir) : m_worldDir(worldDir), m_cStorage(worldDir) {
+uint8_t World::lodLevelAt(float chunkDistance) const {
+    uint8_t level = 0;
+    float ringEnd = static_cast<float>(m_fullDetailDistance);
+    while (level < MAX_CHUNK_LOD_LEVEL && chunkDistance > ringEnd) {
+        level++;
+        ringEnd *= 2.0f;
+    }
+    return level;
+}
+
+uint8_t World::determineLodLevel(const glm::ivec3& chunkPos, uint8_t currentLevel) const {
+    float chunkDistance = glm::length(glm::vec3(chunkPos - m_activeCenter)) / CHUNK_SIZE;
+    return std::clamp(currentLevel, lodLevelAt(chunkDistance - 1.0f), lodLevelAt(chunkDistance + 1.0f));
+}
+
+World::World(const std::filesystem::path& worldDir)
+    : m_worldDir(worldDir),
+      m_cStorage(worldDir),
+      m_chunkCache(CHUNK_CACHE_BUDGET),
+      m_fullDetailDistance(3),
+      m_meshFormat(ChunkMeshFormat::Vertices),
+      m_bakedOcclusion(false),
+      m_meshSettingsRevision(0),
+      m_activeCenter(0),
+      m_activeSetValid(false) {
     m_taskContext = Application::getContext()->workerPool->getNewTaskContext();
 
     // Load world data
     Json::JsonValue info = Json::parseJson(readFile(worldDir / "info.json"));
     m_seed = static_cast<uint32_t>(std::stoul(info["seed"].toString()));
 
+    m_chunkArena = std::make_shared<ChunkGeometryArena>();
+
     CPUAssetProvider* provider = Application::getContext()->provider;
-    Future<Shader> mainShader = build(provider->getShader(Res::Shader::CHUNK));
-    Future<Shader> depthShader = build(provider->getShader(Res::Shader::CHUNK_DEPTH));
-    Future<Shader> ssaoGBuffShader = build(provider->getShader(Res::Shader::CHUNK_SSAO_GBUFFER));
+    ChunkShaderSet vertexShaders{
+        build(provider->getShader(Res::Shader::CHUNK)),
+        build(provider->getShader(Res::Shader::CHUNK_DEPTH)),
+        build(provider->getShader(Res::Shader::CHUNK_SSAO_GBUFFER))
+    };
+
+    ShaderDefines quadDefines;
+    quadDefines.add("CHUNK_QUAD_FORMAT");
+    ChunkShaderSet quadShaders{
+        build(provider->getShader(Res::Shader::CHUNK), quadDefines),
+        build(provider->getShader(Res::Shader::CHUNK_DEPTH), quadDefines),
+        build(provider->getShader(Res::Shader::CHUNK_SSAO_GBUFFER), quadDefines)
+    };
+
     Future<Texture> texture = build(provider->getTexture(Res::Texture::BLOCK_TEX_ATLAS));
-    m_chunkMaterial = std::make_shared<ChunkMaterial>(mainShader, depthShader, ssaoGBuffShader, texture);
+    m_chunkMaterial = std::make_shared<ChunkMaterial>(vertexShaders, quadShaders, texture, m_chunkArena);
 }
 
 World::~World() {
+    RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+    for (auto& entry : m_loadedChunks) {
+        if (entry.second.m_renderProxy) scene.removeProxy(entry.second.m_renderProxy);
+    }
+
     ThreadPool* pool = Application::getContext()->workerPool;
     pool->destroyTaskContext(m_taskContext);
     pool->waitForCurrentActiveTasks();
@@ -125,129 +169,367 @@ Chunk* World::getChunk(const glm::ivec3& location) {
     return nullptr;
 }
 
+template <typename T>
+void World::postOnCompletion(
+    const Future<T>& future,
+    const glm::ivec3& chunkPos,
+    ChunkState finishedState,
+    const CancellationToken& cancelToken
+) {
+    // Runs on the main thread like the update, skipped once the chunk is unloaded
+    Future<void> callback(
+        [this, chunkPos, finishedState]() { m_chunkEvents.push_back({chunkPos, finishedState}); },
+        m_taskContext,
+        Executor::Main
+    );
+    callback.cancelledBy(cancelToken).dependsOn(future).start();
+}
+
 void World::updateChunks(const glm::ivec3& position) {
-    // Step 1: Determine active chunk positions
-    std::unordered_set<glm::ivec3, coord_hash> activeChunks = determineActiveChunks(position);
-
-    // Step 2: Unload chunks that are no longer in the active set
-    for (auto it = m_loadedChunks.begin(); it != m_loadedChunks.end();) {
-        if (activeChunks.find(it->first) == activeChunks.end()) {
-            if (it->second.isMarkedForSave()) {
-                // Save chunk that will be unloaded but has changes
-                glm::ivec3 chunkPos = it->first;
-                std::shared_ptr<Block[]> blockData = std::move(it->second.m_blocks.value());
-
-                Future<void> future(
-                    [this, chunkPos, blockData]() {
-                        try {
-                            m_cStorage.saveChunkData(chunkPos, blockData.get());
-                        } catch (const std::exception& e) {
-                            lgr::lout.error(e.what());
-                        }
-                    },
-                    m_taskContext
-                );
-                future.start();
-            }
-            it = m_loadedChunks.erase(it);
-        } else {
-            ++it;  // Chunk is still active
-        }
-    }
+    RenderScene& scene = Application::getContext()->renderer->getRenderScene();
+
+    // Step 1: Advance chunks whose work finished since the last update
+    processChunkEvents(scene);
 
-    // Step 3: Process optional pending mesh build
-    for (auto it = m_loadedChunks.begin(); it != m_loadedChunks.end(); it++) {
-        it->second.tryCommitRebuild();
+    // Step 2: Unload and request chunks once the center chunk changed
+    glm::ivec3 centerChunk = Chunk::worldToChunkOrigin(glm::vec3(position));
+    if (!m_activeSetValid || centerChunk != m_activeCenter) {
+        updateActiveSet(centerChunk, scene);
     }
 
-    // Step 4: TODO Process pending changes for unloaded chunks
+    // Step 3: TODO Process pending changes for unloaded chunks
     // * Currently unhanlded *
     m_pendingChanges.clear();
 
-    // Step 5: Load chunks that are in the active set but not yet loaded or need mesh rebuild
-    for (const glm::ivec3& chunkPos : activeChunks) {
+    // Step 4: Start loading requested chunks, a limited number per update
+    int startedLoads = 0;
+    while (startedLoads < MAX_CHUNK_LOADS_PER_UPDATE && !m_requestedChunks.empty()) {
+        glm::ivec3 chunkPos = m_requestedChunks.front();
+        m_requestedChunks.pop_front();
+
         auto it = m_loadedChunks.find(chunkPos);
-        if (it == m_loadedChunks.end()) {
-            // Chunk does not exist -> Needs to be fully loaded
-
-            // Create new one
-            Future<std::unique_ptr<Block[]>> blockGenFuture(
-                [this, chunkPos]() {
-                    std::unique_ptr<Block[]> blocks;
-                    if (m_cStorage.hasChunk(chunkPos)) {
-                        blocks = m_cStorage.loadChunkData(chunkPos);
-                    } else {
-                        blocks = std::unique_ptr<Block[]>(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
-                        generateChunkBlocks(blocks.get(), chunkPos, m_seed);
-                    }
+        if (it == m_loadedChunks.end() || it->second.m_state != ChunkState::Requested) continue;
+        startLoading(chunkPos, it->second);
+        startedLoads++;
+    }
+
+    // Step 5: Rebuild the meshes of changed chunks
+    for (const glm::ivec3& chunkPos : m_dirtyChunks) {
+        auto it = m_loadedChunks.find(chunkPos);
+        if (it != m_loadedChunks.end() && it->second.m_state == ChunkState::Dirty) startRebuild(chunkPos, it->second);
+    }
+    m_dirtyChunks.clear();
+}
+
+void World::processChunkEvents(RenderScene& scene) {
+    for (const ChunkEvent& event : m_chunkEvents) {
+        auto it = m_loadedChunks.find(event.chunkPos);
+        if (it == m_loadedChunks.end() || it->second.m_state != event.finishedState) continue;
+
+        Chunk& chunk = it->second;
+        switch (event.finishedState) {
+            case ChunkState::Generating:
+                if (chunk.m_generatedBlocks.hasError()) {
+                    lgr::lout.error("Failed to load blocks of a chunk");
+                    chunk.m_generatedBlocks.reset();
+                    retryLoading(event.chunkPos, chunk, scene);
+                    break;
+                }
+                chunk.m_blocks = BlockStorage(chunk.m_generatedBlocks.value());
+                chunk.m_generatedBlocks.reset();
+                chunk.m_loadAttempts = 0;
+                chunk.m_state = ChunkState::Meshing;
+                break;
+
+            case ChunkState::Meshing: chunk.m_state = ChunkState::Uploading; break;
+
+            case ChunkState::Uploading:
+                if (chunk.m_pendingRebuildMesh.hasError()) {
+                    // Keep drawing the previous mesh
+                    lgr::lout.error("Failed to rebuild the mesh of a chunk");
+                    chunk.m_pendingRebuildMesh.reset();
+                } else if (chunk.tryCommitRebuild()) {
+                    scene.updateProxy(chunk.m_renderProxy);
+                }
+                chunk.m_state = ChunkState::Live;
+                if (chunk.needsRemesh(m_meshSettingsRevision)) markDirty(event.chunkPos, chunk);
+                break;
+
+            case ChunkState::Unloading:
+                m_loadedChunks.erase(it);
+                if (m_activeChunks.count(event.chunkPos)) requestChunk(event.chunkPos, scene);
+                break;
+
+            default: break;
+        }
+    }
+    m_chunkEvents.clear();
+}
+
+void World::updateActiveSet(const glm::ivec3& centerChunk, RenderScene& scene) {
+    m_activeCenter = centerChunk;
+    m_activeSetValid = true;
+    m_activeChunks = determineActiveChunks(centerChunk);
+
+    std::vector<glm::ivec3> leftChunks;
+    std::vector<glm::ivec3> requestedChunks;
+    for (auto& entry : m_loadedChunks) {
+        Chunk& chunk = entry.second;
+        if (!m_activeChunks.count(entry.first)) {
+            if (chunk.m_state != ChunkState::Unloading) leftChunks.push_back(entry.first);
+            continue;
+        }
+        if (chunk.m_state == ChunkState::Requested) requestedChunks.push_back(entry.first);
 
-                    return std::move(blocks);
-                },
-                m_taskContext
-            );
-            blockGenFuture.start();
-
-            Future<CPURenderData<CompactChunkVertex>> cpuMeshBuildFuture(
-                [this, blockGenFuture]() { return generateMeshForChunkGreedy(blockGenFuture.value().get(), texMap); },
-                m_taskContext
-            );
-            cpuMeshBuildFuture.dependsOn(blockGenFuture).start();
-
-            Future<StaticMesh::Internal> meshCreateFuture(
-                [cpuMeshBuildFuture]() {
-                    return StaticMesh::Internal{
-                        createSharedState(cpuMeshBuildFuture.value()), createInstanceState(cpuMeshBuildFuture.value())
-                    };
-                },
-                m_taskContext,
-                Executor::Main
-            );
-            meshCreateFuture.dependsOn(cpuMeshBuildFuture).start();
-
-            // Put placeholder chunk (Chunk with no block data / mesh)
-            Chunk placeHolder = Chunk();
-            placeHolder.m_blocks = blockGenFuture;
-            placeHolder.m_mesh = StaticMesh(meshCreateFuture, m_chunkMaterial);
-            placeHolder.m_mesh.getLocalTransform().setPosition(chunkPos);
-            m_loadedChunks[chunkPos] = std::move(placeHolder);
-
-        } else if (it->second.isChanged() && !it->second.isBeingRebuild()) {
-            // Chunk already exists and needs a rebuild (and no other worker is currently rebuilding this) -> rebuild
-            // only mesh data
-
-            // Make copy of blockdata
-            std::shared_ptr<Block[]> blocksCopy(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
-            const Block* src = it->second.blocks();
-            std::copy(src, src + BLOCKS_PER_CHUNK, blocksCopy.get());
-
-            it->second.m_changed = false;
-
-            Future<CPURenderData<CompactChunkVertex>> cpuMeshBuildFuture(
-                [this, blocksCopy]() { return generateMeshForChunkGreedy(blocksCopy.get(), texMap); }, m_taskContext
-            );
-            cpuMeshBuildFuture.start();
-
-            Future<StaticMesh::Internal> meshCreateFuture(
-                [cpuMeshBuildFuture]() {
-                    return StaticMesh::Internal{
-                        createSharedState(cpuMeshBuildFuture.value()), createInstanceState(cpuMeshBuildFuture.value())
-                    };
-                },
-                m_taskContext,
-                Executor::Main
-            );
-            meshCreateFuture.dependsOn(cpuMeshBuildFuture).start();
-
-            m_loadedChunks[chunkPos].m_pendingRebuildMesh = meshCreateFuture;
+        // Chunks crossing a ring border are remeshed, in flight ones once their current mesh is uploaded
+        uint8_t lodLevel = determineLodLevel(entry.first, chunk.m_lodLevel);
+        if (lodLevel != chunk.m_lodLevel) {
+            chunk.m_lodLevel = lodLevel;
+            markDirty(entry.first, chunk);
         }
     }
+    for (const glm::ivec3& chunkPos : leftChunks) {
+        unloadChunk(chunkPos, scene);
+    }
+
+    for (const glm::ivec3& chunkPos : m_activeChunks) {
+        if (!m_loadedChunks.count(chunkPos)) {
+            requestChunk(chunkPos, scene);
+            requestedChunks.push_back(chunkPos);
+        }
+    }
+
+    // Chunks still waiting from earlier centers are reordered as well
+    std::sort(requestedChunks.begin(), requestedChunks.end(), [&](const glm::ivec3& a, const glm::ivec3& b) {
+        glm::ivec3 da = a - centerChunk;
+        glm::ivec3 db = b - centerChunk;
+        return da.x * da.x + da.y * da.y + da.z * da.z < db.x * db.x + db.y * db.y + db.z * db.z;
+    });
+    m_requestedChunks.assign(requestedChunks.begin(), requestedChunks.end());
+}
+
+void World::requestChunk(const glm::ivec3& chunkPos, RenderScene& scene) {
+    // Placeholder chunk without block data and mesh until its load starts
+    Chunk& chunk = m_loadedChunks[chunkPos];
+    chunk.m_cancelToken = CancellationToken::create();
+    chunk.m_lodLevel = lodLevelAt(glm::length(glm::vec3(chunkPos - m_activeCenter)) / CHUNK_SIZE);
+    chunk.m_mesh = StaticMesh(Future<StaticMesh::Internal>(), m_chunkMaterial);
+    chunk.m_mesh.getLocalTransform().setPosition(chunkPos);
+    chunk.m_renderProxy = scene.addProxy(&chunk.m_mesh, false);
+    m_chunkGrid.insert(chunkPos, &chunk);
+}
+
+void World::retryLoading(const glm::ivec3& chunkPos, Chunk& chunk, RenderScene& scene) {
+    if (++chunk.m_loadAttempts >= MAX_CHUNK_LOAD_ATTEMPTS) {
+        lgr::lout.error("Giving up loading a chunk until it is requested again");
+        unloadChunk(chunkPos, scene);
+        return;
+    }
+
+    // The failed meshing of this attempt must not post events into the next one
+    chunk.m_cancelToken.cancel();
+    chunk.m_cancelToken = CancellationToken::create();
+    chunk.m_state = ChunkState::Requested;
+    m_requestedChunks.push_back(chunkPos);
+}
+
+void World::unloadChunk(const glm::ivec3& chunkPos, RenderScene& scene) {
+    auto it = m_loadedChunks.find(chunkPos);
+    Chunk& chunk = it->second;
+
+    // Pending generation, meshing and upload of this chunk is no longer needed
+    chunk.m_cancelToken.cancel();
+    m_chunkGrid.remove(chunkPos);
+    scene.removeProxy(chunk.m_renderProxy);
+    chunk.m_renderProxy = nullptr;
+
+    if (chunk.isMarkedForSave()) {
+        // Save chunk that will be unloaded but has changes, it is only removed once written so a reload reads them
+        std::shared_ptr<const Block[]> blockData = chunk.m_blocks.snapshot();
+        chunk.m_savedVersion = chunk.m_blocks.version();
+        chunk.m_state = ChunkState::Unloading;
+
+        Future<void> future(
+            [this, chunkPos, blockData]() {
+                try {
+                    m_cStorage.saveChunkData(chunkPos, blockData.get());
+                } catch (const std::exception& e) {
+                    lgr::lout.error(e.what());
+                }
+            },
+            m_taskContext
+        );
+        future.start();
+        postOnCompletion(future, chunkPos, ChunkState::Unloading, CancellationToken());
+        return;
+    }
+
+    bool connectivityKnown = chunk.m_connectivity.isReady() && !chunk.m_connectivity.hasError();
+    if (!chunk.isChanged() && !chunk.m_blocks.empty() && connectivityKnown) {
+        // Blocks are only encoded and the mesh only read back once the chunk leaves, so coming back skips generation,
+        // disk reads and, if the mesh is still up to date then, meshing
+        std::shared_ptr<CachedChunk> cached = std::make_shared<CachedChunk>();
+        cached->rleBlocks = ChunkStorage::encodeBlocks(chunk.m_blocks.data());
+        cached->connectivity = chunk.m_connectivity.value();
+        if (chunk.m_state == ChunkState::Live && !chunk.needsRemesh(m_meshSettingsRevision)) {
+            cached->mesh = readBackChunkMesh(chunk.m_mesh, m_bakedOcclusion, chunk.m_meshLodLevel);
+        }
+        m_chunkCache.insert(chunkPos, std::move(cached));
+    }
+    m_loadedChunks.erase(it);
+}
+
+void World::startLoading(const glm::ivec3& chunkPos, Chunk& chunk) {
+    std::shared_ptr<const CachedChunk> cached = m_chunkCache.take(chunkPos);
+    const CancellationToken& cancelToken = chunk.m_cancelToken;
+    ChunkMeshFormat format = m_meshFormat;
+    bool bakedOcclusion = m_bakedOcclusion;
+    uint8_t lodLevel = chunk.m_lodLevel;
+    bool reuseMesh = cached && cached->mesh && cached->mesh->format == format &&
+                     cached->mesh->bakedOcclusion == bakedOcclusion && cached->mesh->lodLevel == lodLevel;
+
+    Future<std::shared_ptr<Block[]>> blockGenFuture(
+        [this, chunkPos, cached]() -> std::shared_ptr<Block[]> {
+            if (cached) return ChunkStorage::decodeBlocks(cached->rleBlocks.data(), cached->rleBlocks.size() / 2);
+
+            std::unique_ptr<Block[]> blocks;
+            if (m_cStorage.hasChunk(chunkPos)) {
+                blocks = m_cStorage.loadChunkData(chunkPos);
+            } else {
+                blocks = std::unique_ptr<Block[]>(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
+                generateChunkBlocks(blocks.get(), chunkPos, m_seed);
+            }
+
+            return blocks;
+        },
+        m_taskContext
+    );
+    blockGenFuture.cancelledBy(cancelToken).start();
+
+    // Reused meshes still wait for the blocks, chunk events have to arrive in the order of the chunk states
+    Future<ChunkMeshData> meshFuture(
+        [this, blockGenFuture, format, bakedOcclusion, lodLevel, cached, reuseMesh]() {
+            if (reuseMesh) return *cached->mesh;
+            return generateChunkMesh(blockGenFuture.value().get(), texMap, format, bakedOcclusion, lodLevel);
+        },
+        m_taskContext
+    );
+    meshFuture.cancelledBy(cancelToken).dependsOn(blockGenFuture).start();
+
+    Future<ChunkConnectivity> connectivityFuture(
+        [blockGenFuture, cached]() {
+            if (cached) return cached->connectivity;
+            return computeChunkConnectivity(blockGenFuture.value().get());
+        },
+        m_taskContext
+    );
+    connectivityFuture.cancelledBy(cancelToken);
+    if (!cached) connectivityFuture.dependsOn(blockGenFuture);
+    connectivityFuture.start();
+
+    chunk.m_state = ChunkState::Generating;
+    chunk.m_meshLodLevel = lodLevel;
+    chunk.m_meshSettingsRevision = m_meshSettingsRevision;
+    chunk.m_generatedBlocks = blockGenFuture;
+    chunk.m_connectivity = connectivityFuture;
+    chunk.m_mesh.getAssetHandle() = startMeshing(chunkPos, meshFuture, cancelToken);
+    postOnCompletion(blockGenFuture, chunkPos, ChunkState::Generating, cancelToken);
+}
+
+Future<StaticMesh::Internal> World::startMeshing(
+    const glm::ivec3& chunkPos,
+    Future<ChunkMeshData> mesh,
+    const CancellationToken& cancelToken
+) {
+    // Mesh data is written into the staging ring by workers, the main thread only issues gpu copies. The cpu mesh is
+    // moved into staging, no copy of it is kept once the chunk is uploaded.
+    UploadManager* uploads = &Application::getContext()->renderer->getUploadManager();
+
+    Future<StagedChunkMesh> cpuMeshBuildFuture(
+        [mesh, uploads]() mutable { return stageChunkMesh(std::move(mesh.value()), *uploads); },
+        m_taskContext
+    );
+    cpuMeshBuildFuture.cancelledBy(cancelToken).dependsOn(mesh).start();
+
+    Future<StaticMesh::Internal> meshCreateFuture(
+        [cpuMeshBuildFuture, uploads, arena = m_chunkArena]() {
+            return StaticMesh::Internal{
+                createSharedState(cpuMeshBuildFuture.value(), *uploads, arena),
+                createInstanceState(cpuMeshBuildFuture.value())
+            };
+        },
+        m_taskContext,
+        Executor::Main
+    );
+    meshCreateFuture.cancelledBy(cancelToken).dependsOn(cpuMeshBuildFuture).start();
+
+    postOnCompletion(cpuMeshBuildFuture, chunkPos, ChunkState::Meshing, cancelToken);
+    postOnCompletion(meshCreateFuture, chunkPos, ChunkState::Uploading, cancelToken);
+    return meshCreateFuture;
+}
+
+void World::startRebuild(const glm::ivec3& chunkPos, Chunk& chunk) {
+    // Edits from now on copy the blocks instead of changing them under the mesh build
+    std::shared_ptr<const Block[]> blocks = chunk.m_blocks.snapshot();
+
+    ChunkMeshFormat format = m_meshFormat;
+    bool bakedOcclusion = m_bakedOcclusion;
+    uint8_t lodLevel = chunk.m_lodLevel;
+    Future<ChunkMeshData> meshFuture(
+        [this, blocks, format, bakedOcclusion, lodLevel]() {
+            return generateChunkMesh(blocks.get(), texMap, format, bakedOcclusion, lodLevel);
+        },
+        m_taskContext
+    );
+    meshFuture.cancelledBy(chunk.m_cancelToken).start();
+
+    Future<ChunkConnectivity> connectivityFuture(
+        [blocks]() { return computeChunkConnectivity(blocks.get()); }, m_taskContext
+    );
+    connectivityFuture.cancelledBy(chunk.m_cancelToken).start();
+
+    chunk.m_changed = false;
+    chunk.m_meshLodLevel = lodLevel;
+    chunk.m_meshSettingsRevision = m_meshSettingsRevision;
+    chunk.m_state = ChunkState::Meshing;
+    chunk.m_connectivity = connectivityFuture;
+    chunk.m_pendingRebuildMesh = startMeshing(chunkPos, meshFuture, chunk.m_cancelToken);
+}
+
+void World::markDirty(const glm::ivec3& chunkPos, Chunk& chunk) {
+    if (chunk.m_state != ChunkState::Live) return;
+
+    chunk.m_state = ChunkState::Dirty;
+    m_dirtyChunks.push_back(chunkPos);
+}
+
+void World::requestRemesh() {
+    // Chunks in flight are requeued once their current mesh is uploaded, their blocks stay unchanged
+    m_meshSettingsRevision++;
+    for (auto& entry : m_loadedChunks) {
+        markDirty(entry.first, entry.second);
+    }
+}
+
+void World::setChunkMeshFormat(ChunkMeshFormat format) {
+    if (format == m_meshFormat) return;
+
+    m_meshFormat = format;
+    requestRemesh();
+}
+
+void World::setBakedAmbientOcclusionEnabled(bool enabled) {
+    if (enabled == m_bakedOcclusion) return;
+
+    m_bakedOcclusion = enabled;
+    requestRemesh();
 }
 
 void World::syncedSaveChunks() {
     for (auto& entry : m_loadedChunks) {
         if (entry.second.isMarkedForSave()) {
             m_cStorage.saveChunkData(entry.first, entry.second.blocks());
-            entry.second.m_isMarkedForSave = false;
+            entry.second.m_savedVersion = entry.second.m_blocks.version();
         }
     }
 }
@@ -257,13 +539,14 @@ void World::setBlock(const glm::ivec3& position, uint16_t newBlock) {
     if (Chunk* chunk = getChunk(chunkPos)) {
         // Immediate data change if chunk is loaded
         glm::ivec3 relChunkPos = Chunk::worldToChunkLocal(chunkPos, position);
-        chunk->m_blocks.value()[chunkBlockIndex(relChunkPos.x, relChunkPos.y, relChunkPos.z)] = {
+        chunk->m_blocks.edit()[chunkBlockIndex(relChunkPos.x, relChunkPos.y, relChunkPos.z)] = {
             newBlock, newBlock != AIR
         };
         chunk->m_changed = true;
-        chunk->m_isMarkedForSave = true;
+        markDirty(chunkPos, *chunk);
     } else {
         // Queue changes
         m_pendingChanges[position] = newBlock;
+        m_chunkCache.invalidate(chunkPos);
     }
 }
\ No newline at end of file
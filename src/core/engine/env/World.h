@@ -1,34 +1,108 @@
 #ifndef TOOMANYBLOCKS_WORLD_H
 #define TOOMANYBLOCKS_WORLD_H
 
+#include <deque>
 #include <filesystem>
 #include <glm/vec3.hpp>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "engine/blueprints/ChunkMeshBlueprint.h"
 #include "engine/env/Chunk.h"
+#include "engine/env/ChunkCache.h"
+#include "engine/env/ChunkGrid.h"
 #include "engine/persistence/ChunkStorage.h"
 #include "engine/rendering/BlockToTextureMapping.h"
+#include "engine/rendering/ChunkGeometryArena.h"
 #include "engine/rendering/Vertices.h"
 #include "engine/rendering/mat/ChunkMaterial.h"
 #include "engine/resource/cpu/CPURenderData.h"
+#include "foundation/threading/CancellationToken.h"
 #include "foundation/threading/Future.h"
 
+class RenderScene;
+
 class World {
 private:
+    // Posted on the main thread when the work of a chunk state finished
+    struct ChunkEvent {
+        glm::ivec3 chunkPos;
+        ChunkState finishedState;
+    };
+
     uint64_t m_taskContext;
 
     uint32_t m_seed;
     const std::filesystem::path m_worldDir;
     ChunkStorage m_cStorage;
+    ChunkCache m_chunkCache;
+    ChunkGrid m_chunkGrid;
     int chunkLoadingDistance;
+    int m_fullDetailDistance;  // Chunks further away are meshed at a lower level of detail, doubling per ring
     std::unordered_map<glm::ivec3, Chunk, coord_hash> m_loadedChunks;
+    std::shared_ptr<ChunkGeometryArena> m_chunkArena;
     std::shared_ptr<Material> m_chunkMaterial;
+    ChunkMeshFormat m_meshFormat;
+    bool m_bakedOcclusion;
+    uint32_t m_meshSettingsRevision;  // Bumped whenever chunk meshes built before have to be remeshed
 
     std::unordered_map<glm::ivec3, uint16_t, coord_hash> m_pendingChanges;
 
-    std::unordered_set<glm::ivec3, coord_hash> determineActiveChunks(const glm::ivec3& position);
+    // Chunks only change state through these lists, so an update costs as much as the chunks that changed
+    glm::ivec3 m_activeCenter;
+    bool m_activeSetValid;  // Recomputed once the center chunk or the loading distance changed
+    std::unordered_set<glm::ivec3, coord_hash> m_activeChunks;
+    std::deque<glm::ivec3> m_requestedChunks;  // Nearest to the center first
+    std::vector<glm::ivec3> m_dirtyChunks;
+    std::vector<ChunkEvent> m_chunkEvents;
+
+    std::unordered_set<glm::ivec3, coord_hash> determineActiveChunks(const glm::ivec3& centerChunk);
+
+    uint8_t lodLevelAt(float chunkDistance) const;
+
+    // Level of detail of a chunk around the active center, kept near ring borders to not remesh on every step
+    uint8_t determineLodLevel(const glm::ivec3& chunkPos, uint8_t currentLevel) const;
+
+    template <typename T>
+    void postOnCompletion(
+        const Future<T>& future,
+        const glm::ivec3& chunkPos,
+        ChunkState finishedState,
+        const CancellationToken& cancelToken
+    );
+
+    void processChunkEvents(RenderScene& scene);
+
+    void updateActiveSet(const glm::ivec3& centerChunk, RenderScene& scene);
+
+    void requestChunk(const glm::ivec3& chunkPos, RenderScene& scene);
+
+    // Requests a chunk whose blocks failed to load again, unloads it after too many failed attempts
+    void retryLoading(const glm::ivec3& chunkPos, Chunk& chunk, RenderScene& scene);
+
+    void unloadChunk(const glm::ivec3& chunkPos, RenderScene& scene);
+
+    void startLoading(const glm::ivec3& chunkPos, Chunk& chunk);
+
+    /**
+     * Stages and uploads a chunk mesh once it is built, posting the Meshing and Uploading events.
+     */
+    Future<StaticMesh::Internal> startMeshing(
+        const glm::ivec3& chunkPos,
+        Future<ChunkMeshData> mesh,
+        const CancellationToken& cancelToken
+    );
+
+    void startRebuild(const glm::ivec3& chunkPos, Chunk& chunk);
+
+    // Queues a rebuild of a live chunk, chunks in flight are requeued once their current mesh is uploaded
+    void markDirty(const glm::ivec3& chunkPos, Chunk& chunk);
+
+    // Remeshes all chunks after the mesh settings changed, chunks keep drawing their old mesh until the new one is
+    // committed
+    void requestRemesh();
 
 public:
     const BlockToTextureMap texMap;
@@ -49,9 +123,43 @@ public:
 
     std::unordered_map<glm::ivec3, Chunk, coord_hash>& loadedChunks() { return m_loadedChunks; }
 
-    inline void setChunkLoadingDistance(int distance) { chunkLoadingDistance = distance; }
+    inline const ChunkGeometryArena& chunkArena() const { return *m_chunkArena; }
+
+    inline const ChunkCache& chunkCache() const { return m_chunkCache; }
+
+    inline const ChunkGrid& chunkGrid() const { return m_chunkGrid; }
+
+    /**
+     * Switches the mesh format used for chunk meshes and remeshes all loaded chunks.
+     */
+    void setChunkMeshFormat(ChunkMeshFormat format);
+
+    inline ChunkMeshFormat getChunkMeshFormat() const { return m_meshFormat; }
+
+    /**
+     * Toggles per vertex ambient occlusion baked into chunk meshes and remeshes all loaded chunks.
+     */
+    void setBakedAmbientOcclusionEnabled(bool enabled);
+
+    inline bool isBakedAmbientOcclusionEnabled() const { return m_bakedOcclusion; }
+
+    inline void setChunkLoadingDistance(int distance) {
+        chunkLoadingDistance = distance;
+        m_activeSetValid = false;
+    }
 
     inline int getChunkLoadingDistance() const { return chunkLoadingDistance; }
+
+    /**
+     * Sets the distance in chunks up to which chunks are meshed at full detail. Each further ring of twice the
+     * distance is meshed at the next level of detail, up to MAX_CHUNK_LOD_LEVEL.
+     */
+    inline void setFullDetailDistance(int distance) {
+        m_fullDetailDistance = distance;
+        m_activeSetValid = false;
+    }
+
+    inline int getFullDetailDistance() const { return m_fullDetailDistance; }
 };
 
 #endif
@@ -5,14 +5,10 @@
 
 #include <glm/glm.hpp>
 
-#define MAX_LIGHTS 84  // TODO: Replace with dynamic stuff
+#define MAX_LIGHTS 256  // Fills the 16KB uniform blocks every implementation supports
 
-enum LightPriority {
-    High = 0,
-    Medium,
-    Low,
-    Count
-};
+// Shadow maps of all lights are packed into this many atlas textures
+#define SHADOW_ATLAS_PAGES 3
 
 enum class LightType : uint8_t {
     Directional,
@@ -22,8 +18,8 @@ enum class LightType : uint8_t {
 
 struct alignas(16) GPULight {
     unsigned int lightType;
-    unsigned int priority;
-    unsigned int shadowMapIndex;
+    unsigned int shadowAtlasPage;
+    unsigned int shadowTile;        // Packed position and size of the shadow map in its atlas page, in tile units
     float intensity;
     glm::vec3 lightPosition;
     float range;                    // Used by point- / spotlight
@@ -44,14 +40,16 @@ public:
     inline glm::vec3 getColor() const { return m_internal.color; }
     inline float getIntensity() const { return m_internal.intensity; }
     inline float getRange() const { return m_internal.range; }
-    inline LightPriority getPriotity() const { return static_cast<LightPriority>(m_internal.priority); }
-    inline int getShadowAtlasIndex() const { return m_internal.shadowMapIndex; }
+    inline unsigned int getShadowAtlasPage() const { return m_internal.shadowAtlasPage; }
+    inline unsigned int getShadowTile() const { return m_internal.shadowTile; }
 
     inline void setColor(const glm::vec3& color) { m_internal.color = color; }
     inline void setIntensity(float intensity) { m_internal.intensity = intensity; }
     inline void setRange(float range) { m_internal.range = range; }
-    inline void setPriotity(LightPriority prio) { m_internal.priority = static_cast<unsigned int>(prio); }
-    inline void setShadowAtlasIndex(int index) { m_internal.shadowMapIndex = index; }
+    inline void setShadowTile(unsigned int atlasPage, unsigned int packedTile) {
+        m_internal.shadowAtlasPage = atlasPage;
+        m_internal.shadowTile = packedTile;
+    }
 
     virtual GPULight toGPULight();
     virtual LightType getType() const = 0;
@@ -37,6 +37,63 @@ std::shared_ptr<std::mutex> ChunkStorage::getChunkMutex(const glm::ivec3& pos) {
     return newMutex;
 }
 
+std::vector<uint16_t> ChunkStorage::encodeBlocks(const Block* blocks) {
+    std::vector<uint16_t> rlePairs;
+
+    uint16_t lastType = blocks[0].type;
+    uint16_t runLength = 1;
+
+    for (size_t i = 1; i < BLOCKS_PER_CHUNK; i++) {
+        uint16_t currType = blocks[i].type;
+
+        if (currType == lastType && runLength < UINT16_MAX) {
+            runLength++;
+        } else {
+            rlePairs.push_back(lastType);
+            rlePairs.push_back(runLength);
+
+            lastType = currType;
+            runLength = 1;
+        }
+    }
+
+    // Final entry
+    rlePairs.push_back(lastType);
+    rlePairs.push_back(runLength);
+    return rlePairs;
+}
+
+std::unique_ptr<Block[]> ChunkStorage::decodeBlocks(const uint16_t* rlePairs, size_t pairCount) {
+    size_t blockIndex = 0;
+    std::unique_ptr<Block[]> blocks(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
+
+    for (size_t pair = 0; pair < pairCount && blockIndex < BLOCKS_PER_CHUNK; pair++) {
+        uint16_t blockType = rlePairs[pair * 2];
+        uint16_t runLength = rlePairs[pair * 2 + 1];
+
+        if (blockIndex + runLength > BLOCKS_PER_CHUNK) {
+            throw std::runtime_error(
+                "RLE run length of " + std::to_string(runLength) + " exceeds chunk size at index " +
+                std::to_string(blockIndex)
+            );
+        }
+
+        Block fillBlock = {blockType, blockType != AIR};
+        for (uint16_t i = 0; i < runLength; i++) {
+            blocks[blockIndex++] = fillBlock;
+        }
+    }
+
+    if (blockIndex != BLOCKS_PER_CHUNK) {
+        throw std::runtime_error(
+            "Chunk RLE decoding ended prematurely. Expected " + std::to_string(BLOCKS_PER_CHUNK) + " blocks, but got " +
+            std::to_string(blockIndex)
+        );
+    }
+
+    return blocks;
+}
+
 ChunkStorage::ChunkStorage(const std::filesystem::path& worldPath) : m_chunkStoragePath(worldPath / "chunks") {
     if (!std::filesystem::exists(m_chunkStoragePath)) {
         std::filesystem::create_directories(m_chunkStoragePath);
@@ -87,39 +144,18 @@ std::unique_ptr<Block[]> ChunkStorage::loadChunkData(const glm::ivec3& chunkPos)
         throw std::runtime_error("Failed to read flags byte from chunk file: " + chunkFilePath.string());
     }
 
-    size_t blockIndex = 0;
-    std::unique_ptr<Block[]> blocks(new Block[BLOCKS_PER_CHUNK], std::default_delete<Block[]>());
-
-    while (file && blockIndex < BLOCKS_PER_CHUNK) {
+    std::vector<uint16_t> rlePairs;
+    while (file) {
         uint16_t rlePair[2];
 
         file.read(reinterpret_cast<char*>(rlePair), sizeof(rlePair));
         if (file.gcount() != sizeof(rlePair)) break;
 
-        uint16_t blockType = rlePair[0];
-        uint16_t runLength = rlePair[1];
-
-        if (blockIndex + runLength > BLOCKS_PER_CHUNK) {
-            throw std::runtime_error(
-                "RLE run length of " + std::to_string(runLength) + " exceeds chunk size at index " +
-                std::to_string(blockIndex)
-            );
-        }
-
-        Block fillBlock = {blockType, blockType != AIR};
-        for (uint16_t i = 0; i < runLength; i++) {
-            blocks[blockIndex++] = fillBlock;
-        }
-    }
-
-    if (blockIndex != BLOCKS_PER_CHUNK) {
-        throw std::runtime_error(
-            "Chunk RLE decoding ended prematurely. Expected " + std::to_string(BLOCKS_PER_CHUNK) + " blocks, but got " +
-            std::to_string(blockIndex)
-        );
+        rlePairs.push_back(rlePair[0]);
+        rlePairs.push_back(rlePair[1]);
     }
 
-    return std::move(blocks);
+    return decodeBlocks(rlePairs.data(), rlePairs.size() / 2);
 }
 
 void ChunkStorage::saveChunkData(const glm::ivec3& chunkPos, const Block* blocks) {
@@ -142,25 +178,6 @@ void ChunkStorage::saveChunkData(const glm::ivec3& chunkPos, const Block* blocks
     file.write(reinterpret_cast<char*>(&version), 1);
     file.write(reinterpret_cast<char*>(&flags), 1);
 
-    uint16_t lastType = blocks[0].type;
-    uint16_t runLength = 1;
-
-    for (size_t i = 1; i < BLOCKS_PER_CHUNK; i++) {
-        uint16_t currType = blocks[i].type;
-
-        if (currType == lastType && runLength < UINT16_MAX) {
-            runLength++;
-        } else {
-            // Write type and run length
-            file.write(reinterpret_cast<char*>(&lastType), sizeof(uint16_t));
-            file.write(reinterpret_cast<char*>(&runLength), sizeof(uint16_t));
-
-            lastType = currType;
-            runLength = 1;
-        }
-    }
-
-    // Write final entry
-    file.write(reinterpret_cast<char*>(&lastType), sizeof(uint16_t));
-    file.write(reinterpret_cast<char*>(&runLength), sizeof(uint16_t));
+    std::vector<uint16_t> rlePairs = encodeBlocks(blocks);
+    file.write(reinterpret_cast<const char*>(rlePairs.data()), rlePairs.size() * sizeof(uint16_t));
 }
\ No newline at end of file
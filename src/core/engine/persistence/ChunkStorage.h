@@ -6,6 +6,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/env/Chunk.h"
 
@@ -18,6 +19,18 @@ private:
     std::shared_ptr<std::mutex> getChunkMutex(const glm::ivec3& pos);
 
 public:
+    /**
+     * Run length encodes block data as (type, run length) pairs, the same encoding chunk files use.
+     */
+    static std::vector<uint16_t> encodeBlocks(const Block* blocks);
+
+    /**
+     * Decodes run length encoded block data created by encodeBlocks().
+     *
+     * @throws std::runtime_error If the runs do not add up to exactly one chunk.
+     */
+    static std::unique_ptr<Block[]> decodeBlocks(const uint16_t* rlePairs, size_t pairCount);
+
     ChunkStorage(const std::filesystem::path& worldPath);
 
     bool hasChunk(const glm::ivec3& chunkPos);
@@ -0,0 +1,300 @@
+#include "ChunkGeometryArena.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include "Logger.h"
+#include "engine/rendering/GLUtils.h"
+#include "engine/rendering/Vertices.h"
+
+static constexpr size_t INITIAL_VERTEX_CAPACITY = 1 << 20;
+static constexpr size_t INITIAL_INDEX_CAPACITY = 3 << 19;
+static constexpr size_t INITIAL_QUAD_CAPACITY = 1 << 18;
+// Every quad is expanded into two triangles by the vertex shader
+static constexpr unsigned int VERTICES_PER_QUAD = 6;
+// Draws that fit into the streamed command / draw data buffers before they wrap around
+static constexpr size_t STREAM_DRAW_CAPACITY = 16384;
+
+void ChunkGeometryArena::rebuildVertexArray() {
+    VertexArray vao = VertexArray::create();
+    vao.addBuffer(m_vertexBuffer);
+    vao.addInstanceBuffer(m_drawIndexBuffer);
+
+    // The element buffer binding is part of the vao state
+    GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer.rendererId()));
+    IndexBuffer::syncBinding();
+
+    m_vao = std::move(vao);
+}
+
+void ChunkGeometryArena::growVertexStorage(size_t minCapacity) {
+    size_t newCapacity = std::max(m_vertexAllocator.capacity() * 2, minCapacity);
+
+    VertexBuffer grown = VertexBuffer::create(nullptr, newCapacity * sizeof(CompactChunkVertex));
+    grown.copyDataFrom(m_vertexBuffer, m_vertexBuffer.getByteSize());
+    grown.setLayout(m_vertexBuffer.getLayout());
+    m_vertexBuffer = std::move(grown);
+    m_vertexAllocator.grow(newCapacity);
+    m_growCount++;
+
+    rebuildVertexArray();
+    lgr::lout.debug("Chunk arena grew to " + std::to_string(newCapacity) + " vertices");
+}
+
+void ChunkGeometryArena::growIndexStorage(size_t minCapacity) {
+    size_t newCapacity = std::max(m_indexAllocator.capacity() * 2, minCapacity);
+
+    // Creating an index buffer binds it to the current vao, so use the arena's own one
+    m_vao.bind();
+    IndexBuffer grown = IndexBuffer::create(nullptr, newCapacity);
+    grown.copyDataFrom(m_indexBuffer, m_indexBuffer.count());
+    m_indexBuffer = std::move(grown);
+    m_indexAllocator.grow(newCapacity);
+    m_growCount++;
+
+    rebuildVertexArray();
+    lgr::lout.debug("Chunk arena grew to " + std::to_string(newCapacity) + " indices");
+}
+
+void ChunkGeometryArena::growQuadStorage(size_t minCapacity) {
+    size_t newCapacity = std::max(m_quadAllocator.capacity() * 2, minCapacity);
+
+    ShaderStorageBuffer grown = ShaderStorageBuffer::create(nullptr, newCapacity * sizeof(CompactChunkQuad));
+    grown.copyDataFrom(m_quadBuffer, m_quadBuffer.getByteSize());
+    m_quadBuffer = std::move(grown);
+    m_quadAllocator.grow(newCapacity);
+    m_growCount++;
+
+    lgr::lout.debug("Chunk arena grew to " + std::to_string(newCapacity) + " quads");
+}
+
+size_t ChunkGeometryArena::allocateRange(
+    RangeAllocator& allocator, size_t count, void (ChunkGeometryArena::*grow)(size_t)
+) {
+    size_t offset = allocator.allocate(count);
+    if (offset == RangeAllocator::INVALID_OFFSET) {
+        (this->*grow)(allocator.capacity() + count);
+        offset = allocator.allocate(count);
+    }
+    return offset;
+}
+
+ChunkGeometryArena::ChunkGeometryArena()
+    : m_vertexAllocator(INITIAL_VERTEX_CAPACITY),
+      m_indexAllocator(INITIAL_INDEX_CAPACITY),
+      m_quadAllocator(INITIAL_QUAD_CAPACITY),
+      m_streamOffset(0),
+      m_growCount(0) {
+    // Creating an index buffer binds it to the current vao, so make sure no foreign one is altered
+    m_vao = VertexArray::create();
+    m_vao.bind();
+
+    m_vertexBuffer = VertexBuffer::create(nullptr, INITIAL_VERTEX_CAPACITY * sizeof(CompactChunkVertex));
+    VertexBufferLayout vertexLayout;
+    // Compressed data
+    vertexLayout.push(GL_UNSIGNED_INT, 1);
+    vertexLayout.push(GL_UNSIGNED_INT, 1);
+    m_vertexBuffer.setLayout(vertexLayout);
+
+    m_indexBuffer = IndexBuffer::create(nullptr, INITIAL_INDEX_CAPACITY);
+    m_quadBuffer = ShaderStorageBuffer::create(nullptr, INITIAL_QUAD_CAPACITY * sizeof(CompactChunkQuad));
+
+    // Identity mapping, so the per instance attribute yields the baseInstance of each indirect command
+    std::vector<unsigned int> drawIndices(STREAM_DRAW_CAPACITY);
+    std::iota(drawIndices.begin(), drawIndices.end(), 0u);
+    m_drawIndexBuffer = VertexBuffer::create(drawIndices.data(), drawIndices.size() * sizeof(unsigned int));
+    VertexBufferLayout drawIndexLayout;
+    drawIndexLayout.push(GL_UNSIGNED_INT, 1);
+    m_drawIndexBuffer.setLayout(drawIndexLayout);
+
+    m_drawDataBuffer = ShaderStorageBuffer::create(nullptr, STREAM_DRAW_CAPACITY * sizeof(glm::vec4));
+    m_commandBuffer = DrawIndirectBuffer::create(nullptr, STREAM_DRAW_CAPACITY * sizeof(DrawElementsIndirectCommand));
+
+    rebuildVertexArray();
+
+    // Quads have no vertex attributes, only the draw index is sourced per instance
+    m_quadVao = VertexArray::create();
+    m_quadVao.addInstanceBuffer(m_drawIndexBuffer);
+}
+
+ChunkGeometryArena::Allocation ChunkGeometryArena::allocate(ChunkMeshFormat format, size_t dataCount, size_t indexCount) {
+    Allocation allocation;
+    if (dataCount == 0) return allocation;
+
+    allocation.format = format;
+    allocation.dataCount = dataCount;
+
+    if (format == ChunkMeshFormat::Quads) {
+        allocation.dataOffset = allocateRange(m_quadAllocator, dataCount, &ChunkGeometryArena::growQuadStorage);
+        return allocation;
+    }
+
+    allocation.dataOffset = allocateRange(m_vertexAllocator, dataCount, &ChunkGeometryArena::growVertexStorage);
+    if (indexCount > 0) {
+        allocation.indexOffset = allocateRange(m_indexAllocator, indexCount, &ChunkGeometryArena::growIndexStorage);
+        allocation.indexCount = indexCount;
+    }
+    return allocation;
+}
+
+void ChunkGeometryArena::free(const Allocation& allocation) {
+    if (!allocation.isValid()) return;
+
+    if (allocation.format == ChunkMeshFormat::Quads) {
+        m_quadAllocator.free(allocation.dataOffset, allocation.dataCount);
+        return;
+    }
+
+    m_vertexAllocator.free(allocation.dataOffset, allocation.dataCount);
+    if (allocation.indexCount > 0) m_indexAllocator.free(allocation.indexOffset, allocation.indexCount);
+}
+
+void ChunkGeometryArena::upload(const Allocation& allocation, const void* records, const unsigned int* indices) {
+    if (!allocation.isValid()) return;
+
+    if (allocation.format == ChunkMeshFormat::Quads) {
+        m_quadBuffer.updateData(
+            records, allocation.dataCount * sizeof(CompactChunkQuad), allocation.dataOffset * sizeof(CompactChunkQuad)
+        );
+        return;
+    }
+
+    m_vertexBuffer.updateData(
+        records, allocation.dataCount * sizeof(CompactChunkVertex), allocation.dataOffset * sizeof(CompactChunkVertex)
+    );
+
+    if (allocation.indexCount > 0) {
+        // Write through the copy target, binding GL_ELEMENT_ARRAY_BUFFER would alter the currently bound vao
+        GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer.rendererId()));
+        GLCALL(glBufferSubData(
+            GL_COPY_WRITE_BUFFER, allocation.indexOffset * sizeof(unsigned int),
+            allocation.indexCount * sizeof(unsigned int), indices
+        ));
+    }
+}
+
+void ChunkGeometryArena::download(const Allocation& allocation, void* records, unsigned int* indices) const {
+    if (!allocation.isValid()) return;
+
+    if (allocation.format == ChunkMeshFormat::Quads) {
+        m_quadBuffer.readData(
+            records, allocation.dataCount * sizeof(CompactChunkQuad), allocation.dataOffset * sizeof(CompactChunkQuad)
+        );
+        return;
+    }
+
+    m_vertexBuffer.readData(
+        records, allocation.dataCount * sizeof(CompactChunkVertex), allocation.dataOffset * sizeof(CompactChunkVertex)
+    );
+
+    if (allocation.indexCount > 0) {
+        // Read through the copy source, binding GL_ELEMENT_ARRAY_BUFFER would alter the currently bound vao
+        GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer.rendererId()));
+        GLCALL(glGetBufferSubData(
+            GL_COPY_READ_BUFFER, allocation.indexOffset * sizeof(unsigned int),
+            allocation.indexCount * sizeof(unsigned int), indices
+        ));
+    }
+}
+
+void ChunkGeometryArena::beginBatch() {
+    m_batchCommands.clear();
+    m_batchDrawData.clear();
+    m_batchQuadCommands.clear();
+    m_batchQuadDrawData.clear();
+}
+
+void ChunkGeometryArena::addToBatch(const Allocation& allocation, const glm::vec3& chunkPosition) {
+    if (!allocation.isValid()) return;
+
+    if (allocation.format == ChunkMeshFormat::Quads) {
+        m_batchQuadCommands.push_back(
+            {{static_cast<unsigned int>(allocation.dataCount * VERTICES_PER_QUAD), 1,
+              static_cast<unsigned int>(allocation.dataOffset * VERTICES_PER_QUAD), 0},
+             0}
+        );
+        m_batchQuadDrawData.emplace_back(chunkPosition, 0.0f);
+        return;
+    }
+
+    if (allocation.indexCount == 0) return;
+
+    m_batchCommands.push_back(
+        {static_cast<unsigned int>(allocation.indexCount), 1, static_cast<unsigned int>(allocation.indexOffset),
+         static_cast<int>(allocation.dataOffset), 0}
+    );
+    m_batchDrawData.emplace_back(chunkPosition, 0.0f);
+}
+
+size_t ChunkGeometryArena::streamDraws(const void* commands, const glm::vec4* drawData, size_t count) {
+    m_drawDataBuffer.updateData(drawData, count * sizeof(glm::vec4), m_streamOffset * sizeof(glm::vec4));
+    m_commandBuffer.updateData(
+        commands, count * sizeof(DrawElementsIndirectCommand), m_streamOffset * sizeof(DrawElementsIndirectCommand)
+    );
+
+    size_t firstSlot = m_streamOffset;
+    m_streamOffset += count;
+    return firstSlot;
+}
+
+unsigned int ChunkGeometryArena::submitBatch(ChunkMeshFormat format, unsigned int type) {
+    bool quads = format == ChunkMeshFormat::Quads;
+    size_t batchCount = batchSize(format);
+    if (batchCount == 0) return 0;
+
+    if (quads) {
+        m_quadVao.bind();
+    } else {
+        m_vao.bind();
+    }
+
+    unsigned int multiDrawCalls = 0;
+    size_t submitted = 0;
+    while (submitted < batchCount) {
+        // Wrap around, the driver orders our buffer updates after draws still sourcing the old contents
+        if (m_streamOffset >= STREAM_DRAW_CAPACITY) m_streamOffset = 0;
+
+        size_t count = std::min(batchCount - submitted, STREAM_DRAW_CAPACITY - m_streamOffset);
+        for (size_t i = 0; i < count; i++) {
+            unsigned int slot = static_cast<unsigned int>(m_streamOffset + i);
+            if (quads) {
+                m_batchQuadCommands[submitted + i].command.baseInstance = slot;
+            } else {
+                m_batchCommands[submitted + i].baseInstance = slot;
+            }
+        }
+
+        size_t firstSlot;
+        if (quads) {
+            firstSlot = streamDraws(&m_batchQuadCommands[submitted], &m_batchQuadDrawData[submitted], count);
+        } else {
+            firstSlot = streamDraws(&m_batchCommands[submitted], &m_batchDrawData[submitted], count);
+        }
+
+        m_commandBuffer.bind();
+        const void* commandOffset = (const void*)(firstSlot * sizeof(DrawElementsIndirectCommand));
+        if (quads) {
+            GLCALL(glMultiDrawArraysIndirect(
+                GL_TRIANGLES, commandOffset, static_cast<GLsizei>(count), sizeof(StreamedArraysCommand)
+            ));
+        } else {
+            GLCALL(glMultiDrawElementsIndirect(type, GL_UNSIGNED_INT, commandOffset, static_cast<GLsizei>(count), 0));
+        }
+
+        submitted += count;
+        multiDrawCalls++;
+    }
+
+    return multiDrawCalls;
+}
+
+ChunkArenaRenderData::~ChunkArenaRenderData() {
+    if (m_arena) m_arena->free(m_allocation);
+}
+
+void ChunkArenaRenderData::drawAs(unsigned int) const {
+    assert(false && "Chunk arena meshes are only drawn in batches by chunk materials");
+}
@@ -0,0 +1,200 @@
+#ifndef TOOMANYBLOCKS_CHUNKGEOMETRYARENA_H
+#define TOOMANYBLOCKS_CHUNKGEOMETRYARENA_H
+
+#include <stddef.h>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <vector>
+
+#include "engine/rendering/RenderData.h"
+#include "engine/rendering/Vertices.h"
+#include "engine/rendering/lowlevelapi/DrawIndirectBuffer.h"
+#include "engine/rendering/lowlevelapi/IndexBuffer.h"
+#include "engine/rendering/lowlevelapi/ShaderStorageBuffer.h"
+#include "engine/rendering/lowlevelapi/VertexArray.h"
+#include "engine/rendering/lowlevelapi/VertexBuffer.h"
+#include "foundation/util/RangeAllocator.h"
+
+/**
+ * @brief Shared geometry storage for all chunk meshes.
+ *
+ * Vertex format meshes are sub-allocated from one vertex and one index buffer, so all chunks share a single
+ * VAO. Quad format meshes are sub-allocated from an SSBO holding one record per quad, which the vertex shader
+ * expands into two triangles using gl_VertexID, so no vertex or index data is stored for them at all.
+ *
+ * Visible chunks are collected into a batch and submitted with one multi draw indirect call per format. Per
+ * draw data (the chunk position) is streamed into an SSBO that shaders index with the per instance `drawIndex`
+ * attribute, which is sourced from the command's baseInstance.
+ *
+ * All methods must be called on the main thread.
+ */
+class ChunkGeometryArena {
+public:
+    struct Allocation {
+        ChunkMeshFormat format = ChunkMeshFormat::Vertices;
+        size_t dataOffset = RangeAllocator::INVALID_OFFSET;  // In vertices or quads, depending on the format
+        size_t dataCount = 0;
+        size_t indexOffset = RangeAllocator::INVALID_OFFSET;
+        size_t indexCount = 0;
+
+        inline bool isValid() const { return dataOffset != RangeAllocator::INVALID_OFFSET; }
+    };
+
+private:
+    // Arrays commands are streamed into the same slots as element commands, so pad them to the same stride
+    struct StreamedArraysCommand {
+        DrawArraysIndirectCommand command;
+        unsigned int padding;
+    };
+    static_assert(sizeof(StreamedArraysCommand) == sizeof(DrawElementsIndirectCommand), "Command slots must match");
+
+    VertexArray m_vao;
+    VertexArray m_quadVao;
+    VertexBuffer m_vertexBuffer;
+    IndexBuffer m_indexBuffer;
+    ShaderStorageBuffer m_quadBuffer;
+    VertexBuffer m_drawIndexBuffer;
+    ShaderStorageBuffer m_drawDataBuffer;
+    DrawIndirectBuffer m_commandBuffer;
+
+    RangeAllocator m_vertexAllocator;
+    RangeAllocator m_indexAllocator;
+    RangeAllocator m_quadAllocator;
+
+    std::vector<DrawElementsIndirectCommand> m_batchCommands;
+    std::vector<glm::vec4> m_batchDrawData;
+    std::vector<StreamedArraysCommand> m_batchQuadCommands;
+    std::vector<glm::vec4> m_batchQuadDrawData;
+    size_t m_streamOffset;
+
+    unsigned int m_growCount;
+
+    void rebuildVertexArray();
+
+    void growVertexStorage(size_t minCapacity);
+
+    void growIndexStorage(size_t minCapacity);
+
+    void growQuadStorage(size_t minCapacity);
+
+    size_t allocateRange(RangeAllocator& allocator, size_t count, void (ChunkGeometryArena::*grow)(size_t));
+
+    /**
+     * @brief Streams draw data and commands into the next free slots, wrapping around if necessary.
+     *
+     * @return Slot of the first streamed command.
+     */
+    size_t streamDraws(const void* commands, const glm::vec4* drawData, size_t count);
+
+public:
+    ChunkGeometryArena();
+
+    /**
+     * @brief Reserves storage for a mesh, growing the shared buffers if necessary.
+     *
+     * Growing copies the existing contents on the gpu, so previously returned allocations stay valid.
+     *
+     * @param format Format of the mesh.
+     * @param dataCount Number of vertices or quads to reserve.
+     * @param indexCount Number of indices to reserve, always zero for quad meshes.
+     * @return The allocation, which is invalid if dataCount is zero.
+     */
+    Allocation allocate(ChunkMeshFormat format, size_t dataCount, size_t indexCount);
+
+    /**
+     * @brief Returns the storage of an allocation to the arena.
+     */
+    void free(const Allocation& allocation);
+
+    /**
+     * @brief Uploads the records and indices of an allocation directly from cpu memory.
+     */
+    void upload(const Allocation& allocation, const void* records, const unsigned int* indices);
+
+    /**
+     * @brief Reads the records and indices of an allocation back into cpu memory, waiting for pending gpu writes.
+     */
+    void download(const Allocation& allocation, void* records, unsigned int* indices) const;
+
+    /** @return Renderer id of the shared buffer holding records of the given format, e.g. for staged copies. */
+    inline unsigned int dataBufferId(ChunkMeshFormat format) const {
+        return format == ChunkMeshFormat::Quads ? m_quadBuffer.rendererId() : m_vertexBuffer.rendererId();
+    }
+
+    /** @return Renderer id of the shared index buffer, e.g. as target for staged copies. */
+    inline unsigned int indexBufferId() const { return m_indexBuffer.rendererId(); }
+
+    /** @return The SSBO holding the per draw data indexed by `drawIndex`. */
+    inline const ShaderStorageBuffer& getDrawDataBuffer() const { return m_drawDataBuffer; }
+
+    /** @return The SSBO holding the records of all quad format meshes. */
+    inline const ShaderStorageBuffer& getQuadBuffer() const { return m_quadBuffer; }
+
+    /**
+     * @brief Discards all draws collected for the current batch.
+     */
+    void beginBatch();
+
+    /**
+     * @brief Adds a draw of an allocation to the current batch.
+     *
+     * @param allocation The mesh to draw. Invalid allocations are skipped.
+     * @param chunkPosition World position of the chunk origin.
+     */
+    void addToBatch(const Allocation& allocation, const glm::vec3& chunkPosition);
+
+    /**
+     * @brief Draws all collected draws of one format with as few multi draw calls as possible.
+     *
+     * Quad format draws always render triangles, the quads are expanded by the vertex shader.
+     *
+     * @param format Which of the collected draws to submit.
+     * @param type OpenGL primitive type.
+     * @return Number of issued multi draw calls.
+     */
+    unsigned int submitBatch(ChunkMeshFormat format, unsigned int type);
+
+    /** @return Number of draws of the given format in the current batch. */
+    inline size_t batchSize(ChunkMeshFormat format) const {
+        return format == ChunkMeshFormat::Quads ? m_batchQuadCommands.size() : m_batchCommands.size();
+    }
+
+    inline size_t vertexCapacity() const { return m_vertexAllocator.capacity(); }
+
+    inline size_t verticesInUse() const { return m_vertexAllocator.used(); }
+
+    inline size_t freeVertexRanges() const { return m_vertexAllocator.freeRangeCount(); }
+
+    inline size_t quadCapacity() const { return m_quadAllocator.capacity(); }
+
+    inline size_t quadsInUse() const { return m_quadAllocator.used(); }
+
+    inline unsigned int growCount() const { return m_growCount; }
+};
+
+/**
+ * @brief Render data of a single chunk mesh living in the chunk geometry arena.
+ *
+ * Frees its arena storage on destruction. It cannot be drawn on its own since the chunk position is only known to
+ * the render proxy, chunk materials draw all arena meshes in batches instead.
+ */
+class ChunkArenaRenderData : public RenderData {
+private:
+    std::shared_ptr<ChunkGeometryArena> m_arena;
+    ChunkGeometryArena::Allocation m_allocation;
+
+public:
+    ChunkArenaRenderData(std::shared_ptr<ChunkGeometryArena> arena, const ChunkGeometryArena::Allocation& allocation)
+        : m_arena(std::move(arena)), m_allocation(allocation) {}
+    virtual ~ChunkArenaRenderData();
+
+    virtual void drawAs(unsigned int type) const override;
+
+    inline const ChunkGeometryArena::Allocation& getAllocation() const { return m_allocation; }
+
+    inline const ChunkGeometryArena& getArena() const { return *m_arena; }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "FrameConstantRing.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "Logger.h"
+#include "engine/rendering/GLUtils.h"
+
+// Upper bound for waiting on a region fence, the GPU is at most FRAMES_IN_FLIGHT frames behind
+static constexpr GLuint64 REGION_FENCE_TIMEOUT_NS = 1000000000;
+
+static inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+FrameConstantRing::FrameConstantRing()
+    : m_regionFences{},
+      m_regionSize(0),
+      m_alignment(256),
+      m_region(0),
+      m_regionHead(0),
+      m_wantedHead(0),
+      m_requiredRegionSize(0),
+      m_allocations(0),
+      m_failedAllocations(0),
+      m_fenceWaits(0),
+      m_lastAllocatedBytes(0),
+      m_lastAllocations(0),
+      m_lastFailedAllocations(0),
+      m_lastFenceWaits(0) {}
+
+FrameConstantRing::~FrameConstantRing() {
+    for (GLsync fence : m_regionFences) {
+        if (fence) glDeleteSync(fence);
+    }
+}
+
+void FrameConstantRing::createBuffer(size_t regionSize) {
+    m_regionSize = alignUp(regionSize, m_alignment);
+    size_t capacity = m_regionSize * FRAMES_IN_FLIGHT;
+
+    if (StagingBuffer::isSupported()) {
+        m_mappedBuffer = StagingBuffer::create(capacity);
+    } else {
+        m_fallbackBuffer = UniformBuffer::create(nullptr, capacity);
+    }
+}
+
+void FrameConstantRing::waitForRegion(int region) {
+    GLsync& fence = m_regionFences[region];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        m_fenceWaits++;
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, REGION_FENCE_TIMEOUT_NS);
+    }
+    if (result == GL_WAIT_FAILED) {
+        lgr::lout.error("Waiting for frame constant region failed");
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FrameConstantRing::init(size_t regionSize) {
+    int alignment = 0;
+    GLCALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    m_alignment = std::max<size_t>(static_cast<size_t>(alignment), 16);
+
+    createBuffer(regionSize);
+    if (!m_mappedBuffer.isValid()) {
+        lgr::lout.warn("Persistent buffer mapping unsupported, frame constants are written with buffer updates");
+    }
+}
+
+void FrameConstantRing::beginFrame() {
+    if (m_requiredRegionSize > m_regionSize) {
+        // Every region may still be read, so the old buffer can only be replaced once all frames finished
+        for (int region = 0; region < FRAMES_IN_FLIGHT; region++) {
+            waitForRegion(region);
+        }
+        createBuffer(std::max(m_regionSize * 2, m_requiredRegionSize));
+        lgr::lout.debug("Frame constant ring grew to " + std::to_string(m_regionSize) + " bytes per frame");
+    }
+
+    m_region = (m_region + 1) % FRAMES_IN_FLIGHT;
+    waitForRegion(m_region);
+    m_regionHead = 0;
+    m_wantedHead = 0;
+    m_requiredRegionSize = 0;
+}
+
+UniformBufferRange FrameConstantRing::allocate(const void* data, size_t size, size_t rangeSize) {
+    UniformBufferRange range;
+    size_t alignedSize = alignUp(size, m_alignment);
+    rangeSize = std::max(rangeSize, size);
+
+    // The bound range has to lie inside the region as well, the head only advances past the constants
+    m_requiredRegionSize = std::max(m_requiredRegionSize, m_wantedHead + std::max(alignedSize, rangeSize));
+    m_wantedHead += alignedSize;
+    if (size == 0 || m_regionHead + std::max(alignedSize, rangeSize) > m_regionSize) {
+        m_failedAllocations++;
+        return range;
+    }
+
+    size_t offset = m_region * m_regionSize + m_regionHead;
+    if (m_mappedBuffer.isValid()) {
+        std::memcpy(m_mappedBuffer.mappedData() + offset, data, size);
+    } else {
+        m_fallbackBuffer.updateData(data, size, offset);
+    }
+    m_regionHead += alignedSize;
+    m_allocations++;
+
+    range.bufferId = bufferId();
+    range.offset = offset;
+    range.size = rangeSize;
+    return range;
+}
+
+void FrameConstantRing::endFrame() {
+    if (m_regionHead > 0) {
+        GLCALL(m_regionFences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+
+    m_lastAllocatedBytes = static_cast<int>(m_regionHead);
+    m_lastAllocations = m_allocations;
+    m_lastFailedAllocations = m_failedAllocations;
+    m_lastFenceWaits = m_fenceWaits;
+    m_allocations = 0;
+    m_failedAllocations = 0;
+    m_fenceWaits = 0;
+}
+
+void FrameConstantRing::fillDebugReport(DebugReport& report) const {
+    report.beginGroup("Frame Constants");
+    report.addCounter("Persistently mapped", m_mappedBuffer.isValid() ? 1 : 0);
+    report.addCounter("Region size", static_cast<int>(m_regionSize));
+    report.addCounter("Allocated bytes", m_lastAllocatedBytes);
+    report.addCounter("Allocations", m_lastAllocations);
+    report.addCounter("Failed allocations", m_lastFailedAllocations);
+    report.addCounter("Fence waits", m_lastFenceWaits);
+    report.endGroup();
+}
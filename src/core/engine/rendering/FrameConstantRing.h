@@ -0,0 +1,89 @@
+#ifndef TOOMANYBLOCKS_FRAMECONSTANTRING_H
+#define TOOMANYBLOCKS_FRAMECONSTANTRING_H
+
+#include <stddef.h>
+
+#include "compatability/Compatability.h"
+#include "engine/rendering/lowlevelapi/StagingBuffer.h"
+#include "engine/rendering/lowlevelapi/UniformBuffer.h"
+#include "engine/rendering/renderpasses/DebugReport.h"
+
+/**
+ * @brief Streams per draw constants (transforms, joint matrices) into uniform block ranges.
+ *
+ * The ring is split into one region per frame in flight. Each frame writes its constants linearly into its own
+ * region and fences it on endFrame(), so a region is only rewritten once the GPU finished the frame that used it
+ * and writes never stall on buffers still in use. Draws bind their constants by offset instead of updating a
+ * shared buffer. The ring is persistently mapped if supported, otherwise constants are written with buffer sub
+ * data updates into the same layout.
+ *
+ * All methods must be called on the main thread.
+ */
+class FrameConstantRing {
+private:
+    static constexpr int FRAMES_IN_FLIGHT = 3;
+
+    StagingBuffer m_mappedBuffer;
+    UniformBuffer m_fallbackBuffer;
+    GLsync m_regionFences[FRAMES_IN_FLIGHT];
+
+    size_t m_regionSize;
+    size_t m_alignment;
+    int m_region;
+    size_t m_regionHead;
+    size_t m_wantedHead;          // Head of the region if no allocation of this frame had failed
+    size_t m_requiredRegionSize;  // Largest amount of constants a frame wanted to write, with ranges bound past them
+
+    int m_allocations;
+    int m_failedAllocations;
+    int m_fenceWaits;
+    int m_lastAllocatedBytes;
+    int m_lastAllocations;
+    int m_lastFailedAllocations;
+    int m_lastFenceWaits;
+
+    void createBuffer(size_t regionSize);
+
+    void waitForRegion(int region);
+
+    inline unsigned int bufferId() const {
+        return m_mappedBuffer.isValid() ? m_mappedBuffer.rendererId() : m_fallbackBuffer.rendererId();
+    }
+
+public:
+    FrameConstantRing();
+    ~FrameConstantRing();
+
+    /**
+     * @brief Creates the ring buffer. Must be called with a current OpenGL context.
+     *
+     * @param regionSize Bytes available per frame, the ring grows if a frame needs more.
+     */
+    void init(size_t regionSize);
+
+    /**
+     * @brief Switches to the next region, waiting until the GPU finished the frame that last used it.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Copies constants into the current region.
+     *
+     * @param data Constants laid out as the std140 uniform block expects them.
+     * @param size Size of the constants in bytes.
+     * @param rangeSize Size of the returned range if larger than the constants, for blocks with arrays that are
+     *                  only partially streamed. Only the constants are reserved, the rest of the range overlaps
+     *                  later allocations and must not be read by the shader.
+     * @return The range to bind, invalid if the region is full. The ring grows on the next frame then.
+     */
+    UniformBufferRange allocate(const void* data, size_t size, size_t rangeSize = 0);
+
+    /**
+     * @brief Fences all draws reading from the current region.
+     */
+    void endFrame();
+
+    void fillDebugReport(DebugReport& report) const;
+};
+
+#endif
@@ -2,7 +2,12 @@
 
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
 #include "engine/geometry/BoundingVolume.h"
+#include "engine/rendering/RenderScene.h"
 
 enum Planes {
     Near,
@@ -74,6 +79,29 @@ bool Frustum::isBoxInside(const glm::vec3& min, const glm::vec3& max) const {
     return true;  // Box is inside or intersects the frustum
 }
 
+FrustumTest Frustum::classifyBox(const glm::vec3& min, const glm::vec3& max) const {
+    FrustumTest result = FrustumTest::Inside;
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4& plane = planes[i];
+
+        glm::vec3 positiveCorner = glm::vec3(
+            (plane.x > 0) ? max.x : min.x, (plane.y > 0) ? max.y : min.y, (plane.z > 0) ? max.z : min.z
+        );
+        if (glm::dot(glm::vec3(plane), positiveCorner) + plane.w < 0) {
+            return FrustumTest::Outside;
+        }
+
+        // If even the corner furthest behind the plane is in front of it, the box is fully on the inner side
+        glm::vec3 negativeCorner = glm::vec3(
+            (plane.x > 0) ? min.x : max.x, (plane.y > 0) ? min.y : max.y, (plane.z > 0) ? min.z : max.z
+        );
+        if (glm::dot(glm::vec3(plane), negativeCorner) + plane.w < 0) {
+            result = FrustumTest::Intersecting;
+        }
+    }
+    return result;
+}
+
 bool Frustum::isSphereInside(const glm::vec3& center, float radius) const {
     for (int i = 0; i < 6; i++) {
         if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) {
@@ -83,21 +111,90 @@ bool Frustum::isSphereInside(const glm::vec3& center, float radius) const {
     return true;
 }
 
-void cullObjectsOutOfView(
-    const std::vector<Renderable*>& meshes,
-    std::vector<Renderable*>& outputBuffer,
-    const glm::mat4& viewProj
-) {
-    const Frustum frustum(viewProj);
+void RenderableBoundsArray::clear() {
+    m_minX.clear();
+    m_minY.clear();
+    m_minZ.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_maxZ.clear();
+    m_proxies.clear();
+}
 
+size_t RenderableBoundsArray::push(const RenderProxy* proxy) {
+    m_minX.push_back(0.0f);
+    m_minY.push_back(0.0f);
+    m_minZ.push_back(0.0f);
+    m_maxX.push_back(0.0f);
+    m_maxY.push_back(0.0f);
+    m_maxZ.push_back(0.0f);
+    m_proxies.push_back(proxy);
+    update(m_proxies.size() - 1, proxy->worldBounds);
+    return m_proxies.size() - 1;
+}
+
+void RenderableBoundsArray::update(size_t index, const BoundingBox& worldBounds) {
+    m_minX[index] = worldBounds.min.x;
+    m_minY[index] = worldBounds.min.y;
+    m_minZ[index] = worldBounds.min.z;
+    m_maxX[index] = worldBounds.max.x;
+    m_maxY[index] = worldBounds.max.y;
+    m_maxZ[index] = worldBounds.max.z;
+}
+
+void cullBounds(
+    const Frustum& frustum,
+    const RenderableBoundsArray& bounds,
+    std::vector<const RenderProxy*>& outputBuffer
+) {
     outputBuffer.clear();
-    for (Renderable* mesh : meshes) {
-        const BoundingBox bounds = mesh->getBoundingBox();
-        if (!bounds.isInvalid() || bounds.isNotCullable()) {
-            glm::vec3 pos = mesh->getGlobalTransform().getPosition();
-            if (frustum.isBoxInside(bounds.min + pos, bounds.max + pos)) {
-                outputBuffer.push_back(mesh);
-            }
+
+    // The positive corner only depends on the plane's normal signs, so pick its arrays once per plane
+    const float* cornerX[6];
+    const float* cornerY[6];
+    const float* cornerZ[6];
+    for (int p = 0; p < 6; p++) {
+        const glm::vec4& plane = frustum.getPlane(p);
+        cornerX[p] = plane.x > 0 ? bounds.m_maxX.data() : bounds.m_minX.data();
+        cornerY[p] = plane.y > 0 ? bounds.m_maxY.data() : bounds.m_minY.data();
+        cornerZ[p] = plane.z > 0 ? bounds.m_maxZ.data() : bounds.m_minZ.data();
+    }
+
+    size_t count = bounds.size();
+    size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            const glm::vec4& plane = frustum.getPlane(p);
+            __m128 dist = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_loadu_ps(cornerX[p] + i), _mm_set1_ps(plane.x)),
+                    _mm_mul_ps(_mm_loadu_ps(cornerY[p] + i), _mm_set1_ps(plane.y))
+                ),
+                _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(cornerZ[p] + i), _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w))
+            );
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, zero));
+        }
+
+        int outsideMask = _mm_movemask_ps(outside);
+        if (outsideMask == 0xF) continue;
+
+        for (int lane = 0; lane < 4; lane++) {
+            if (!(outsideMask & (1 << lane))) outputBuffer.push_back(bounds.m_proxies[i + lane]);
         }
     }
-}
\ No newline at end of file
+#endif
+
+    // Remaining boxes (or all of them without SSE2)
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            const glm::vec4& plane = frustum.getPlane(p);
+            inside = cornerX[p][i] * plane.x + cornerY[p][i] * plane.y + cornerZ[p][i] * plane.z + plane.w >= 0;
+        }
+        if (inside) outputBuffer.push_back(bounds.m_proxies[i]);
+    }
+}
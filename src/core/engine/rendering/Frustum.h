@@ -4,7 +4,15 @@
 #include <glm/glm.hpp>
 #include <vector>
 
-#include "engine/rendering/Renderable.h"
+#include "engine/geometry/BoundingVolume.h"
+
+struct RenderProxy;
+
+enum class FrustumTest {
+    Outside,
+    Intersecting,
+    Inside
+};
 
 class Frustum {
 private:
@@ -15,13 +23,56 @@ public:
 
     bool isBoxInside(const glm::vec3& min, const glm::vec3& max) const;
 
+    /**
+     * @brief Like isBoxInside(), but additionally tells if the box lies completely inside the frustum.
+     */
+    FrustumTest classifyBox(const glm::vec3& min, const glm::vec3& max) const;
+
     bool isSphereInside(const glm::vec3& center, float radius) const;
+
+    inline const glm::vec4& getPlane(int index) const { return planes[index]; }
+};
+
+/**
+ * @brief World space bounds of render proxies, stored as structure of arrays so they can be culled 4 at a time.
+ *
+ * Kept by the render scene across frames, moving a proxy only rewrites its slot. Frustum queries read the cached
+ * bounds instead of calling the virtual getBoundingBox() and the recursive getGlobalTransform() of renderables.
+ */
+class RenderableBoundsArray {
+private:
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+    std::vector<const RenderProxy*> m_proxies;
+
+    friend void cullBounds(const Frustum&, const RenderableBoundsArray&, std::vector<const RenderProxy*>&);
+
+public:
+    void clear();
+
+    /**
+     * @brief Appends the world bounds of the proxy, they have to be valid.
+     *
+     * @return Index of the bounds in the array.
+     */
+    size_t push(const RenderProxy* proxy);
+
+    void update(size_t index, const BoundingBox& worldBounds);
+
+    inline size_t size() const { return m_proxies.size(); }
 };
 
-void cullObjectsOutOfView(
-    const std::vector<Renderable*>& meshes,
-    std::vector<Renderable*>& outputBuffer,
-    const glm::mat4& viewProj
+/**
+ * @brief Collects all proxies whose bounds intersect the frustum. Vectorized with SSE2 where available.
+ *
+ * @param frustum Frustum to test against.
+ * @param bounds Bounds of all candidates.
+ * @param outputBuffer Cleared and filled with the visible proxies, in the order of the bounds array.
+ */
+void cullBounds(
+    const Frustum& frustum,
+    const RenderableBoundsArray& bounds,
+    std::vector<const RenderProxy*>& outputBuffer
 );
 
 #endif
\ No newline at end of file
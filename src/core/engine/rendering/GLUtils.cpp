@@ -85,6 +85,22 @@ bool GLLogCall(const char* functionName, const char* file, int line) {
     return errorCount == 0;
 }
 
+bool GLCheckErrors(const char* scope) {
+    int errorCount = 0;
+    GLenum error;
+    while ((error = glGetError()) != GL_NO_ERROR) {
+        std::ostringstream stream;
+        stream << "[OpenGL Error " << toGLErrorString(error) << " 0x" << std::hex << error << "] during " << scope;
+        lgr::lout.error(stream.str());
+
+        if (++errorCount >= maxErrorChecks) {
+            lgr::lout.error("GLCheckErrors() reached maximum error checks. Possible infinite error generation.");
+            break;
+        }
+    }
+    return errorCount == 0;
+}
+
 void GLEnableDebugging() {
     int flags;
     GLCALL(glGetIntegerv(GL_CONTEXT_FLAGS, &flags));
@@ -101,6 +117,23 @@ void GLEnableDebugging() {
     }
 }
 
+void GLEnableErrorOutput() {
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+        lgr::lout.warn("OpenGL debug output not supported, errors are only checked once per render pass");
+        return;
+    }
+
+    GLCALL(glEnable(GL_DEBUG_OUTPUT));
+    // Asynchronous, so the driver does not have to serialize every call with the callback
+    GLCALL(glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS));
+    GLCALL(glDebugMessageCallback(OpenGLDebugCallback, nullptr));
+    GLCALL(glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE));
+    GLCALL(glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE));
+    GLCALL(glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR, GL_DONT_CARE, 0, nullptr, GL_TRUE));
+
+    lgr::lout.info("OpenGL error output enabled");
+}
+
 void GLDisableDebugging() {
     GLCALL(glDisable(GL_DEBUG_OUTPUT));
     lgr::lout.info("OpenGL debugging disabled");
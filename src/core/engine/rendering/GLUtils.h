@@ -5,15 +5,25 @@
 
 #include <stdexcept>
 
+#ifdef GL_PER_CALL_ERROR_CHECKS
 #define GLCALL(func) GLClearError(); func; if (!GLLogCall(#func, __FILE__, __LINE__)) throw std::runtime_error("Something went wrong in open gl")
-// #define GLCALL(func) func
+#else
+// Querying errors after every call round trips to the driver, errors are reported by debug output and GLCheckErrors()
+#define GLCALL(func) func
+#endif
 
 void GLClearError();
 
 bool GLLogCall(const char* functionName, const char* file, int line);
 
+// Drains all pending errors once, e.g. after a render pass. Returns false if any error was logged.
+bool GLCheckErrors(const char* scope);
+
 void GLEnableDebugging();
 
+// Reports errors through an asynchronous debug output callback, also works without a debug context on most drivers
+void GLEnableErrorOutput();
+
 void GLDisableDebugging();
 
 size_t GLsizeof(unsigned int type);
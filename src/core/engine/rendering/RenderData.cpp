@@ -2,15 +2,37 @@
 
 #include <GL/glew.h>
 
+#include <atomic>
+#include <stdexcept>
+
 #include "engine/rendering/GLUtils.h"
 
+static std::atomic<uint64_t> nextRenderDataUid{1};
+
+RenderData::RenderData() : m_uid(nextRenderDataUid.fetch_add(1, std::memory_order_relaxed)) {}
+
+void RenderData::drawInstancedAs(unsigned int type, unsigned int instanceCount) const {
+    throw std::runtime_error("Render data does not support instanced draws");
+}
+
 void NonIndexedRenderData::drawAs(unsigned int type) const {
     m_vao.bind();
     GLCALL(glDrawArrays(type, 0, m_vbo.getVertexCount()));
 }
 
+void NonIndexedRenderData::drawInstancedAs(unsigned int type, unsigned int instanceCount) const {
+    m_vao.bind();
+    GLCALL(glDrawArraysInstanced(type, 0, m_vbo.getVertexCount(), instanceCount));
+}
+
 void IndexedRenderData::drawAs(unsigned int type) const {
     m_vao.bind();
     m_ibo.bind();
     GLCALL(glDrawElements(type, m_ibo.count(), GL_UNSIGNED_INT, nullptr));
+}
+
+void IndexedRenderData::drawInstancedAs(unsigned int type, unsigned int instanceCount) const {
+    m_vao.bind();
+    m_ibo.bind();
+    GLCALL(glDrawElementsInstanced(type, m_ibo.count(), GL_UNSIGNED_INT, nullptr, instanceCount));
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef TOOMANYBLOCKS_RENDERDATA_H
 #define TOOMANYBLOCKS_RENDERDATA_H
 
+#include <cstdint>
 #include <vector>
 
 #include "engine/geometry/BoundingVolume.h"
@@ -9,10 +10,20 @@
 #include "engine/rendering/lowlevelapi/VertexBuffer.h"
 
 class RenderData {
+private:
+    uint64_t m_uid;
+
 public:
+    RenderData();
     virtual ~RenderData() = default;
 
+    // Unique for the lifetime of the program, unlike the address which may be reused by later render data
+    inline uint64_t uid() const { return m_uid; }
+
     virtual void drawAs(unsigned int type) const = 0;
+
+    // Draws the data instanceCount times, shaders tell the instances apart by gl_InstanceID
+    virtual void drawInstancedAs(unsigned int type, unsigned int instanceCount) const;
 };
 
 class NonIndexedRenderData : public RenderData {
@@ -25,6 +36,8 @@ public:
     virtual ~NonIndexedRenderData() = default;
 
     virtual void drawAs(unsigned int type) const override;
+
+    virtual void drawInstancedAs(unsigned int type, unsigned int instanceCount) const override;
 };
 
 class IndexedRenderData : public NonIndexedRenderData {
@@ -37,6 +50,8 @@ public:
     virtual ~IndexedRenderData() = default;
 
     virtual void drawAs(unsigned int type) const override;
+
+    virtual void drawInstancedAs(unsigned int type, unsigned int instanceCount) const override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "engine/rendering/Renderer.h"
+
+// Pooled textures idle for this many frames are deleted
+static constexpr uint64_t POOL_RETENTION_FRAMES = 120;
+
+// Estimated from the internal formats, drivers may pad three channel formats
+static size_t bytesPerTexel(TextureType type, int channels) {
+    switch (type) {
+        case TextureType::Color:
+        case TextureType::UInt8:
+        case TextureType::Int8: return channels;
+        case TextureType::Float16:
+        case TextureType::UInt16:
+        case TextureType::Int16: return 2 * channels;
+        case TextureType::Depth: return 4;
+        default: return 4 * channels;
+    }
+}
+
+static glm::uvec2 textureSize(TransientTextureSize size, glm::uvec2 screenRes) {
+    if (size == TransientTextureSize::HalfScreen) return glm::max(screenRes / 2u, glm::uvec2(2));
+    return glm::max(screenRes, glm::uvec2(1));
+}
+
+static size_t textureBytes(const TransientTextureDesc& desc, glm::uvec2 size) {
+    return static_cast<size_t>(size.x) * size.y * bytesPerTexel(desc.type, desc.channels);
+}
+
+RenderGraphResource RenderGraphBuilder::createTexture(const char* name, const TransientTextureDesc& desc) {
+    return m_graph.declareWrite(m_pass, name, true, false, desc);
+}
+
+RenderGraphResource RenderGraphBuilder::writeExternal(const char* name) {
+    return m_graph.declareWrite(m_pass, name, false, false, {TextureType::Color, 0});
+}
+
+RenderGraphResource RenderGraphBuilder::writeOutput(const char* name) {
+    return m_graph.declareWrite(m_pass, name, false, true, {TextureType::Color, 0});
+}
+
+RenderGraphResource RenderGraphBuilder::read(const char* name, bool optional) {
+    return m_graph.declareRead(m_pass, name, optional);
+}
+
+RenderGraphResource RenderGraph::findResource(const char* name) const {
+    for (size_t i = 0; i < m_resources.size(); i++) {
+        if (std::strcmp(m_resources[i].name, name) == 0) return static_cast<RenderGraphResource>(i);
+    }
+    return -1;
+}
+
+RenderGraphResource RenderGraph::declareWrite(
+    int pass, const char* name, bool transient, bool output, const TransientTextureDesc& desc
+) {
+    if (findResource(name) >= 0) {
+        throw std::runtime_error("Render graph resource " + std::string(name) + " is written by more than one pass");
+    }
+
+    m_resources.push_back({name, pass, transient, output, desc});
+    RenderGraphResource resource = static_cast<RenderGraphResource>(m_resources.size() - 1);
+    m_passes[pass].writes.push_back(resource);
+    return resource;
+}
+
+RenderGraphResource RenderGraph::declareRead(int pass, const char* name, bool optional) {
+    RenderGraphResource resource = findResource(name);
+    if (resource < 0) {
+        throw std::runtime_error("Render graph resource " + std::string(name) + " is read before it is written");
+    }
+
+    m_passes[pass].reads.push_back({resource, optional});
+    return resource;
+}
+
+void RenderGraph::addPass(std::unique_ptr<Renderpass> pass) {
+    m_passes.push_back({std::move(pass)});
+    RenderGraphBuilder builder(*this, static_cast<int>(m_passes.size() - 1));
+    m_passes.back().pass->declareResources(builder);
+}
+
+int RenderGraph::acquireTexture(const TransientTextureDesc& desc, glm::uvec2 screenRes) {
+    glm::uvec2 size = textureSize(desc.size, screenRes);
+    for (size_t i = 0; i < m_pool.size(); i++) {
+        PooledTexture& pooled = m_pool[i];
+        if (pooled.inUse || !(pooled.desc == desc) || pooled.size != size) continue;
+
+        // Memory already used by an earlier resource of this frame
+        if (pooled.lastUsedFrame == m_frame) m_lastAliasedTextures++;
+        pooled.inUse = true;
+        pooled.lastUsedFrame = m_frame;
+        return static_cast<int>(i);
+    }
+
+    std::shared_ptr<Texture> texture = std::make_shared<Texture>(
+        Texture::create(desc.type, size.x, size.y, desc.channels, nullptr, desc.filterMode, desc.wrapMode)
+    );
+    m_pool.push_back({desc, size, std::move(texture), m_frame, true});
+    return static_cast<int>(m_pool.size() - 1);
+}
+
+void RenderGraph::trimPool(glm::uvec2 screenRes) {
+    m_pool.erase(
+        std::remove_if(
+            m_pool.begin(), m_pool.end(),
+            [&](const PooledTexture& pooled) {
+                return pooled.size != textureSize(pooled.desc.size, screenRes) ||
+                       pooled.lastUsedFrame + POOL_RETENTION_FRAMES < m_frame;
+            }
+        ),
+        m_pool.end()
+    );
+
+    m_pooledBytes = 0;
+    for (const PooledTexture& pooled : m_pool) {
+        m_pooledBytes += textureBytes(pooled.desc, pooled.size);
+    }
+}
+
+void RenderGraph::execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
+    m_frame++;
+
+    // Passes without work are culled, as are passes missing a required input
+    for (PassNode& node : m_passes) {
+        node.active = node.pass->collectWork(context, resources);
+        for (const PassRead& read : node.reads) {
+            if (!read.optional && !m_passes[m_resources[read.resource].writer].active) node.active = false;
+        }
+    }
+
+    // Walking backwards, a pass is only kept if a kept pass consumes one of its outputs
+    for (ResourceNode& resource : m_resources) {
+        resource.consumed = resource.output;
+        resource.lastUse = -1;
+        resource.pooledTexture = -1;
+    }
+    for (int i = static_cast<int>(m_passes.size()) - 1; i >= 0; i--) {
+        PassNode& node = m_passes[i];
+        if (!node.active) continue;
+
+        node.active = std::any_of(node.writes.begin(), node.writes.end(), [&](RenderGraphResource resource) {
+            return m_resources[resource].consumed;
+        });
+        if (!node.active) continue;
+
+        for (const PassRead& read : node.reads) {
+            m_resources[read.resource].consumed = true;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+        const PassNode& node = m_passes[i];
+        if (!node.active) continue;
+
+        for (RenderGraphResource resource : node.writes) {
+            m_resources[resource].lastUse = i;
+        }
+        for (const PassRead& read : node.reads) {
+            ResourceNode& resource = m_resources[read.resource];
+            if (m_passes[resource.writer].active) resource.lastUse = i;
+        }
+    }
+
+    m_lastCulledPasses = 0;
+    m_lastTransientTextures = 0;
+    m_lastAliasedTextures = 0;
+    m_lastPeakTransientBytes = 0;
+    size_t liveBytes = 0;
+    for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+        PassNode& node = m_passes[i];
+        if (!node.active) {
+            node.pass->skip(context);
+            m_lastCulledPasses++;
+            continue;
+        }
+
+        for (RenderGraphResource resourceIndex : node.writes) {
+            ResourceNode& resource = m_resources[resourceIndex];
+            if (!resource.transient) continue;
+
+            resource.pooledTexture = acquireTexture(resource.desc, context.currScreenRes);
+            const PooledTexture& pooled = m_pool[resource.pooledTexture];
+            liveBytes += textureBytes(pooled.desc, pooled.size);
+            m_lastTransientTextures++;
+        }
+        m_lastPeakTransientBytes = std::max(m_lastPeakTransientBytes, liveBytes);
+
+        node.pass->run(context, resources, appContext);
+
+        // Textures past their last use go back to the pool for the following passes
+        for (ResourceNode& resource : m_resources) {
+            if (resource.lastUse != i || resource.pooledTexture < 0) continue;
+
+            PooledTexture& pooled = m_pool[resource.pooledTexture];
+            pooled.inUse = false;
+            liveBytes -= textureBytes(pooled.desc, pooled.size);
+        }
+    }
+
+    // Erasing from the pool invalidates the texture indices of this frame
+    trimPool(context.currScreenRes);
+    for (ResourceNode& resource : m_resources) {
+        resource.pooledTexture = -1;
+    }
+}
+
+std::shared_ptr<Texture> RenderGraph::getTexture(RenderGraphResource resource) const {
+    int pooledTexture = m_resources[resource].pooledTexture;
+    return pooledTexture >= 0 ? m_pool[pooledTexture].texture : nullptr;
+}
+
+void RenderGraph::attachTargets(FrameBuffer& frameBuffer, std::initializer_list<RenderGraphResource> targets) const {
+    const std::vector<std::shared_ptr<Texture>>& attached = frameBuffer.getAttachedTextures();
+    size_t colorTargets = 0;
+    bool depthTarget = false;
+    bool unchanged = true;
+    for (RenderGraphResource target : targets) {
+        std::shared_ptr<Texture> texture = getTexture(target);
+        if (!texture) {
+            throw std::runtime_error(
+                "Render graph resource " + std::string(m_resources[target].name) + " has no texture this frame"
+            );
+        }
+
+        if (texture->type() == TextureType::Depth) {
+            depthTarget = true;
+            unchanged = unchanged && frameBuffer.getAttachedDepthTexture() == texture;
+        } else {
+            unchanged = unchanged && colorTargets < attached.size() && attached[colorTargets] == texture;
+            colorTargets++;
+        }
+    }
+    unchanged = unchanged && colorTargets == attached.size() &&
+                depthTarget == static_cast<bool>(frameBuffer.getAttachedDepthTexture());
+    if (unchanged) return;
+
+    frameBuffer.clearAttachedTextures();
+    for (RenderGraphResource target : targets) {
+        frameBuffer.attachTexture(getTexture(target));
+    }
+}
+
+void RenderGraph::fillDebugReport(DebugReport& report) const {
+    report.beginGroup("Render Graph");
+    report.addCounter("Executed passes", static_cast<int>(m_passes.size()) - m_lastCulledPasses);
+    report.addCounter("Culled passes", m_lastCulledPasses);
+    report.addCounter("Transient textures", m_lastTransientTextures);
+    report.addCounter("Aliased transient textures", m_lastAliasedTextures);
+    report.addCounter("Peak transient memory (KiB)", static_cast<int>(m_lastPeakTransientBytes / 1024));
+    report.addCounter("Pooled texture memory (KiB)", static_cast<int>(m_pooledBytes / 1024));
+    report.endGroup();
+
+    for (const PassNode& node : m_passes) {
+        node.pass->putDebugInfo(report);
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef TOOMANYBLOCKS_RENDERGRAPH_H
+#define TOOMANYBLOCKS_RENDERGRAPH_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "engine/rendering/lowlevelapi/FrameBuffer.h"
+#include "engine/rendering/lowlevelapi/Texture.h"
+#include "engine/rendering/renderpasses/DebugReport.h"
+#include "engine/rendering/renderpasses/Renderpass.h"
+
+class RenderGraph;
+
+// Handle of a resource declared in a render graph
+using RenderGraphResource = int;
+
+enum class TransientTextureSize {
+    Screen,
+    HalfScreen,
+};
+
+struct TransientTextureDesc {
+    TextureType type;
+    int channels;
+    TransientTextureSize size = TransientTextureSize::Screen;
+    TextureFilter filterMode = TextureFilter::Nearest;
+    TextureWrap wrapMode = TextureWrap::Repeat;
+
+    inline bool operator==(const TransientTextureDesc& other) const {
+        return type == other.type && channels == other.channels && size == other.size &&
+               filterMode == other.filterMode && wrapMode == other.wrapMode;
+    }
+};
+
+/**
+ * @brief Collects the resources a pass reads and writes while it is added to a render graph.
+ */
+class RenderGraphBuilder {
+private:
+    RenderGraph& m_graph;
+    int m_pass;
+
+public:
+    RenderGraphBuilder(RenderGraph& graph, int pass) : m_graph(graph), m_pass(pass) {}
+
+    /**
+     * @brief Declares a texture written by this pass. It only holds memory from this pass to its last reader, so
+     * textures of the same description with disjoint lifetimes share memory.
+     */
+    RenderGraphResource createTexture(const char* name, const TransientTextureDesc& desc);
+
+    /**
+     * @brief Declares a resource living outside of the graph written by this pass, like light or particle buffers.
+     */
+    RenderGraphResource writeExternal(const char* name);
+
+    /**
+     * @brief Declares a write to the screen. Passes writing the screen are never culled for lack of consumers.
+     */
+    RenderGraphResource writeOutput(const char* name);
+
+    /**
+     * @brief Declares a read of a resource written by an earlier pass.
+     *
+     * @param optional If false, this pass is culled whenever the writer of the resource is culled.
+     */
+    RenderGraphResource read(const char* name, bool optional = false);
+};
+
+/**
+ * @brief Runs render passes in the order they were added, culling passes that have no work this frame or whose
+ * outputs are not consumed by any executed pass.
+ *
+ * Transient textures are taken from a pool right before their first write and returned after their last read, so
+ * later passes reuse the memory of earlier ones. Pooled textures left idle for a while are deleted, which frees the
+ * targets of passes that stay culled, e.g. the transparency targets while no transparent object is visible.
+ */
+class RenderGraph {
+    friend class RenderGraphBuilder;
+
+private:
+    struct PassRead {
+        RenderGraphResource resource;
+        bool optional;
+    };
+
+    struct PassNode {
+        std::unique_ptr<Renderpass> pass;
+        std::vector<PassRead> reads;
+        std::vector<RenderGraphResource> writes;
+        bool active = false;
+    };
+
+    struct ResourceNode {
+        const char* name;
+        int writer;
+        bool transient;
+        bool output;
+        TransientTextureDesc desc;
+
+        // Valid while executing a frame
+        bool consumed = false;
+        int lastUse = -1;
+        int pooledTexture = -1;
+    };
+
+    struct PooledTexture {
+        TransientTextureDesc desc;
+        glm::uvec2 size;
+        std::shared_ptr<Texture> texture;
+        uint64_t lastUsedFrame;
+        bool inUse;
+    };
+
+    std::vector<PassNode> m_passes;
+    std::vector<ResourceNode> m_resources;
+    std::vector<PooledTexture> m_pool;
+    uint64_t m_frame;
+
+    int m_lastCulledPasses;
+    int m_lastTransientTextures;
+    int m_lastAliasedTextures;
+    size_t m_lastPeakTransientBytes;
+    size_t m_pooledBytes;
+
+    RenderGraphResource findResource(const char* name) const;
+
+    RenderGraphResource declareWrite(
+        int pass, const char* name, bool transient, bool output, const TransientTextureDesc& desc
+    );
+
+    RenderGraphResource declareRead(int pass, const char* name, bool optional);
+
+    int acquireTexture(const TransientTextureDesc& desc, glm::uvec2 screenRes);
+
+    void trimPool(glm::uvec2 screenRes);
+
+public:
+    RenderGraph()
+        : m_frame(0),
+          m_lastCulledPasses(0),
+          m_lastTransientTextures(0),
+          m_lastAliasedTextures(0),
+          m_lastPeakTransientBytes(0),
+          m_pooledBytes(0) {}
+
+    /**
+     * @brief Appends a pass and collects its declared resources.
+     *
+     * @throws std::runtime_error If the pass reads a resource no earlier pass writes or writes one already written.
+     */
+    void addPass(std::unique_ptr<Renderpass> pass);
+
+    void execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext);
+
+    /**
+     * @return The texture of a transient resource for the current frame, nullptr if its writer was culled.
+     */
+    std::shared_ptr<Texture> getTexture(RenderGraphResource resource) const;
+
+    /**
+     * @brief Attaches the textures of the given transient resources, only touching the framebuffer if the pool
+     * handed out different textures than last frame.
+     *
+     * @throws std::runtime_error If a resource has no texture this frame.
+     */
+    void attachTargets(FrameBuffer& frameBuffer, std::initializer_list<RenderGraphResource> targets) const;
+
+    void fillDebugReport(DebugReport& report) const;
+};
+
+#endif
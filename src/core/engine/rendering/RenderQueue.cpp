@@ -0,0 +1,104 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <numeric>
+
+static constexpr int RADIX_BITS = 8;
+static constexpr size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+static constexpr uint64_t RADIX_MASK = RADIX_BUCKETS - 1;
+
+static constexpr int DEPTH_BITS = 13;
+static constexpr int TEXTURE_SHIFT = DEPTH_BITS;
+static constexpr int MATERIAL_SHIFT = TEXTURE_SHIFT + 16;
+static constexpr int SHADER_SHIFT = MATERIAL_SHIFT + 16;
+static constexpr int PASS_SHIFT = SHADER_SHIFT + 16;
+// Half block precision up to a distance of 4096 blocks
+static constexpr float DEPTH_STEPS_PER_UNIT = 2.0f;
+
+uint64_t RenderQueue::makeSortKey(
+    PassType passType,
+    unsigned int shaderId,
+    uint16_t materialId,
+    unsigned int textureId,
+    float viewDistance
+) {
+    uint64_t maxDepth = (uint64_t(1) << DEPTH_BITS) - 1;
+    uint64_t depth = std::min(static_cast<uint64_t>(std::max(viewDistance, 0.0f) * DEPTH_STEPS_PER_UNIT), maxDepth);
+
+    return (static_cast<uint64_t>(passType) & 0x7) << PASS_SHIFT |
+           static_cast<uint64_t>(shaderId & 0xFFFF) << SHADER_SHIFT |
+           static_cast<uint64_t>(materialId) << MATERIAL_SHIFT |
+           static_cast<uint64_t>(textureId & 0xFFFF) << TEXTURE_SHIFT | depth;
+}
+
+void RenderQueue::sort() {
+    size_t count = m_keys.size();
+    m_order.resize(count);
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    m_keysScratch.resize(count);
+    m_orderScratch.resize(count);
+    if (count < 2) return;
+
+    size_t histogram[RADIX_BUCKETS];
+    for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+        std::fill(histogram, histogram + RADIX_BUCKETS, 0);
+        for (uint64_t key : m_keys) {
+            histogram[(key >> shift) & RADIX_MASK]++;
+        }
+        // All keys share this digit, most do since only a few materials and shaders exist
+        if (histogram[(m_keys[0] >> shift) & RADIX_MASK] == count) continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            size_t dst = histogram[(m_keys[i] >> shift) & RADIX_MASK]++;
+            m_keysScratch[dst] = m_keys[i];
+            m_orderScratch[dst] = m_order[i];
+        }
+        m_keys.swap(m_keysScratch);
+        m_order.swap(m_orderScratch);
+    }
+}
+
+void RenderQueue::build(
+    const std::vector<const RenderProxy*>& objects,
+    PassType passType,
+    const glm::vec3& viewPos
+) {
+    m_packets.clear();
+    m_keys.clear();
+
+    for (const RenderProxy* object : objects) {
+        Material* material = object->material;
+        if (!material->supportsPass(passType)) continue;
+
+        float viewDistance = glm::distance(viewPos, object->transform.getPosition());
+        m_keys.push_back(makeSortKey(
+            passType, material->shaderSortId(passType), material->sortId(), material->textureSortId(), viewDistance
+        ));
+        m_packets.push_back(object);
+    }
+
+    sort();
+}
+
+size_t RenderQueue::runEnd(size_t begin) const {
+    Material* material = (*this)[begin].material;
+    size_t end = begin + 1;
+    while (end < size() && (*this)[end].material == material) end++;
+    return end;
+}
+
+const std::vector<const RenderProxy*>& RenderQueue::runObjects(size_t begin, size_t end) {
+    m_runObjects.clear();
+    for (size_t i = begin; i < end; i++) {
+        m_runObjects.push_back(m_packets[m_order[i]]);
+    }
+    return m_runObjects;
+}
@@ -0,0 +1,68 @@
+#ifndef TOOMANYBLOCKS_RENDERQUEUE_H
+#define TOOMANYBLOCKS_RENDERQUEUE_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <vector>
+
+#include "engine/rendering/RenderScene.h"
+#include "engine/rendering/mat/Material.h"
+
+/**
+ * @brief Draws of one pass, ordered by 64 bit sort keys so that draws sharing gpu state are adjacent.
+ *
+ * Keys pack, from most to least significant: pass (3 bits), shader (16 bits), material (16 bits), texture
+ * (16 bits) and the quantized distance to the viewer (13 bits), so equal materials form contiguous runs that are
+ * drawn front to back. Keys are sorted with an LSD radix sort. All storage is retained across frames, so filling
+ * the queue does not allocate once it has grown to the working set. Every draw is a render proxy, its type tag
+ * selects the type specific data of the renderable.
+ */
+class RenderQueue {
+private:
+    std::vector<const RenderProxy*> m_packets;
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_order;  // Packet indices in sorted order
+    std::vector<uint64_t> m_keysScratch;
+    std::vector<uint32_t> m_orderScratch;
+    std::vector<const RenderProxy*> m_runObjects;
+
+    void sort();
+
+public:
+    static uint64_t makeSortKey(
+        PassType passType,
+        unsigned int shaderId,
+        uint16_t materialId,
+        unsigned int textureId,
+        float viewDistance
+    );
+
+    /**
+     * @brief Replaces the queue contents with the draws of all proxies whose material supports the pass.
+     *
+     * @param objects Proxies to draw.
+     * @param passType The pass the queue is built for.
+     * @param viewPos World position of the viewer, used to order draws front to back.
+     */
+    void build(const std::vector<const RenderProxy*>& objects, PassType passType, const glm::vec3& viewPos);
+
+    /**
+     * @return End of the run of draws starting at begin that share the same material.
+     */
+    size_t runEnd(size_t begin) const;
+
+    /**
+     * @return Proxies of the draws in [begin, end), valid until the next call.
+     */
+    const std::vector<const RenderProxy*>& runObjects(size_t begin, size_t end);
+
+    inline const RenderProxy& operator[](size_t i) const { return *m_packets[m_order[i]]; }
+
+    inline size_t size() const { return m_order.size(); }
+
+    inline bool empty() const { return m_order.empty(); }
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "RenderScene.h"
+
+#include <algorithm>
+
+void RenderScene::capture(RenderProxy& proxy) {
+    const Renderable* renderable = proxy.renderable;
+    proxy.material = renderable->getMaterial().get();
+    proxy.type = renderable->getDrawPacketType();
+    proxy.transform = renderable->getRenderableTransform();
+    proxy.contentRevision = renderable->contentRevision();
+
+    // Not cullable bounds span the whole float range and pass every plane test as is
+    BoundingBox bounds = renderable->getBoundingBox();
+    if (!bounds.isInvalid() && !bounds.isNotCullable()) {
+        bounds = bounds.movedBy(renderable->getGlobalTransform().getPosition());
+    }
+    proxy.worldBounds = bounds;
+}
+
+void RenderScene::rebuildBounds() {
+    m_bounds.clear();
+    for (RenderProxy& proxy : m_proxies) {
+        proxy.boundsIndex = -1;
+        if (!proxy.renderable || !belongsInBounds(proxy)) continue;
+        proxy.boundsIndex = static_cast<int>(m_bounds.push(&proxy));
+    }
+    m_boundsDirty = false;
+}
+
+RenderProxy* RenderScene::addProxy(Renderable* renderable, bool cullByBounds) {
+    RenderProxy* proxy;
+    if (!m_freeProxies.empty()) {
+        proxy = m_freeProxies.back();
+        m_freeProxies.pop_back();
+    } else {
+        proxy = &m_proxies.emplace_back();
+    }
+
+    proxy->renderable = renderable;
+    proxy->material = nullptr;
+    proxy->type = renderable->getDrawPacketType();
+    proxy->transform = Transform();
+    proxy->worldBounds = BoundingBox::invalid();
+    proxy->contentRevision = 0;
+    proxy->cullByBounds = cullByBounds;
+    proxy->ready = false;
+    proxy->hidden = false;
+    proxy->boundsIndex = -1;
+    m_pendingProxies.push_back(proxy);
+    m_proxyCount++;
+    return proxy;
+}
+
+void RenderScene::removeProxy(RenderProxy* proxy) {
+    if (!proxy->ready) {
+        m_pendingProxies.erase(std::find(m_pendingProxies.begin(), m_pendingProxies.end(), proxy));
+    }
+    if (proxy->boundsIndex >= 0) m_boundsDirty = true;
+
+    proxy->renderable = nullptr;
+    proxy->ready = false;
+    proxy->boundsIndex = -1;
+    m_freeProxies.push_back(proxy);
+    m_proxyCount--;
+}
+
+void RenderScene::updateProxy(RenderProxy* proxy) {
+    if (!proxy->ready) return;
+
+    capture(*proxy);
+    if (proxy->boundsIndex < 0 || !belongsInBounds(*proxy)) {
+        m_boundsDirty = m_boundsDirty || proxy->boundsIndex >= 0 || belongsInBounds(*proxy);
+        return;
+    }
+    m_bounds.update(proxy->boundsIndex, proxy->worldBounds);
+}
+
+void RenderScene::setHidden(RenderProxy* proxy, bool hidden) {
+    if (proxy->hidden == hidden) return;
+
+    proxy->hidden = hidden;
+    m_boundsDirty = m_boundsDirty || proxy->boundsIndex >= 0 || belongsInBounds(*proxy);
+}
+
+void RenderScene::commitChanges() {
+    for (size_t i = 0; i < m_pendingProxies.size();) {
+        RenderProxy* proxy = m_pendingProxies[i];
+        if (!proxy->renderable->isReady()) {
+            i++;
+            continue;
+        }
+
+        proxy->ready = true;
+        capture(*proxy);
+        m_boundsDirty = m_boundsDirty || belongsInBounds(*proxy);
+        m_pendingProxies[i] = m_pendingProxies.back();
+        m_pendingProxies.pop_back();
+    }
+
+    if (m_boundsDirty) rebuildBounds();
+}
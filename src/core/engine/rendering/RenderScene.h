@@ -0,0 +1,92 @@
+#ifndef TOOMANYBLOCKS_RENDERSCENE_H
+#define TOOMANYBLOCKS_RENDERSCENE_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "engine/geometry/BoundingVolume.h"
+#include "engine/rendering/Frustum.h"
+#include "engine/rendering/Renderable.h"
+
+/**
+ * @brief Retained render state of one renderable, everything the visibility and the passes read per draw.
+ *
+ * The state is a copy taken when the proxy becomes ready and whenever its owner calls RenderScene::updateProxy(),
+ * so drawing does not go through the virtual and recursive getters of the renderable.
+ */
+struct RenderProxy {
+    Renderable* renderable;
+    Material* material;  // Owned by the renderable
+    DrawPacketType type;
+    Transform transform;      // Renderable transform
+    BoundingBox worldBounds;  // Invalid bounds are never visible, not cullable bounds always are
+    uint64_t contentRevision;
+    bool cullByBounds;  // False if the owner culls the proxy itself, like chunks found through the chunk grid
+    bool ready;
+    bool hidden;
+    int boundsIndex;  // Slot in the bounds array of the scene, -1 if not in it
+};
+
+/**
+ * @brief All renderables drawn by the renderer, registered once instead of submitted every frame.
+ *
+ * Proxies live at stable addresses until they are removed. Renderables that are not ready yet are polled once per
+ * frame until they are, all other proxies only change when their owner updates them. The bounds of cullable
+ * proxies are kept in a structure of arrays, updating a proxy rewrites its slot and only adding, removing or hiding
+ * proxies rebuilds it.
+ */
+class RenderScene {
+private:
+    std::deque<RenderProxy> m_proxies;           // Removed proxies have no renderable and are reused
+    std::vector<RenderProxy*> m_freeProxies;
+    std::vector<RenderProxy*> m_pendingProxies;  // Not ready yet
+    size_t m_proxyCount;
+
+    RenderableBoundsArray m_bounds;
+    bool m_boundsDirty;
+
+    static void capture(RenderProxy& proxy);
+
+    inline static bool belongsInBounds(const RenderProxy& proxy) {
+        return proxy.ready && proxy.cullByBounds && !proxy.hidden && !proxy.worldBounds.isInvalid();
+    }
+
+    void rebuildBounds();
+
+public:
+    RenderScene() : m_proxyCount(0), m_boundsDirty(false) {}
+
+    /**
+     * @brief Registers a renderable, it has to stay valid until its proxy is removed.
+     *
+     * @param cullByBounds If the proxy is frustum culled by its bounds, otherwise the owner collects it itself.
+     */
+    RenderProxy* addProxy(Renderable* renderable, bool cullByBounds = true);
+
+    void removeProxy(RenderProxy* proxy);
+
+    /**
+     * @brief Captures the current transform, bounds, material and content of the renderable.
+     *
+     * Has to be called after any of them changed, proxies that are not ready yet are captured once they are.
+     */
+    void updateProxy(RenderProxy* proxy);
+
+    void setHidden(RenderProxy* proxy, bool hidden);
+
+    /**
+     * @brief Picks up renderables that became ready and brings the bounds up to date, once per frame.
+     */
+    void commitChanges();
+
+    inline const RenderableBoundsArray& bounds() const { return m_bounds; }
+
+    inline size_t size() const { return m_proxyCount; }
+
+    inline size_t pendingCount() const { return m_pendingProxies.size(); }
+};
+
+#endif
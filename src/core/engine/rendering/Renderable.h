@@ -1,20 +1,37 @@
 #ifndef TOOMANYBLOCKS_RENDERABLE_H
 #define TOOMANYBLOCKS_RENDERABLE_H
 
+#include <cstdint>
 #include <memory>
 
 #include "engine/comp/SceneComponent.h"
 #include "engine/geometry/BoundingVolume.h"
 #include "engine/rendering/mat/Material.h"
 
+// Tags renderables that need type specific data while drawing, so passes can dispatch without RTTI
+enum class DrawPacketType : uint8_t {
+    Mesh,
+    StaticMesh,
+    SkeletalMesh,
+    ParticleSystem
+};
+
 class Renderable : public SceneComponent {
+public:
+    // Content revision of renderables whose drawn geometry may change every frame
+    static constexpr uint64_t DYNAMIC_CONTENT = UINT64_MAX;
+
 protected:
     std::shared_ptr<Material> m_material;
+    DrawPacketType m_drawPacketType;
 
 public:
-    Renderable(std::shared_ptr<Material> material = nullptr) : m_material(material) {}
+    Renderable(std::shared_ptr<Material> material = nullptr, DrawPacketType drawPacketType = DrawPacketType::Mesh)
+        : m_material(material), m_drawPacketType(drawPacketType) {}
     virtual ~Renderable() = default;
 
+    inline DrawPacketType getDrawPacketType() const { return m_drawPacketType; }
+
     virtual void draw() const = 0;
 
     virtual bool isReady() const { return m_material && m_material->isReady(); }
@@ -26,6 +43,9 @@ public:
     virtual BoundingBox getBoundingBox() const { return BoundingBox::invalid(); };
 
     virtual Transform getRenderableTransform() const { return getGlobalTransform(); }
+
+    // Changes whenever the drawn geometry changes, so cached draw results (e.g. shadow tiles) can be reused
+    virtual uint64_t contentRevision() const { return DYNAMIC_CONTENT; }
 };
 
 #endif
@@ -9,6 +9,8 @@
 #include "engine/GameInstance.h"
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
+#include "engine/rendering/renderpasses/DepthSSAORenderpass.h"
 #include "engine/rendering/renderpasses/OpaqueRenderpass.h"
 #include "engine/rendering/renderpasses/ResolverRenderpass.h"
 #include "engine/rendering/renderpasses/SSAORenderpass.h"
@@ -16,6 +18,9 @@
 #include "engine/rendering/renderpasses/TransformFeebackpass.h"
 #include "engine/rendering/renderpasses/TransparencyRenderpass.h"
 
+static constexpr size_t STAGING_RING_SIZE = 32 * 1024 * 1024;
+static constexpr size_t FRAME_CONSTANT_REGION_SIZE = 1024 * 1024;
+
 static constexpr float fullScreenQuadCCW[] = {
     // Position   // UV-Coords
     -1.0f, 1.0f,  0.0f, 1.0f,  // Top-Left
@@ -50,36 +55,51 @@ void Renderer::init() {
     detailsBuf << "Graphics: " << glGetString(GL_RENDERER) << "[" << glGetString(GL_VENDOR) << "]" << "\n";
 
     // GLEnableDebugging();
-
-    GLCALL(glEnable(GL_DEPTH_TEST));
-    GLCALL(glEnable(GL_CULL_FACE));    // Enable face culling
-    GLCALL(glCullFace(GL_BACK));       // Specify that back faces should be culled (not rendered)
-    GLCALL(glFrontFace(GL_CW));        // Specify frontfaces as faces with clockwise winding
+#ifndef GL_PER_CALL_ERROR_CHECKS
+    GLEnableErrorOutput();
+#endif
+
+    GLStateCache::setDepthTest(true);
+    GLStateCache::setCullFaceEnabled(true);  // Enable face culling
+    GLStateCache::setCullFace(GL_BACK);      // Specify that back faces should be culled (not rendered)
+    GLStateCache::setFrontFace(GL_CW);       // Specify frontfaces as faces with clockwise winding
     GLCALL(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
 
     std::unique_ptr<TransformFeedbackpass> transformFeebackpass = std::make_unique<TransformFeedbackpass>();
     std::unique_ptr<ShadowRenderpass> shadowpass = std::make_unique<ShadowRenderpass>();
     std::unique_ptr<SSAORenderpass> ssaoRenderpass = std::make_unique<SSAORenderpass>();
     std::unique_ptr<OpaqueRenderpass> opaqueRenderpass = std::make_unique<OpaqueRenderpass>();
+    std::unique_ptr<DepthSSAORenderpass> depthSSAORenderpass = std::make_unique<DepthSSAORenderpass>();
     std::unique_ptr<TransparencyRenderpass> transparencyRenderpass = std::make_unique<TransparencyRenderpass>();
     std::unique_ptr<ResolverRenderpass> resolverRenderpass = std::make_unique<ResolverRenderpass>();
 
     LightProcessor& lightProcessor = shadowpass->getLightProcessor();
+    m_lightProcessor = &lightProcessor;
     m_renderResources.priodLightsBuffer.reserve(lightProcessor.totalSupportedLights());
     m_currentRenderContext.lInfo.shadowMapAtlases = lightProcessor.getShadowMapAtlases();
-    m_currentRenderContext.lInfo.shadowMapSizes = lightProcessor.getShadowMapSizes();
+    m_currentRenderContext.lInfo.shadowTileUnit = lightProcessor.getShadowTileUnit();
     m_currentRenderContext.lInfo.lightBuff = lightProcessor.getShaderLightUniformBuffer();
     m_currentRenderContext.lInfo.lightViewProjectionBuff = lightProcessor.getLightViewProjectionUniformBuffer();
 
-    renderpasses.push_back(std::move(transformFeebackpass));
-    renderpasses.push_back(std::move(shadowpass));
-    renderpasses.push_back(std::move(ssaoRenderpass));
-    renderpasses.push_back(std::move(opaqueRenderpass));
-    renderpasses.push_back(std::move(transparencyRenderpass));
-    renderpasses.push_back(std::move(resolverRenderpass));
+    LightClusterProcessor& lightClusterProcessor = shadowpass->getLightClusterProcessor();
+    m_lightClusterProcessor = &lightClusterProcessor;
+    m_currentRenderContext.lInfo.lightClusterBuff = lightClusterProcessor.getClusterBuffer();
+    m_currentRenderContext.lInfo.lightIndexBuff = lightClusterProcessor.getIndexBuffer();
+
+    m_currentRenderContext.ssaoInfo.quality = SSAOQuality::Medium;
 
+    // Passes run in this order, the graph culls those without work or consumers each frame
+    m_renderGraph.addPass(std::move(transformFeebackpass));
+    m_renderGraph.addPass(std::move(shadowpass));
+    m_renderGraph.addPass(std::move(ssaoRenderpass));
+    m_renderGraph.addPass(std::move(opaqueRenderpass));
+    m_renderGraph.addPass(std::move(depthSSAORenderpass));
+    m_renderGraph.addPass(std::move(transparencyRenderpass));
+    m_renderGraph.addPass(std::move(resolverRenderpass));
+
+    m_renderResources.renderGraph = &m_renderGraph;
     m_renderResources.lightsToRender = &m_lightsToRender;
-    m_renderResources.objectsToRender = &m_objectsToRender;
+    m_renderResources.objectBounds = &m_scene.bounds();
 
     // Create vertex array / buffer for fullscreen quad
     m_fullScreenQuad_vbo = VertexBuffer::create(fullScreenQuadCW, sizeof(fullScreenQuadCW));
@@ -90,17 +110,24 @@ void Renderer::init() {
     m_fullScreenQuad_vao = VertexArray::create();
     m_fullScreenQuad_vao.addBuffer(m_fullScreenQuad_vbo);
 
+    m_uploadManager.init(STAGING_RING_SIZE);
+    m_frameConstants.init(FRAME_CONSTANT_REGION_SIZE);
+    m_currentRenderContext.frameConstants = &m_frameConstants;
+
     FrameBuffer::bindDefault();
 }
 
 void Renderer::submitLight(Light* light) { m_lightsToRender.push_back(light); }
 
-void Renderer::submitRenderable(Renderable* obj) {
-    if (!obj->isReady()) return;
-    m_objectsToRender.push_back(obj);
-}
+void Renderer::submitChunkGrid(const ChunkGrid* grid) { m_chunkGrid = grid; }
 
 void Renderer::render(const ApplicationContext& context) {
+    // Fence buffer copies issued since the last frame and recycle finished staging regions
+    m_uploadManager.endFrame();
+
+    // The ui renders between frames and restores state without going through the cache
+    GLStateCache::invalidate();
+
     // Update render context
     glm::uvec2 newScreenRes = glm::uvec2(context.state.screenWidth, context.state.screenHeight);
     m_currentRenderContext.screenResChanged = newScreenRes != m_currentRenderContext.currScreenRes;
@@ -108,7 +135,7 @@ void Renderer::render(const ApplicationContext& context) {
     m_currentRenderContext.deltaTime = context.instance->gameState.deltaTime;
     m_currentRenderContext.elapsedTime = context.instance->gameState.elapsedGameTime;
 
-    m_renderResources.culledObjectsBuffer.reserve(m_objectsToRender.size());
+    m_renderResources.culledObjectsBuffer.reserve(m_scene.size());
 
     // Update camera aspect ratio just in case it changed via resize of screen.
     context.instance->m_player->getCamera()->setAspectRatio(
@@ -116,17 +143,56 @@ void Renderer::render(const ApplicationContext& context) {
     );
 
     auto start = std::chrono::high_resolution_clock::now();
-    for (const std::unique_ptr<Renderpass>& pass : renderpasses) {
-        pass->run(m_currentRenderContext, m_renderResources, context);
-    }
+    m_frameConstants.beginFrame();
+    computeVisibility(context);
+    m_renderGraph.execute(m_currentRenderContext, m_renderResources, context);
+    m_frameConstants.endFrame();
     auto end = std::chrono::high_resolution_clock::now();
 
     m_lastLightCount = static_cast<int>(m_lightsToRender.size());
-    m_lastObjectCount = static_cast<int>(m_objectsToRender.size());
+    m_lastObjectCount = static_cast<int>(m_scene.size());
     m_lastRenderTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+    // Uniform names built from strings at runtime since the last frame, ideally none
+    m_lastRuntimeUniformNames = UniformName::takeRuntimeStringCount();
+    GLStateCache::takeCallCounts(m_lastElidedStateChanges, m_lastIssuedStateChanges);
 
     m_lightsToRender.clear();
-    m_objectsToRender.clear();
+    m_chunkGrid = nullptr;
+}
+
+void Renderer::computeVisibility(const ApplicationContext& context) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    m_renderResources.chunkGrid = m_chunkGrid;
+    m_scene.commitChanges();
+    std::shared_ptr<Camera> camera = context.instance->m_player->getCamera();
+    const Frustum cameraFrustum(camera->getViewProjMatrix());
+    m_renderResources.cameraPosition = camera->getGlobalTransform().getPosition();
+    cullBounds(cameraFrustum, m_scene.bounds(), m_renderResources.cameraVisibleObjects);
+    size_t firstVisibleChunk = m_renderResources.cameraVisibleObjects.size();
+    m_lastTestedChunkCells = 0;
+    m_renderResources.occludedChunks = 0;
+    if (m_chunkGrid && m_chunkOcclusionCullingEnabled) {
+        m_lastTestedChunkCells = static_cast<int>(m_chunkGrid->query(
+            cameraFrustum, m_renderResources.cameraPosition, m_renderResources.cameraVisibleObjects,
+            m_renderResources.occludedChunks
+        ));
+    } else if (m_chunkGrid) {
+        m_lastTestedChunkCells = static_cast<int>(
+            m_chunkGrid->query(cameraFrustum, m_renderResources.cameraVisibleObjects)
+        );
+    }
+
+    // Chunks are appended after the objects
+    m_renderResources.receiverBounds.clear();
+    for (size_t i = firstVisibleChunk; i < m_renderResources.cameraVisibleObjects.size(); i++) {
+        const BoundingBox& bounds = m_renderResources.cameraVisibleObjects[i]->worldBounds;
+        if (!bounds.isInvalid()) m_renderResources.receiverBounds.push_back(bounds);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastVisibleObjectCount = static_cast<int>(m_renderResources.cameraVisibleObjects.size());
+    m_lastVisibilityTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
 }
 
 void Renderer::drawFullscreenQuad() {
@@ -137,10 +203,17 @@ void Renderer::drawFullscreenQuad() {
 void Renderer::fillDebugReport(DebugReport& report) const {
     report.beginGroup("Renderer Stats");
     report.addTimeMs("Total processing time", m_lastRenderTimeMs);
-    report.addCounter("Submitted objects", m_lastObjectCount);
+    report.addCounter("Scene proxies", m_lastObjectCount);
+    report.addCounter("Pending proxies", static_cast<int>(m_scene.pendingCount()));
     report.addCounter("Submitted lights", m_lastLightCount);
-    for (const std::unique_ptr<Renderpass>& pass : renderpasses) {
-        pass->putDebugInfo(report);
-    }
+    report.addCounter("Visible objects", m_lastVisibleObjectCount);
+    report.addCounter("Tested chunk grid cells", m_lastTestedChunkCells);
+    report.addTimeMs("Visibility time", m_lastVisibilityTimeMs);
+    report.addCounter("Runtime string uniform names", static_cast<int>(m_lastRuntimeUniformNames));
+    report.addCounter("Elided state changes", m_lastElidedStateChanges);
+    report.addCounter("Issued state changes", m_lastIssuedStateChanges);
+    m_renderGraph.fillDebugReport(report);
+    m_uploadManager.fillDebugReport(report);
+    m_frameConstants.fillDebugReport(report);
     report.endGroup();
 }
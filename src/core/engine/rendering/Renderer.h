@@ -6,14 +6,23 @@
 #include <vector>
 
 #include "compatability/Compatability.h"
+#include "engine/env/ChunkGrid.h"
 #include "engine/env/lights/Light.h"
-#include "engine/rendering/Renderable.h"
+#include "engine/rendering/FrameConstantRing.h"
+#include "engine/rendering/Frustum.h"
+#include "engine/rendering/RenderGraph.h"
+#include "engine/rendering/RenderScene.h"
+#include "engine/rendering/UploadManager.h"
+#include "engine/rendering/lowlevelapi/ShaderStorageBuffer.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
 #include "engine/rendering/lowlevelapi/UniformBuffer.h"
 #include "engine/rendering/lowlevelapi/VertexArray.h"
 #include "engine/rendering/lowlevelapi/VertexBuffer.h"
 #include "engine/rendering/renderpasses/DebugReport.h"
 #include "engine/rendering/renderpasses/Renderpass.h"
+#include "engine/rendering/renderpasses/processors/LightClusterProcessor.h"
+#include "engine/rendering/renderpasses/processors/LightProcessor.h"
+#include "engine/rendering/renderpasses/processors/SSAOProcessor.h"
 
 struct ApplicationContext;
 
@@ -21,10 +30,14 @@ struct LightingInfo {
     unsigned int activeLightsCount;
     const UniformBuffer* lightBuff;
     const UniformBuffer* lightViewProjectionBuff;
-    LightPriority currentLightPrio;
-    unsigned int lightShadowAtlasIndex;
-    std::array<unsigned int, LightPriority::Count> shadowMapSizes;
-    std::array<Texture*, LightPriority::Count> shadowMapAtlases;
+    unsigned int shadowTileUnit;
+    std::array<Texture*, SHADOW_ATLAS_PAGES> shadowMapAtlases;
+
+    // Per cluster (offset, count) pairs into a list of light indices, only valid if enabled
+    bool lightClustersEnabled;
+    const ShaderStorageBuffer* lightClusterBuff;
+    const ShaderStorageBuffer* lightIndexBuff;
+    glm::vec2 lightClusterDepthParams;
 };
 
 struct TransformInfo {
@@ -44,12 +57,13 @@ struct ParticleInfo {
 };
 
 struct SSAOInfo {
-    const Texture* output;
+    SSAOQuality quality;
+    const Texture* output;         // Sampled by the chunk shader in screen space, only written by the High tier
+    const Texture* resolveOutput;  // Half resolution occlusion and view depth, upsampled and applied by the resolver
 };
 
 struct OpaqueInfo {
     const Texture* output;
-    std::shared_ptr<Texture> usedDepthTexture;
 };
 
 struct TransparencyInfo {
@@ -58,7 +72,7 @@ struct TransparencyInfo {
 };
 
 struct SkeletalMeshInfo {
-    const UniformBuffer* jointMatrices;
+    UniformBufferRange jointMatrices;
 };
 
 struct RenderContext {
@@ -67,6 +81,8 @@ struct RenderContext {
     float deltaTime;
     float elapsedTime;
 
+    FrameConstantRing* frameConstants;  // Per draw constants are streamed into this ring
+
     TransformInfo tInfo;
     SkeletalMeshInfo skInfo;
     LightingInfo lInfo;
@@ -78,41 +94,97 @@ struct RenderContext {
 
 struct RenderResources {
     const std::vector<Light*>* lightsToRender;
-    const std::vector<Renderable*>* objectsToRender;
+    const RenderableBoundsArray* objectBounds;  // Bounds of all cullable proxies of the render scene
+    const ChunkGrid* chunkGrid;
+    const RenderGraph* renderGraph;
 
     std::vector<Light*> priodLightsBuffer;
-    std::vector<Renderable*> culledObjectsBuffer;
+    std::vector<const RenderProxy*> culledObjectsBuffer;
+
+    // Computed once per frame before any pass runs
+    std::vector<const RenderProxy*> cameraVisibleObjects;
+    std::vector<BoundingBox> receiverBounds;  // World bounds of the visible chunks, the only shadow receivers
+    glm::vec3 cameraPosition;
+    size_t occludedChunks;  // Chunks inside the camera frustum that are hidden behind terrain
 };
 
 class Renderer {
 private:
     std::vector<Light*> m_lightsToRender;
-    std::vector<Renderable*> m_objectsToRender;
+    RenderScene m_scene;
+    const ChunkGrid* m_chunkGrid;
 
     VertexArray m_fullScreenQuad_vao;
     VertexBuffer m_fullScreenQuad_vbo;
 
+    UploadManager m_uploadManager;
+    FrameConstantRing m_frameConstants;
+
     RenderContext m_currentRenderContext;
     RenderResources m_renderResources;
-    std::vector<std::unique_ptr<Renderpass>> renderpasses;
+    RenderGraph m_renderGraph;
+    LightProcessor* m_lightProcessor;
+    LightClusterProcessor* m_lightClusterProcessor;
 
     int m_lastLightCount;
     int m_lastObjectCount;
+    int m_lastVisibleObjectCount;
+    int m_lastTestedChunkCells;
+    float m_lastVisibilityTimeMs;
     float m_lastRenderTimeMs;
+    unsigned int m_lastRuntimeUniformNames;
+    int m_lastElidedStateChanges;
+    int m_lastIssuedStateChanges;
+
+    bool m_chunkOcclusionCullingEnabled;
 
 public:
-    Renderer() : m_currentRenderContext{}, m_renderResources{} {}
+    Renderer()
+        : m_chunkGrid(nullptr),
+          m_currentRenderContext{},
+          m_renderResources{},
+          m_lightProcessor(nullptr),
+          m_lightClusterProcessor(nullptr),
+          m_chunkOcclusionCullingEnabled(true) {}
 
     void init();
 
     void submitLight(Light* light);
 
-    void submitRenderable(Renderable* obj);
+    /**
+     * @brief Submits the chunks of a chunk grid for this frame, they are culled hierarchically by the grid.
+     */
+    void submitChunkGrid(const ChunkGrid* grid);
 
     void render(const ApplicationContext& context);
 
+    /**
+     * @brief Commits changes of the render scene and culls it against the camera once for all passes.
+     */
+    void computeVisibility(const ApplicationContext& context);
+
     void drawFullscreenQuad();
 
+    inline bool isChunkOcclusionCullingEnabled() const { return m_chunkOcclusionCullingEnabled; }
+
+    inline void setChunkOcclusionCullingEnabled(bool enabled) { m_chunkOcclusionCullingEnabled = enabled; }
+
+    inline bool isShadowTileCachingEnabled() const { return m_lightProcessor->isShadowTileCachingEnabled(); }
+
+    inline void setShadowTileCachingEnabled(bool enabled) { m_lightProcessor->setShadowTileCachingEnabled(enabled); }
+
+    inline bool isClusteredShadingEnabled() const { return m_lightClusterProcessor->isEnabled(); }
+
+    inline void setClusteredShadingEnabled(bool enabled) { m_lightClusterProcessor->setEnabled(enabled); }
+
+    inline SSAOQuality getSSAOQuality() const { return m_currentRenderContext.ssaoInfo.quality; }
+
+    inline void setSSAOQuality(SSAOQuality quality) { m_currentRenderContext.ssaoInfo.quality = quality; }
+
+    inline UploadManager& getUploadManager() { return m_uploadManager; }
+
+    inline RenderScene& getRenderScene() { return m_scene; }
+
     void fillDebugReport(DebugReport& report) const;
 };
 
@@ -2,6 +2,8 @@
 
 #include <GL/glew.h>
 
+static constexpr size_t MIN_STREAMED_JOINTS = 4;
+
 void SkeletalMesh::draw() const {
     if (!m_internalHandle.isReady()) return;
 
@@ -26,13 +28,14 @@ bool SkeletalMesh::playAnimation(const std::string& animName, bool loop, bool re
 
 void SkeletalMesh::stopAnimation() { m_activeAnim = nullptr; }
 
-const UniformBuffer* SkeletalMesh::getJointMatrices() const {
-    if (!m_internalHandle.isReady()) return nullptr;
+UniformBufferRange SkeletalMesh::streamJointMatrices(FrameConstantRing& constants) const {
+    if (!m_internalHandle.isReady()) return UniformBufferRange();
 
     const std::vector<int>& jointNodeIndices = m_internalHandle.value().shared->jointNodeIndices;
 
-    std::vector<glm::mat4> jointMatrices;
-    jointMatrices.reserve(jointNodeIndices.size());
+    // Only used on the main thread while drawing, kept to not allocate per draw
+    static std::vector<glm::mat4> jointMatrices;
+    jointMatrices.clear();
 
     for (int i = 0; i < jointNodeIndices.size(); i++) {
         int jointIdx = jointNodeIndices[i];
@@ -41,10 +44,9 @@ const UniformBuffer* SkeletalMesh::getJointMatrices() const {
 
         jointMatrices.push_back(joint.getGlobalTransform().getModelMatrix() * bindMatrix);
     }
-    m_internalHandle.value().instance.jointMatricesUBO.updateData(
-        jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4)
-    );
-    return &m_internalHandle.value().instance.jointMatricesUBO;
+    // The shader reads at least this many matrices
+    if (jointMatrices.size() < MIN_STREAMED_JOINTS) jointMatrices.resize(MIN_STREAMED_JOINTS, glm::mat4(1.0f));
+    return constants.allocate(jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
 }
 
 Transform SkeletalMesh::getRenderableTransform() const {
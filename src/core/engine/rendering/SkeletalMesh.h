@@ -5,6 +5,7 @@
 
 #include "engine/animation/Animation.h"
 #include "engine/geometry/BoundingVolume.h"
+#include "engine/rendering/FrameConstantRing.h"
 #include "engine/rendering/RenderData.h"
 #include "engine/rendering/Renderable.h"
 #include "engine/rendering/lowlevelapi/UniformBuffer.h"
@@ -23,7 +24,6 @@ public:
         int animatedMeshNodeIndex;
         std::vector<SceneComponent> nodeArray;
         std::vector<Animation> animations;
-        UniformBuffer jointMatricesUBO;
         BoundingBox bounds;
     };
 
@@ -37,9 +37,9 @@ private:
     Animation* m_activeAnim;
 
 public:
-    SkeletalMesh() : m_activeAnim(nullptr) {}
+    SkeletalMesh() : Renderable(nullptr, DrawPacketType::SkeletalMesh), m_activeAnim(nullptr) {}
     SkeletalMesh(const Future<Internal>& internalHandle, std::shared_ptr<Material> material = nullptr)
-        : Renderable(material), m_internalHandle(internalHandle), m_activeAnim(nullptr) {}
+        : Renderable(material, DrawPacketType::SkeletalMesh), m_internalHandle(internalHandle), m_activeAnim(nullptr) {}
     virtual ~SkeletalMesh() = default;
 
     void draw() const override;
@@ -54,7 +54,12 @@ public:
 
     inline Future<Internal>& getAssetHandle() { return m_internalHandle; }
 
-    const UniformBuffer* getJointMatrices() const;
+    /**
+     * @brief Writes the current joint matrices into the frame constants.
+     *
+     * @return The range holding the matrices, invalid if they did not fit.
+     */
+    UniformBufferRange streamJointMatrices(FrameConstantRing& constants) const;
 
     Transform getRenderableTransform() const override;
 
@@ -26,9 +26,9 @@ private:
     Future<Internal> m_internalHandle;
 
 public:
-    StaticMesh() = default;
+    StaticMesh() : Renderable(nullptr, DrawPacketType::StaticMesh) {}
     StaticMesh(const Future<Internal>& internalHandle, std::shared_ptr<Material> material = nullptr)
-        : Renderable(material), m_internalHandle(internalHandle) {}
+        : Renderable(material, DrawPacketType::StaticMesh), m_internalHandle(internalHandle) {}
     virtual ~StaticMesh() = default;
 
     void draw() const override;
@@ -37,7 +37,16 @@ public:
 
     inline Future<Internal>& getAssetHandle() { return m_internalHandle; }
 
+    inline const RenderData* getRenderData() const {
+        return m_internalHandle.isReady() ? m_internalHandle.value().shared->renderData.get() : nullptr;
+    }
+
     virtual BoundingBox getBoundingBox() const override;
+
+    inline uint64_t contentRevision() const override {
+        const RenderData* renderData = getRenderData();
+        return renderData ? renderData->uid() : 0;
+    }
 };
 
 #endif
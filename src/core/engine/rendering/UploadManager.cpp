@@ -0,0 +1,197 @@
+#include "UploadManager.h"
+
+#include <GL/glew.h>
+
+#include <stdexcept>
+
+#include "Logger.h"
+#include "engine/rendering/GLUtils.h"
+
+// Regions start on cache line boundaries so workers writing neighbouring regions do not share lines
+static constexpr size_t STAGING_ALIGNMENT = 64;
+
+static inline size_t alignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+void StagingAllocation::release() {
+    if (!m_ring) return;
+
+    std::lock_guard<std::mutex> lock(m_ring->mtx);
+    if (m_id >= m_ring->frontId) {
+        m_ring->regions[m_id - m_ring->frontId].released = true;
+    }
+    m_ring.reset();
+}
+
+StagingAllocation::StagingAllocation(StagingAllocation&& other) noexcept
+    : m_ring(std::move(other.m_ring)), m_id(other.m_id), m_offset(other.m_offset), m_size(other.m_size) {}
+
+StagingAllocation::~StagingAllocation() { release(); }
+
+StagingAllocation& StagingAllocation::operator=(StagingAllocation&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_ring = std::move(other.m_ring);
+        m_id = other.m_id;
+        m_offset = other.m_offset;
+        m_size = other.m_size;
+    }
+    return *this;
+}
+
+void UploadManager::reclaimRegions(StagingRingState& ring) {
+    while (!ring.regions.empty()) {
+        const StagingRingState::Region& front = ring.regions.front();
+        if (!front.released || front.copySerial > ring.completedSerial) break;
+
+        ring.regions.pop_front();
+        ring.frontId++;
+    }
+
+    if (ring.regions.empty()) {
+        ring.head = 0;
+    }
+}
+
+UploadManager::UploadManager()
+    : m_nextFenceSerial(1),
+      m_copiesSinceFence(false),
+      m_stagedBytes(0),
+      m_failedAllocations(0),
+      m_copiedBytes(0),
+      m_lastStagedBytes(0),
+      m_lastFailedAllocations(0),
+      m_lastCopiedBytes(0),
+      m_lastPendingFences(0) {}
+
+UploadManager::~UploadManager() {
+    for (const std::pair<uint64_t, GLsync>& fence : m_pendingFences) {
+        glDeleteSync(fence.second);
+    }
+
+    if (m_ring) {
+        // Outstanding allocations keep the bookkeeping alive, but must not touch the unmapped memory anymore
+        std::lock_guard<std::mutex> lock(m_ring->mtx);
+        m_ring->mapped = nullptr;
+        m_ring->capacity = 0;
+    }
+}
+
+void UploadManager::init(size_t capacity) {
+    if (!StagingBuffer::isSupported()) {
+        lgr::lout.warn("Persistent buffer mapping unsupported, falling back to direct buffer uploads");
+        return;
+    }
+
+    m_stagingBuffer = StagingBuffer::create(capacity);
+    m_ring = std::make_shared<StagingRingState>();
+    m_ring->mapped = m_stagingBuffer.mappedData();
+    m_ring->capacity = m_stagingBuffer.getByteSize();
+}
+
+StagingAllocation UploadManager::allocate(size_t size) {
+    StagingAllocation allocation;
+    if (!m_ring || size == 0) return allocation;
+
+    size_t alignedSize = alignUp(size, STAGING_ALIGNMENT);
+
+    std::lock_guard<std::mutex> lock(m_ring->mtx);
+    StagingRingState& ring = *m_ring;
+    reclaimRegions(ring);
+
+    size_t offset = 0;
+    if (!ring.regions.empty()) {
+        size_t tail = ring.regions.front().offset;
+        if (ring.head > tail) {
+            // Free space after the head and, when wrapping around, before the tail
+            if (ring.capacity - ring.head >= alignedSize) {
+                offset = ring.head;
+            } else if (tail >= alignedSize) {
+                offset = 0;
+            } else {
+                m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+                return allocation;
+            }
+        } else {
+            // Head already wrapped around, only the gap up to the tail is free
+            if (tail - ring.head >= alignedSize) {
+                offset = ring.head;
+            } else {
+                m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+                return allocation;
+            }
+        }
+    } else if (alignedSize > ring.capacity) {
+        m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+        return allocation;
+    }
+
+    ring.regions.push_back({offset, alignedSize, false, 0});
+    ring.head = offset + alignedSize;
+
+    allocation.m_ring = m_ring;
+    allocation.m_id = ring.frontId + ring.regions.size() - 1;
+    allocation.m_offset = offset;
+    allocation.m_size = size;
+
+    m_stagedBytes.fetch_add(static_cast<int>(size), std::memory_order_relaxed);
+    return allocation;
+}
+
+void UploadManager::copyToBuffer(const StagingAllocation& src, unsigned int dstBufferId, size_t dstOffset) {
+    if (!src.isValid() || src.m_ring != m_ring) throw std::runtime_error("Invalid staging allocation for copy");
+
+    m_stagingBuffer.copyToBuffer(dstBufferId, src.m_size, src.m_offset, dstOffset);
+
+    {
+        std::lock_guard<std::mutex> lock(m_ring->mtx);
+        if (src.m_id >= m_ring->frontId) {
+            m_ring->regions[src.m_id - m_ring->frontId].copySerial = m_nextFenceSerial;
+        }
+    }
+
+    m_copiesSinceFence = true;
+    m_copiedBytes += static_cast<int>(src.m_size);
+}
+
+void UploadManager::endFrame() {
+    if (!m_ring) return;
+
+    if (m_copiesSinceFence) {
+        GLCALL(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_pendingFences.emplace_back(m_nextFenceSerial++, fence);
+        m_copiesSinceFence = false;
+    }
+
+    // Poll without blocking, fences signal in submission order
+    uint64_t completedSerial = 0;
+    while (!m_pendingFences.empty()) {
+        GLenum result = glClientWaitSync(m_pendingFences.front().second, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) break;
+
+        completedSerial = m_pendingFences.front().first;
+        glDeleteSync(m_pendingFences.front().second);
+        m_pendingFences.pop_front();
+    }
+
+    if (completedSerial != 0) {
+        std::lock_guard<std::mutex> lock(m_ring->mtx);
+        m_ring->completedSerial = completedSerial;
+        reclaimRegions(*m_ring);
+    }
+
+    m_lastStagedBytes = m_stagedBytes.exchange(0, std::memory_order_relaxed);
+    m_lastFailedAllocations = m_failedAllocations.exchange(0, std::memory_order_relaxed);
+    m_lastCopiedBytes = m_copiedBytes;
+    m_lastPendingFences = static_cast<int>(m_pendingFences.size());
+    m_copiedBytes = 0;
+}
+
+void UploadManager::fillDebugReport(DebugReport& report) const {
+    report.beginGroup("Uploads");
+    report.addCounter("Staging ring enabled", isEnabled() ? 1 : 0);
+    report.addCounter("Staged bytes", m_lastStagedBytes);
+    report.addCounter("Copied bytes", m_lastCopiedBytes);
+    report.addCounter("Failed allocations", m_lastFailedAllocations);
+    report.addCounter("Pending fences", m_lastPendingFences);
+    report.endGroup();
+}
@@ -0,0 +1,146 @@
+#ifndef TOOMANYBLOCKS_UPLOADMANAGER_H
+#define TOOMANYBLOCKS_UPLOADMANAGER_H
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "compatability/Compatability.h"
+#include "engine/rendering/lowlevelapi/StagingBuffer.h"
+#include "engine/rendering/renderpasses/DebugReport.h"
+
+/**
+ * @brief Bookkeeping of the staging ring that is shared between the upload manager and all allocations.
+ *
+ * Regions are stored in allocation order, so the front region always marks the tail of the ring.
+ */
+struct StagingRingState {
+    struct Region {
+        size_t offset;
+        size_t size;
+        bool released;
+        uint64_t copySerial;  // Fence serial covering the last copy out of this region, 0 if never copied
+    };
+
+    std::mutex mtx;
+    unsigned char* mapped = nullptr;
+    size_t capacity = 0;
+    size_t head = 0;
+    uint64_t frontId = 0;
+    uint64_t completedSerial = 0;
+    std::deque<Region> regions;
+};
+
+/**
+ * @brief Move-only handle to a region of the staging ring.
+ *
+ * The memory may be written from any thread. Once the handle is destroyed, the region is returned to the
+ * ring as soon as the GPU finished all copies reading from it.
+ */
+class StagingAllocation {
+    friend class UploadManager;
+
+private:
+    std::shared_ptr<StagingRingState> m_ring;
+    uint64_t m_id;
+    size_t m_offset;
+    size_t m_size;
+
+    void release();
+
+public:
+    StagingAllocation() noexcept : m_id(0), m_offset(0), m_size(0) {}
+    StagingAllocation(StagingAllocation&& other) noexcept;
+    StagingAllocation(const StagingAllocation&) = delete;
+    ~StagingAllocation();
+
+    /** @return True if this handle owns a region of the staging ring. */
+    inline bool isValid() const { return m_ring != nullptr; }
+
+    /** @return Pointer to the mapped memory of this region, or nullptr if the handle is invalid. */
+    inline unsigned char* data() const { return m_ring ? m_ring->mapped + m_offset : nullptr; }
+
+    /** @return The requested size of this region in bytes. */
+    inline size_t size() const { return m_size; }
+
+    StagingAllocation& operator=(StagingAllocation&& other) noexcept;
+    StagingAllocation& operator=(const StagingAllocation&) = delete;
+};
+
+/**
+ * @brief Streams buffer data to the GPU through a persistently mapped staging ring.
+ *
+ * Worker threads allocate regions and write into mapped memory directly, so the main thread only issues
+ * buffer copies and fences. If persistent mapping is not supported or the ring is full, allocation fails
+ * and callers are expected to fall back to a classic buffer upload.
+ */
+class UploadManager {
+private:
+    std::shared_ptr<StagingRingState> m_ring;
+    StagingBuffer m_stagingBuffer;
+
+    std::deque<std::pair<uint64_t, GLsync>> m_pendingFences;
+    uint64_t m_nextFenceSerial;
+    bool m_copiesSinceFence;
+
+    std::atomic<int> m_stagedBytes;
+    std::atomic<int> m_failedAllocations;
+    int m_copiedBytes;
+
+    int m_lastStagedBytes;
+    int m_lastFailedAllocations;
+    int m_lastCopiedBytes;
+    int m_lastPendingFences;
+
+    static void reclaimRegions(StagingRingState& ring);
+
+public:
+    UploadManager();
+    ~UploadManager();
+
+    /**
+     * @brief Creates the staging ring. Must be called on the main thread with a current OpenGL context.
+     *
+     * If persistent mapping is unsupported, the manager stays disabled and every allocation fails.
+     *
+     * @param capacity Size of the staging ring in bytes.
+     */
+    void init(size_t capacity);
+
+    /** @return True if the staging ring is available. */
+    inline bool isEnabled() const { return m_stagingBuffer.isValid(); }
+
+    /**
+     * @brief Allocates a region of the staging ring. Thread safe.
+     *
+     * @param size Number of bytes to allocate.
+     * @return A valid allocation, or an invalid one if the ring is disabled or has no space left.
+     */
+    StagingAllocation allocate(size_t size);
+
+    /**
+     * @brief Copies a staged region into a buffer object. Main thread only.
+     *
+     * @param src The staged region to copy from.
+     * @param dstBufferId Renderer id of the destination buffer.
+     * @param dstOffset Byte offset in the destination buffer where data should be written.
+     *
+     * @throws std::runtime_error If the allocation is invalid or belongs to another ring.
+     */
+    void copyToBuffer(const StagingAllocation& src, unsigned int dstBufferId, size_t dstOffset = 0);
+
+    /**
+     * @brief Fences all copies issued since the last call and recycles regions whose copies completed.
+     * Should be called once per frame on the main thread.
+     */
+    void endFrame();
+
+    void fillDebugReport(DebugReport& report) const;
+};
+
+#endif
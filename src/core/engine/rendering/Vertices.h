@@ -13,8 +13,10 @@
 #define Y_POSITION_OFFSET             20
 #define Z_POSITION_OFFSET             14
 
-#define ANIMATION_FRAME_COUNT_BITMASK 0xFF
-#define ANIMATION_FRAME_COUNT_OFFSET  6
+#define ANIMATION_FRAME_COUNT_BITMASK 0x3F
+#define ANIMATION_FRAME_COUNT_OFFSET  8
+#define OCCLUSION_BITMASK             0x03
+#define OCCLUSION_OFFSET              6
 #define ANIMATION_FPS_BITMASK         0x3F
 #define ANIMATION_FPS_OFFSET          0
 
@@ -29,13 +31,24 @@
 #define NORMAL_BITMASK                0x07
 #define NORMAL_OFFSET                 0
 
+#define QUAD_WIDTH_BITMASK            0x1F
+#define QUAD_WIDTH_OFFSET             11
+#define QUAD_HEIGHT_BITMASK           0x1F
+#define QUAD_HEIGHT_OFFSET            6
+
+enum class ChunkMeshFormat {
+    Vertices,  // Four CompactChunkVertex and six indices per quad
+    Quads,     // One CompactChunkQuad per quad, expanded in the vertex shader
+    Count
+};
+
 struct UVCoord {
     uint8_t x : 6;
     uint8_t y : 6;
 };
 
 struct CompactChunkVertex {
-    uint32_t packedData1;  // 4 bytes compressed for data (position, frame count, fps)
+    uint32_t packedData1;  // 4 bytes compressed for data (position, frame count, occlusion, fps)
     uint32_t packedData2;  // 4 bytes for compressed data (texIndex, normal, uv)
 
     CompactChunkVertex() = default;
@@ -47,7 +60,8 @@ struct CompactChunkVertex {
         uint16_t texIndex = 0,
         UVCoord uv = {0, 0},
         AxisDirection normal = AxisDirection::PositiveX
-    ) {
+    )
+        : packedData1(0), packedData2(0) {
         setPosition(pos);
         setAnimationFrameCount(frameCount);
         setAnimationFps(frameCount);
@@ -71,7 +85,13 @@ struct CompactChunkVertex {
     inline void setAnimationFrameCount(uint8_t frameCount) {
         SET_BITS(
             packedData1, static_cast<uint32_t>(frameCount), ANIMATION_FRAME_COUNT_BITMASK, ANIMATION_FRAME_COUNT_OFFSET
-        );  // 8 bit frame count [0 - 255]
+        );  // 6 bit frame count [0 - 63]
+    }
+
+    inline void setOcclusion(uint8_t occlusion) {
+        SET_BITS(
+            packedData1, static_cast<uint32_t>(occlusion), OCCLUSION_BITMASK, OCCLUSION_OFFSET
+        );  // 2 bit baked ambient occlusion [0 - 3], 0 is unoccluded
     }
 
     inline void setAnimationFps(uint8_t fps) {
@@ -119,6 +139,10 @@ struct CompactChunkVertex {
         return static_cast<uint16_t>(GET_BITS(packedData2, TEXINDEX_BITMASK, TEXINDEX_OFFSET));
     }
 
+    inline uint8_t getOcclusion() const {
+        return static_cast<uint8_t>(GET_BITS(packedData1, OCCLUSION_BITMASK, OCCLUSION_OFFSET));
+    }
+
     inline UVCoord getUV() const {
         UVCoord uv;
         uv.x = static_cast<uint8_t>(GET_BITS(packedData2, X_UV_BITMASK, X_UV_OFFSET));
@@ -131,6 +155,75 @@ struct CompactChunkVertex {
     }
 };
 
+struct CompactChunkQuad {
+    // 4 bytes compressed for data (origin, corner occlusion), quads carry no animation data and use its bits for the
+    // occlusion of all four corners in the order of generateCompactChunkFace
+    uint32_t packedData1;
+    uint32_t packedData2;  // 4 bytes for compressed data (texIndex, width, height, normal)
+
+    CompactChunkQuad() = default;
+
+    CompactChunkQuad(
+        const glm::ivec3& origin,
+        unsigned int width,
+        unsigned int height,
+        uint16_t texIndex = 0,
+        AxisDirection normal = AxisDirection::PositiveX
+    )
+        : packedData1(0), packedData2(0) {
+        setOrigin(origin);
+        setSize(width, height);
+        setTexIndex(texIndex);
+        setNormal(normal);
+    }
+
+    inline void setOrigin(const glm::ivec3& origin) {
+        SET_BITS(packedData1, static_cast<uint32_t>(origin.x), POSITION_BITMASK, X_POSITION_OFFSET);
+        SET_BITS(packedData1, static_cast<uint32_t>(origin.y), POSITION_BITMASK, Y_POSITION_OFFSET);
+        SET_BITS(packedData1, static_cast<uint32_t>(origin.z), POSITION_BITMASK, Z_POSITION_OFFSET);
+    }
+
+    inline void setSize(unsigned int width, unsigned int height) {
+        // Stored as size - 1, so a full chunk side of 32 fits in 5 bit
+        SET_BITS(packedData2, static_cast<uint32_t>(width - 1), QUAD_WIDTH_BITMASK, QUAD_WIDTH_OFFSET);
+        SET_BITS(packedData2, static_cast<uint32_t>(height - 1), QUAD_HEIGHT_BITMASK, QUAD_HEIGHT_OFFSET);
+    }
+
+    inline void setCornerOcclusion(int corner, uint8_t occlusion) {
+        SET_BITS(packedData1, static_cast<uint32_t>(occlusion), OCCLUSION_BITMASK, OCCLUSION_OFFSET + 2 * corner);
+    }
+
+    inline void setTexIndex(uint16_t texIndex) {
+        SET_BITS(packedData2, static_cast<uint32_t>(texIndex), TEXINDEX_BITMASK, TEXINDEX_OFFSET);
+    }
+
+    inline void setNormal(AxisDirection normal) {
+        SET_BITS(packedData2, static_cast<uint32_t>(normal), NORMAL_BITMASK, NORMAL_OFFSET);
+    }
+
+    inline glm::ivec3 getOrigin() const {
+        glm::ivec3 origin;
+        origin.x = GET_BITS(packedData1, POSITION_BITMASK, X_POSITION_OFFSET);
+        origin.y = GET_BITS(packedData1, POSITION_BITMASK, Y_POSITION_OFFSET);
+        origin.z = GET_BITS(packedData1, POSITION_BITMASK, Z_POSITION_OFFSET);
+        return origin;
+    }
+
+    inline uint8_t getCornerOcclusion(int corner) const {
+        return static_cast<uint8_t>(GET_BITS(packedData1, OCCLUSION_BITMASK, OCCLUSION_OFFSET + 2 * corner));
+    }
+
+    inline unsigned int getWidth() const { return GET_BITS(packedData2, QUAD_WIDTH_BITMASK, QUAD_WIDTH_OFFSET) + 1; }
+
+    inline unsigned int getHeight() const { return GET_BITS(packedData2, QUAD_HEIGHT_BITMASK, QUAD_HEIGHT_OFFSET) + 1; }
+
+    inline AxisDirection getNormalEnum() const {
+        return static_cast<AxisDirection>(GET_BITS(packedData2, NORMAL_BITMASK, NORMAL_OFFSET));
+    }
+};
+
+static_assert(sizeof(CompactChunkQuad) == sizeof(CompactChunkVertex), "Chunk quad and vertex records must match in size");
+
 struct Vertex {
     glm::vec3 position;
     glm::vec2 uv;
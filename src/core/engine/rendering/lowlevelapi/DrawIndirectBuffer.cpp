@@ -0,0 +1,84 @@
+#include "DrawIndirectBuffer.h"
+
+#include <GL/glew.h>
+
+#include <stdexcept>
+
+#include "Logger.h"
+#include "engine/rendering/GLUtils.h"
+
+thread_local unsigned int DrawIndirectBuffer::currentlyBoundDIBO = 0;
+
+DrawIndirectBuffer::DrawIndirectBuffer(const void* data, size_t size) : m_size(size) {
+    GLCALL(glGenBuffers(1, &m_rendererId));
+    bind();
+    GLCALL(glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, GL_DYNAMIC_DRAW));
+}
+
+void DrawIndirectBuffer::bindDefault() {
+    if (DrawIndirectBuffer::currentlyBoundDIBO != 0) {
+        GLCALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+        DrawIndirectBuffer::currentlyBoundDIBO = 0;
+    }
+}
+
+void DrawIndirectBuffer::syncBinding() {
+    int binding;
+    GLCALL(glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &binding));
+    DrawIndirectBuffer::currentlyBoundDIBO = static_cast<unsigned int>(binding);
+}
+
+DrawIndirectBuffer DrawIndirectBuffer::create(const void* data, size_t size) { return DrawIndirectBuffer(data, size); }
+
+DrawIndirectBuffer::DrawIndirectBuffer(DrawIndirectBuffer&& other) noexcept
+    : RenderApiObject(std::move(other)), m_size(other.m_size) {}
+
+DrawIndirectBuffer::~DrawIndirectBuffer() {
+    if (isValid()) {
+        try {
+            if (DrawIndirectBuffer::currentlyBoundDIBO == m_rendererId) {
+                GLCALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+                DrawIndirectBuffer::currentlyBoundDIBO = 0;
+            }
+            GLCALL(glDeleteBuffers(1, &m_rendererId));
+        } catch (const std::exception&) {
+            lgr::lout.error("Error during DrawIndirectBuffer cleanup");
+        }
+    }
+}
+
+void DrawIndirectBuffer::updateData(const void* data, size_t size, size_t offset) const {
+    bind();
+
+    if (offset + size > m_size) throw std::runtime_error("Draw indirect buffer update exceeds buffer size");
+
+    GLCALL(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, size, data));
+}
+
+void DrawIndirectBuffer::bind() const {
+    if (!isValid()) throw std::runtime_error("Invalid state of DrawIndirectBuffer with id 0");
+
+    if (DrawIndirectBuffer::currentlyBoundDIBO != m_rendererId) {
+        GLCALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_rendererId));
+        DrawIndirectBuffer::currentlyBoundDIBO = m_rendererId;
+    }
+}
+
+DrawIndirectBuffer& DrawIndirectBuffer::operator=(DrawIndirectBuffer&& other) noexcept {
+    if (this != &other) {
+        if (isValid()) {
+            try {
+                if (DrawIndirectBuffer::currentlyBoundDIBO == m_rendererId) {
+                    GLCALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+                    DrawIndirectBuffer::currentlyBoundDIBO = 0;
+                }
+                GLCALL(glDeleteBuffers(1, &m_rendererId));
+            } catch (const std::exception&) {
+                lgr::lout.error("Error during DrawIndirectBuffer cleanup");
+            }
+        }
+        RenderApiObject::operator=(std::move(other));
+        m_size = other.m_size;
+    }
+    return *this;
+}
@@ -0,0 +1,95 @@
+#ifndef TOOMANYBLOCKS_DRAWINDIRECTBUFFER_H
+#define TOOMANYBLOCKS_DRAWINDIRECTBUFFER_H
+
+#include <stddef.h>  // For size_t
+
+#include "engine/rendering/lowlevelapi/RenderApiObject.h"
+
+/**
+ * @brief Layout of a single command consumed by glMultiDrawElementsIndirect.
+ */
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+/**
+ * @brief Layout of a single command consumed by glMultiDrawArraysIndirect.
+ */
+struct DrawArraysIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int first;
+    unsigned int baseInstance;
+};
+
+/**
+ * @brief Represents an OpenGL buffer bound to GL_DRAW_INDIRECT_BUFFER.
+ *
+ * Holds draw commands that are sourced by indirect draw calls.
+ */
+class DrawIndirectBuffer : public RenderApiObject {
+private:
+    static thread_local unsigned int currentlyBoundDIBO;
+    size_t m_size;
+
+    DrawIndirectBuffer(const void* data, size_t size);
+
+public:
+    /**
+     * @brief Unbinds any currently bound draw indirect buffer.
+     */
+    static void bindDefault();
+    /**
+     * @brief Syncs the internal binding state with the current OpenGL binding.
+     *
+     * Should be used if the draw indirect binding is changed manually.
+     */
+    static void syncBinding();
+
+    /**
+     * @brief Creates a new draw indirect buffer.
+     *
+     * If `data` is `nullptr`, memory is allocated but not initialized.
+     *
+     * @param data Pointer to the initial commands, or nullptr.
+     * @param size Size of the buffer in bytes.
+     */
+    static DrawIndirectBuffer create(const void* data, size_t size);
+
+    /**
+     * @brief Constructs an uninitialized draw indirect buffer with id 0.
+     */
+    DrawIndirectBuffer() noexcept : m_size(0) {}
+    DrawIndirectBuffer(DrawIndirectBuffer&& other) noexcept;
+    virtual ~DrawIndirectBuffer();
+
+    /**
+     * @brief Updates a portion of the buffer with new commands.
+     *
+     * @param data Pointer to the source data.
+     * @param size Size of the data in bytes.
+     * @param offset Byte offset in the buffer where data should be written.
+     *
+     * @throws std::runtime_error If the update exceeds the allocated buffer size.
+     * @throws std::runtime_error If the buffer ID is 0 (uninitialized or moved-from).
+     */
+    void updateData(const void* data, size_t size, size_t offset = 0) const;
+
+    /**
+     * @brief Binds the buffer to GL_DRAW_INDIRECT_BUFFER if not already bound.
+     *
+     * @throws std::runtime_error If the buffer ID is 0 (uninitialized or moved-from).
+     */
+    void bind() const;
+
+    /** @return The total size of the buffer in bytes. */
+    inline size_t getByteSize() const { return m_size; }
+
+    DrawIndirectBuffer& operator=(DrawIndirectBuffer&& other) noexcept;
+};
+
+#endif
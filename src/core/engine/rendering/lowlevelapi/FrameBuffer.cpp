@@ -6,6 +6,7 @@
 
 #include "Logger.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 thread_local unsigned int FrameBuffer::currentlyBoundFBO = 0;
 
@@ -32,6 +33,9 @@ void FrameBuffer::bindDefault() {
     if (FrameBuffer::currentlyBoundFBO != 0) {
         GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
         FrameBuffer::currentlyBoundFBO = 0;
+        GLStateCache::countIssued();
+    } else {
+        GLStateCache::countElided();
     }
 }
 
@@ -72,6 +76,9 @@ void FrameBuffer::bind() const {
     if (FrameBuffer::currentlyBoundFBO != m_rendererId) {
         GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, m_rendererId));
         FrameBuffer::currentlyBoundFBO = m_rendererId;
+        GLStateCache::countIssued();
+    } else {
+        GLStateCache::countElided();
     }
 }
 
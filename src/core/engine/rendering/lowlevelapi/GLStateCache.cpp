@@ -0,0 +1,169 @@
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include "engine/rendering/GLUtils.h"
+
+thread_local GLStateCache::State GLStateCache::current = {
+    {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN},
+    UNKNOWN,
+    UNKNOWN,
+    UNKNOWN,
+    UNKNOWN,
+    {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN},
+    {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN},
+    {}
+};
+thread_local int GLStateCache::elidedCalls = 0;
+thread_local int GLStateCache::issuedCalls = 0;
+
+// Compares and updates one cached value, returns true if the state has to be issued
+static inline bool changeState(int& cached, int value) {
+    if (cached == value) return false;
+    cached = value;
+    return true;
+}
+
+static inline bool changeRect(int* cached, int x, int y, int width, int height) {
+    if (cached[0] == x && cached[1] == y && cached[2] == width && cached[3] == height) return false;
+    cached[0] = x;
+    cached[1] = y;
+    cached[2] = width;
+    cached[3] = height;
+    return true;
+}
+
+void GLStateCache::setCapability(Capability capability, unsigned int glCapability, bool enabled) {
+    if (!changeState(current.capabilities[capability], enabled ? 1 : 0)) {
+        elidedCalls++;
+        return;
+    }
+
+    if (enabled) {
+        GLCALL(glEnable(glCapability));
+    } else {
+        GLCALL(glDisable(glCapability));
+    }
+    issuedCalls++;
+}
+
+void GLStateCache::invalidate() {
+    for (int& capability : current.capabilities) capability = UNKNOWN;
+    current.depthMask = UNKNOWN;
+    current.cullFace = UNKNOWN;
+    current.frontFace = UNKNOWN;
+    current.polygonMode = UNKNOWN;
+    for (int& value : current.viewport) value = UNKNOWN;
+    for (int& value : current.scissor) value = UNKNOWN;
+    for (BlendState& blend : current.blend) blend = {UNKNOWN, UNKNOWN, UNKNOWN};
+}
+
+void GLStateCache::setBlend(bool enabled) { setCapability(Blend, GL_BLEND, enabled); }
+
+void GLStateCache::setDepthTest(bool enabled) { setCapability(DepthTest, GL_DEPTH_TEST, enabled); }
+
+void GLStateCache::setCullFaceEnabled(bool enabled) { setCapability(CullFace, GL_CULL_FACE, enabled); }
+
+void GLStateCache::setRasterizerDiscard(bool enabled) {
+    setCapability(RasterizerDiscard, GL_RASTERIZER_DISCARD, enabled);
+}
+
+void GLStateCache::setScissorTest(bool enabled) { setCapability(ScissorTest, GL_SCISSOR_TEST, enabled); }
+
+void GLStateCache::setDepthMask(bool enabled) {
+    if (!changeState(current.depthMask, enabled ? 1 : 0)) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+    issuedCalls++;
+}
+
+void GLStateCache::setCullFace(unsigned int mode) {
+    if (!changeState(current.cullFace, static_cast<int>(mode))) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glCullFace(mode));
+    issuedCalls++;
+}
+
+void GLStateCache::setFrontFace(unsigned int mode) {
+    if (!changeState(current.frontFace, static_cast<int>(mode))) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glFrontFace(mode));
+    issuedCalls++;
+}
+
+void GLStateCache::setPolygonMode(unsigned int mode) {
+    if (!changeState(current.polygonMode, static_cast<int>(mode))) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glPolygonMode(GL_FRONT_AND_BACK, mode));
+    issuedCalls++;
+}
+
+void GLStateCache::setViewport(int x, int y, int width, int height) {
+    if (!changeRect(current.viewport, x, y, width, height)) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glViewport(x, y, width, height));
+    issuedCalls++;
+}
+
+void GLStateCache::setScissor(int x, int y, int width, int height) {
+    if (!changeRect(current.scissor, x, y, width, height)) {
+        elidedCalls++;
+        return;
+    }
+
+    GLCALL(glScissor(x, y, width, height));
+    issuedCalls++;
+}
+
+void GLStateCache::setBlendForBuffer(
+    unsigned int buffer, unsigned int equation, unsigned int srcFactor, unsigned int dstFactor
+) {
+    if (buffer >= MAX_BLEND_BUFFERS) {
+        // Not tracked, always issue
+        GLCALL(glBlendEquationi(buffer, equation));
+        GLCALL(glBlendFunci(buffer, srcFactor, dstFactor));
+        issuedCalls += 2;
+        return;
+    }
+
+    BlendState& blend = current.blend[buffer];
+    if (changeState(blend.equation, static_cast<int>(equation))) {
+        GLCALL(glBlendEquationi(buffer, equation));
+        issuedCalls++;
+    } else {
+        elidedCalls++;
+    }
+
+    int src = static_cast<int>(srcFactor);
+    int dst = static_cast<int>(dstFactor);
+    if (blend.srcFactor != src || blend.dstFactor != dst) {
+        blend.srcFactor = src;
+        blend.dstFactor = dst;
+        GLCALL(glBlendFunci(buffer, srcFactor, dstFactor));
+        issuedCalls++;
+    } else {
+        elidedCalls++;
+    }
+}
+
+void GLStateCache::takeCallCounts(int& elided, int& issued) {
+    elided = elidedCalls;
+    issued = issuedCalls;
+    elidedCalls = 0;
+    issuedCalls = 0;
+}
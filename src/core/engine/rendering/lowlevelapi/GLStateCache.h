@@ -0,0 +1,96 @@
+#ifndef TOOMANYBLOCKS_GLSTATECACHE_H
+#define TOOMANYBLOCKS_GLSTATECACHE_H
+
+/**
+ * @brief Shadows fixed function OpenGL state to skip redundant state changes.
+ *
+ * Covers capabilities (blend, depth test, cull face, rasterizer discard, scissor test), depth mask, cull face,
+ * front face, polygon mode, viewport, scissor box and per draw buffer blend state. Program, vertex array and
+ * framebuffer bindings are cached by their wrappers, which report skipped binds here, so all elided calls are counted in one place.
+ *
+ * State changed by anything bypassing this cache (e.g. the ui renderer) requires a call to invalidate().
+ */
+class GLStateCache {
+private:
+    static constexpr int MAX_BLEND_BUFFERS = 8;
+    static constexpr int UNKNOWN = -1;
+
+    enum Capability {
+        Blend,
+        DepthTest,
+        CullFace,
+        RasterizerDiscard,
+        ScissorTest,
+        CapabilityCount
+    };
+
+    struct BlendState {
+        int equation;
+        int srcFactor;
+        int dstFactor;
+    };
+
+    struct State {
+        int capabilities[CapabilityCount];
+        int depthMask;
+        int cullFace;
+        int frontFace;
+        int polygonMode;
+        int viewport[4];
+        int scissor[4];
+        BlendState blend[MAX_BLEND_BUFFERS];
+    };
+
+    static thread_local State current;
+    static thread_local int elidedCalls;
+    static thread_local int issuedCalls;
+
+    static void setCapability(Capability capability, unsigned int glCapability, bool enabled);
+
+public:
+    /**
+     * @brief Forgets all cached state, so the next change of every state is issued to OpenGL.
+     */
+    static void invalidate();
+
+    static void setBlend(bool enabled);
+    static void setDepthTest(bool enabled);
+    static void setCullFaceEnabled(bool enabled);
+    static void setRasterizerDiscard(bool enabled);
+    static void setScissorTest(bool enabled);
+
+    static void setDepthMask(bool enabled);
+    static void setCullFace(unsigned int mode);
+    static void setFrontFace(unsigned int mode);
+
+    /** @brief Sets the polygon mode for front and back faces. */
+    static void setPolygonMode(unsigned int mode);
+
+    static void setViewport(int x, int y, int width, int height);
+    static void setScissor(int x, int y, int width, int height);
+
+    /**
+     * @brief Sets blend equation and factors of a single draw buffer.
+     *
+     * @param buffer Index of the draw buffer.
+     * @param equation Blend equation, e.g. GL_FUNC_ADD.
+     * @param srcFactor Source blend factor.
+     * @param dstFactor Destination blend factor.
+     */
+    static void setBlendForBuffer(
+        unsigned int buffer, unsigned int equation, unsigned int srcFactor, unsigned int dstFactor
+    );
+
+    /** @brief Counts a state change skipped by one of the binding caches of the wrappers. */
+    static inline void countElided() { elidedCalls++; }
+
+    /** @brief Counts a state change issued by one of the binding caches of the wrappers. */
+    static inline void countIssued() { issuedCalls++; }
+
+    /**
+     * @brief Returns the number of skipped and issued state changes since the last call and resets them.
+     */
+    static void takeCallCounts(int& elided, int& issued);
+};
+
+#endif
@@ -10,9 +10,27 @@
 
 #include "Logger.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 #include "foundation/util/Utility.h"
 
 thread_local unsigned int Shader::currentlyUsedShader = 0;
+static thread_local unsigned int runtimeUniformNameCount = 0;
+
+UniformName::UniformName(const std::string& name)
+    : m_hash(hashChars(FNV_OFFSET_BASIS, name.c_str())), m_name(name.c_str()), m_index(-1) {
+    runtimeUniformNameCount++;
+}
+
+std::string UniformName::str() const {
+    if (m_index < 0) return m_name;
+    return std::string(m_name) + "[" + std::to_string(m_index) + "]";
+}
+
+unsigned int UniformName::takeRuntimeStringCount() {
+    unsigned int count = runtimeUniformNameCount;
+    runtimeUniformNameCount = 0;
+    return count;
+}
 
 static unsigned int compileShader(unsigned int type, const std::string& source, const ShaderDefines& definitions) {
     const char* src = nullptr;
@@ -74,55 +92,96 @@ static unsigned int compileShader(unsigned int type, const std::string& source,
     return id;
 }
 
-int Shader::getUniformLocation(const std::string& name) {
-    auto it = m_uniformLocationCache.find(name);
+int Shader::getUniformLocation(const UniformName& name) {
+    auto it = m_uniformLocationCache.find(name.hash());
     if (it != m_uniformLocationCache.end()) {
         return it->second;
     }
 
-    GLCALL(int location = glGetUniformLocation(m_rendererId, name.c_str()));
+    // Active uniforms are reflected on link, so this is only reached once per unknown name
+    std::string nameStr = name.str();
+    GLCALL(int location = glGetUniformLocation(m_rendererId, nameStr.c_str()));
     if (location == -1) {  // -1 is not found / can happen for unused uniforms also
-        lgr::lout.warn("Warning: location of '" + std::string(name) + "' uniform was not found!");
+        lgr::lout.warn("Warning: location of '" + nameStr + "' uniform was not found!");
     }
 
-    m_uniformLocationCache[name] = location;
+    m_uniformLocationCache[name.hash()] = location;
     return location;
 }
 
-Shader::BlockBindInfo Shader::getUBOBindInfo(const std::string& name) {
-    auto it = m_uboBindingCache.find(name);
+Shader::BlockBindInfo Shader::getUBOBindInfo(const UniformName& name) {
+    auto it = m_uboBindingCache.find(name.hash());
     if (it != m_uboBindingCache.end()) {
         return it->second;
     }
 
-    GLCALL(unsigned int blockIndex = glGetUniformBlockIndex(m_rendererId, name.c_str()));
+    std::string nameStr = name.str();
+    GLCALL(unsigned int blockIndex = glGetUniformBlockIndex(m_rendererId, nameStr.c_str()));
     if (blockIndex == GL_INVALID_INDEX) {
-        lgr::lout.warn("Warning: Index of '" + std::string(name) + "' uniform buffer was invalid!");
+        lgr::lout.warn("Warning: Index of '" + nameStr + "' uniform buffer was invalid!");
     }
 
     // Dymanically assign next available binding point, caller does not need to manage this.
     BlockBindInfo info = {blockIndex, m_nextUBOBindingPoint++};  // Binding point space of ubos differs from ssbos
-    m_uboBindingCache[name] = info;
+    m_uboBindingCache[name.hash()] = info;
     return info;
 }
 
-Shader::BlockBindInfo Shader::getSSBOBindInfo(const std::string& name) {
-    auto it = m_ssboBindingCache.find(name);
+Shader::BlockBindInfo Shader::getSSBOBindInfo(const UniformName& name) {
+    auto it = m_ssboBindingCache.find(name.hash());
     if (it != m_ssboBindingCache.end()) {
         return it->second;
     }
 
-    GLCALL(unsigned int blockIndex = glGetProgramResourceIndex(m_rendererId, GL_SHADER_STORAGE_BLOCK, name.c_str()));
+    std::string nameStr = name.str();
+    GLCALL(unsigned int blockIndex = glGetProgramResourceIndex(m_rendererId, GL_SHADER_STORAGE_BLOCK, nameStr.c_str()));
     if (blockIndex == GL_INVALID_INDEX) {
-        lgr::lout.warn("Warning: Index of '" + std::string(name) + "' uniform buffer was invalid!");
+        lgr::lout.warn("Warning: Index of '" + nameStr + "' uniform buffer was invalid!");
     }
 
     // Dymanically assign next available binding point, caller does not need to manage this.
     BlockBindInfo info = {blockIndex, m_nextSSBOBindingPoint++};  // Binding point space of ubos differs from ssbos
-    m_ssboBindingCache[name] = info;
+    m_ssboBindingCache[name.hash()] = info;
     return info;
 }
 
+void Shader::reflectUniforms() {
+    int uniformCount = 0;
+    int maxNameLength = 0;
+    GLCALL(glGetProgramiv(m_rendererId, GL_ACTIVE_UNIFORMS, &uniformCount));
+    GLCALL(glGetProgramiv(m_rendererId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+
+    std::vector<char> nameBuffer(static_cast<size_t>(maxNameLength) + 1);
+    for (int i = 0; i < uniformCount; i++) {
+        int nameLength = 0;
+        int arraySize = 0;
+        unsigned int type = 0;
+        GLCALL(glGetActiveUniform(
+            m_rendererId, i, static_cast<int>(nameBuffer.size()), &nameLength, &arraySize, &type, nameBuffer.data()
+        ));
+        std::string name(nameBuffer.data(), nameLength);
+
+        // Arrays are reported by their first element
+        bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+        if (isArray) name.resize(name.size() - 3);
+
+        GLCALL(int location = glGetUniformLocation(m_rendererId, name.c_str()));
+        if (location == -1) continue;  // Members of uniform blocks have no location
+
+        UniformName uniformName(name.c_str());
+        if (m_uniformLocationCache.count(uniformName.hash())) {
+            lgr::lout.warn("Warning: hash of uniform '" + name + "' collides with another uniform!");
+        }
+        m_uniformLocationCache[uniformName.hash()] = location;
+
+        for (int element = 0; isArray && element < arraySize; element++) {
+            std::string elementName = uniformName[element].str();
+            GLCALL(int elementLocation = glGetUniformLocation(m_rendererId, elementName.c_str()));
+            m_uniformLocationCache[uniformName[element].hash()] = elementLocation;
+        }
+    }
+}
+
 void Shader::link() {
     GLCALL(glLinkProgram(m_rendererId));
 
@@ -139,6 +198,8 @@ void Shader::link() {
             lgr::lout.error(ostream.str());
             delete[] infoLog;
         }
+    } else {
+        reflectUniforms();
     }
 
     GLCALL(glValidateProgram(m_rendererId));
@@ -218,191 +279,167 @@ void Shader::use() const {
     if (Shader::currentlyUsedShader != m_rendererId) {
         GLCALL(glUseProgram(m_rendererId));
         Shader::currentlyUsedShader = m_rendererId;
+        GLStateCache::countIssued();
+    } else {
+        GLStateCache::countElided();
     }
 }
 
-void Shader::bindUniformBuffer(const std::string& name, const UniformBuffer& ubo) {
+void Shader::bindUniformBuffer(const UniformName& name, const UniformBuffer& ubo) {
     use();
     BlockBindInfo bindInfo = getUBOBindInfo(name);
     ubo.assignTo(bindInfo.bindingPoint);
     GLCALL(glUniformBlockBinding(m_rendererId, bindInfo.blockIndex, bindInfo.bindingPoint));
 }
 
-void Shader::bindShaderStorageBuffer(const std::string& name, const ShaderStorageBuffer& ssbo) {
+void Shader::bindUniformBufferRange(const UniformName& name, const UniformBufferRange& range) {
+    use();
+    BlockBindInfo bindInfo = getUBOBindInfo(name);
+    UniformBuffer::assignRangeTo(bindInfo.bindingPoint, range);
+    GLCALL(glUniformBlockBinding(m_rendererId, bindInfo.blockIndex, bindInfo.bindingPoint));
+}
+
+void Shader::bindShaderStorageBuffer(const UniformName& name, const ShaderStorageBuffer& ssbo) {
     use();
     BlockBindInfo bindInfo = getSSBOBindInfo(name);
     ssbo.assignTo(bindInfo.bindingPoint);
     GLCALL(glShaderStorageBlockBinding(m_rendererId, bindInfo.blockIndex, bindInfo.bindingPoint));
 }
 
-void Shader::setUniform(const std::string& name, bool value) {
-    use();
-    GLCALL(glUniform1i(getUniformLocation(name), value));
+void Shader::uploadUniform(int location, bool value) {
+    GLCALL(glUniform1i(location, value));
 }
 
-void Shader::setUniform(const std::string& name, int value) {
-    use();
-    GLCALL(glUniform1i(getUniformLocation(name), value));
+void Shader::uploadUniform(int location, int value) {
+    GLCALL(glUniform1i(location, value));
 }
 
-void Shader::setUniform(const std::string& name, unsigned int value) {
-    use();
-    GLCALL(glUniform1ui(getUniformLocation(name), value));
+void Shader::uploadUniform(int location, unsigned int value) {
+    GLCALL(glUniform1ui(location, value));
 }
 
-void Shader::setUniform(const std::string& name, float value) {
-    use();
-    GLCALL(glUniform1f(getUniformLocation(name), value));
+void Shader::uploadUniform(int location, float value) {
+    GLCALL(glUniform1f(location, value));
 }
 
-void Shader::setUniform(const std::string& name, const glm::bvec2& vector) {
-    use();
-    GLCALL(glUniform2i(getUniformLocation(name), vector.x, vector.y));
+void Shader::uploadUniform(int location, const glm::bvec2& vector) {
+    GLCALL(glUniform2i(location, vector.x, vector.y));
 }
 
-void Shader::setUniform(const std::string& name, const glm::bvec3& vector) {
-    use();
-    GLCALL(glUniform3i(getUniformLocation(name), vector.x, vector.y, vector.z));
+void Shader::uploadUniform(int location, const glm::bvec3& vector) {
+    GLCALL(glUniform3i(location, vector.x, vector.y, vector.z));
 }
 
-void Shader::setUniform(const std::string& name, const glm::bvec4& vector) {
-    use();
-    GLCALL(glUniform4i(getUniformLocation(name), vector.x, vector.y, vector.z, vector.w));
+void Shader::uploadUniform(int location, const glm::bvec4& vector) {
+    GLCALL(glUniform4i(location, vector.x, vector.y, vector.z, vector.w));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec2& vector) {
-    use();
-    GLCALL(glUniform2f(getUniformLocation(name), vector.x, vector.y));
+void Shader::uploadUniform(int location, const glm::vec2& vector) {
+    GLCALL(glUniform2f(location, vector.x, vector.y));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec3& vector) {
-    use();
-    GLCALL(glUniform3f(getUniformLocation(name), vector.x, vector.y, vector.z));
+void Shader::uploadUniform(int location, const glm::vec3& vector) {
+    GLCALL(glUniform3f(location, vector.x, vector.y, vector.z));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec4& vector) {
-    use();
-    GLCALL(glUniform4f(getUniformLocation(name), vector.x, vector.y, vector.z, vector.w));
+void Shader::uploadUniform(int location, const glm::vec4& vector) {
+    GLCALL(glUniform4f(location, vector.x, vector.y, vector.z, vector.w));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec2& vector) {
-    use();
-    GLCALL(glUniform2i(getUniformLocation(name), vector.x, vector.y));
+void Shader::uploadUniform(int location, const glm::ivec2& vector) {
+    GLCALL(glUniform2i(location, vector.x, vector.y));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec3& vector) {
-    use();
-    GLCALL(glUniform3i(getUniformLocation(name), vector.x, vector.y, vector.z));
+void Shader::uploadUniform(int location, const glm::ivec3& vector) {
+    GLCALL(glUniform3i(location, vector.x, vector.y, vector.z));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec4& vector) {
-    use();
-    GLCALL(glUniform4i(getUniformLocation(name), vector.x, vector.y, vector.z, vector.w));
+void Shader::uploadUniform(int location, const glm::ivec4& vector) {
+    GLCALL(glUniform4i(location, vector.x, vector.y, vector.z, vector.w));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec2& vector) {
-    use();
-    GLCALL(glUniform2ui(getUniformLocation(name), vector.x, vector.y));
+void Shader::uploadUniform(int location, const glm::uvec2& vector) {
+    GLCALL(glUniform2ui(location, vector.x, vector.y));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec3& vector) {
-    use();
-    GLCALL(glUniform3ui(getUniformLocation(name), vector.x, vector.y, vector.z));
+void Shader::uploadUniform(int location, const glm::uvec3& vector) {
+    GLCALL(glUniform3ui(location, vector.x, vector.y, vector.z));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec4& vector) {
-    use();
-    GLCALL(glUniform4ui(getUniformLocation(name), vector.x, vector.y, vector.z, vector.w));
+void Shader::uploadUniform(int location, const glm::uvec4& vector) {
+    GLCALL(glUniform4ui(location, vector.x, vector.y, vector.z, vector.w));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat2& matrix) {
-    use();
-    GLCALL(glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix)));
+void Shader::uploadUniform(int location, const glm::mat2& matrix) {
+    GLCALL(glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(matrix)));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat3& matrix) {
-    use();
-    GLCALL(glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix)));
+void Shader::uploadUniform(int location, const glm::mat3& matrix) {
+    GLCALL(glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(matrix)));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat4& matrix) {
-    use();
-    GLCALL(glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix)));
+void Shader::uploadUniform(int location, const glm::mat4& matrix) {
+    GLCALL(glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix)));
 }
 
-void Shader::setUniform(const std::string& name, const int* values, size_t count) {
-    use();
-    GLCALL(glUniform1iv(getUniformLocation(name), count, values));
+void Shader::uploadUniform(int location, const int* values, size_t count) {
+    GLCALL(glUniform1iv(location, count, values));
 }
 
-void Shader::setUniform(const std::string& name, const unsigned int* values, size_t count) {
-    use();
-    GLCALL(glUniform1uiv(getUniformLocation(name), count, values));
+void Shader::uploadUniform(int location, const unsigned int* values, size_t count) {
+    GLCALL(glUniform1uiv(location, count, values));
 }
 
-void Shader::setUniform(const std::string& name, const float* values, size_t count) {
-    use();
-    GLCALL(glUniform1fv(getUniformLocation(name), count, values));
+void Shader::uploadUniform(int location, const float* values, size_t count) {
+    GLCALL(glUniform1fv(location, count, values));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec2* vectors, size_t count) {
-    use();
-    GLCALL(glUniform2fv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::vec2* vectors, size_t count) {
+    GLCALL(glUniform2fv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec3* vectors, size_t count) {
-    use();
-    GLCALL(glUniform3fv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::vec3* vectors, size_t count) {
+    GLCALL(glUniform3fv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::vec4* vectors, size_t count) {
-    use();
-    GLCALL(glUniform4fv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::vec4* vectors, size_t count) {
+    GLCALL(glUniform4fv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec2* vectors, size_t count) {
-    use();
-    GLCALL(glUniform2iv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::ivec2* vectors, size_t count) {
+    GLCALL(glUniform2iv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec3* vectors, size_t count) {
-    use();
-    GLCALL(glUniform3iv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::ivec3* vectors, size_t count) {
+    GLCALL(glUniform3iv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::ivec4* vectors, size_t count) {
-    use();
-    GLCALL(glUniform4iv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::ivec4* vectors, size_t count) {
+    GLCALL(glUniform4iv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec2* vectors, size_t count) {
-    use();
-    GLCALL(glUniform2uiv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::uvec2* vectors, size_t count) {
+    GLCALL(glUniform2uiv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec3* vectors, size_t count) {
-    use();
-    GLCALL(glUniform3uiv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::uvec3* vectors, size_t count) {
+    GLCALL(glUniform3uiv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::uvec4* vectors, size_t count) {
-    use();
-    GLCALL(glUniform4uiv(getUniformLocation(name), count, glm::value_ptr(vectors[0])));
+void Shader::uploadUniform(int location, const glm::uvec4* vectors, size_t count) {
+    GLCALL(glUniform4uiv(location, count, glm::value_ptr(vectors[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat2* matrices, size_t count) {
-    use();
-    GLCALL(glUniformMatrix2fv(getUniformLocation(name), count, GL_FALSE, glm::value_ptr(matrices[0])));
+void Shader::uploadUniform(int location, const glm::mat2* matrices, size_t count) {
+    GLCALL(glUniformMatrix2fv(location, count, GL_FALSE, glm::value_ptr(matrices[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat3* matrices, size_t count) {
-    use();
-    GLCALL(glUniformMatrix3fv(getUniformLocation(name), count, GL_FALSE, glm::value_ptr(matrices[0])));
+void Shader::uploadUniform(int location, const glm::mat3* matrices, size_t count) {
+    GLCALL(glUniformMatrix3fv(location, count, GL_FALSE, glm::value_ptr(matrices[0])));
 }
 
-void Shader::setUniform(const std::string& name, const glm::mat4* matrices, size_t count) {
-    use();
-    GLCALL(glUniformMatrix4fv(getUniformLocation(name), count, GL_FALSE, glm::value_ptr(matrices[0])));
+void Shader::uploadUniform(int location, const glm::mat4* matrices, size_t count) {
+    GLCALL(glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(matrices[0])));
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept {
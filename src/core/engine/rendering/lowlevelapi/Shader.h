@@ -1,6 +1,9 @@
 #ifndef TOOMANYBLOCKS_SHADER_H
 #define TOOMANYBLOCKS_SHADER_H
 
+#include <stddef.h>
+
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <string>
 #include <unordered_map>
@@ -20,10 +23,75 @@ public:
     inline const std::unordered_map<std::string, std::string>& definitions() const { return m_defines; }
 };
 
+/**
+ * @brief Name of a uniform variable or block, identified by its FNV-1a hash.
+ *
+ * Names built from literals are hashed at compile time when declared constexpr, so looking up a location never
+ * builds or hashes strings. Array elements are addressed with operator[], which continues the hash over "[i]".
+ * A name only references the characters it was created from, so it must not outlive them.
+ */
+class UniformName {
+private:
+    static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+
+    uint32_t m_hash;
+    const char* m_name;
+    int m_index;  // Array element index, -1 if the name is no array element
+
+    static constexpr uint32_t hashChar(uint32_t hash, char c) {
+        return (hash ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+    }
+
+    static constexpr uint32_t hashChars(uint32_t hash, const char* str) {
+        while (*str) hash = hashChar(hash, *str++);
+        return hash;
+    }
+
+    static constexpr uint32_t hashIndex(uint32_t hash, unsigned int index) {
+        unsigned int divisor = 1;
+        while (index / divisor >= 10) divisor *= 10;
+
+        hash = hashChar(hash, '[');
+        for (; divisor > 0; divisor /= 10) hash = hashChar(hash, static_cast<char>('0' + index / divisor % 10));
+        return hashChar(hash, ']');
+    }
+
+    constexpr UniformName(uint32_t hash, const char* name, int index) : m_hash(hash), m_name(name), m_index(index) {}
+
+public:
+    constexpr UniformName(const char* name) : m_hash(hashChars(FNV_OFFSET_BASIS, name)), m_name(name), m_index(-1) {}
+
+    /**
+     * @brief Hashes a runtime string, every use is counted so remaining string built names show up in stats.
+     */
+    UniformName(const std::string& name);
+
+    /**
+     * @return Name of the array element at index, e.g. "u_array[2]" for "u_array".
+     */
+    constexpr UniformName operator[](unsigned int index) const {
+        return UniformName(hashIndex(m_hash, index), m_name, static_cast<int>(index));
+    }
+
+    constexpr uint32_t hash() const { return m_hash; }
+
+    /**
+     * @brief Builds the full name as string, only used when a location has to be queried or reported.
+     */
+    std::string str() const;
+
+    /**
+     * @return Number of uniform names created from runtime strings on the current thread since the last call.
+     */
+    static unsigned int takeRuntimeStringCount();
+};
+
 /**
  * @brief Wrapper for OpenGL Shader programs.
  *
- * Exposes setters for uniform variables and UBOs and SSBOs.
+ * Exposes setters for uniform variables and UBOs and SSBOs. All active uniforms are reflected when the program
+ * is linked, so setting a uniform resolves its location with a single hash lookup.
  */
 class Shader : public RenderApiObject {
 private:
@@ -38,9 +106,10 @@ protected:
     static thread_local unsigned int currentlyUsedShader;
     unsigned int m_nextUBOBindingPoint;
     unsigned int m_nextSSBOBindingPoint;
-    std::unordered_map<std::string, int> m_uniformLocationCache;
-    std::unordered_map<std::string, BlockBindInfo> m_uboBindingCache;
-    std::unordered_map<std::string, BlockBindInfo> m_ssboBindingCache;
+    // All caches are keyed by the hash of the name, see UniformName
+    std::unordered_map<uint32_t, int> m_uniformLocationCache;
+    std::unordered_map<uint32_t, BlockBindInfo> m_uboBindingCache;
+    std::unordered_map<uint32_t, BlockBindInfo> m_ssboBindingCache;
 
     /**
      * @brief Retrieves the location of a uniform variable by name.
@@ -48,27 +117,68 @@ protected:
      * @param name The name of the uniform variable.
      * @return The location of the uniform, or -1 if not found (Is cached).
      */
-    int getUniformLocation(const std::string& name);
+    int getUniformLocation(const UniformName& name);
     /**
      * @brief Retrieves index and binding point of a uniform block (UBO) by name.
      *
      * @param name The name of the uniform block in the shader.
      * @return Struct containing the block index and assigned binding point (Is cached).
      */
-    BlockBindInfo getUBOBindInfo(const std::string& name);
+    BlockBindInfo getUBOBindInfo(const UniformName& name);
     /**
      * @brief Retrieves index and binding point of a shader storage block (SSBO) by name.
      *
      * @param name The name of the shader storage block in the shader.
      * @return Struct containing the block index and assigned binding point (Is cached).
      */
-    BlockBindInfo getSSBOBindInfo(const std::string& name);
+    BlockBindInfo getSSBOBindInfo(const UniformName& name);
+
+    /**
+     * @brief Caches the locations of all active uniforms and of every element of uniform arrays.
+     */
+    void reflectUniforms();
 
     /**
      * @brief Final initilization step, internally links the program and cleans up shader refrences.
      */
     void link();
 
+    static void uploadUniform(int location, bool value);
+    static void uploadUniform(int location, int value);
+    static void uploadUniform(int location, unsigned int value);
+    static void uploadUniform(int location, float value);
+    static void uploadUniform(int location, const glm::bvec2& vector);
+    static void uploadUniform(int location, const glm::bvec3& vector);
+    static void uploadUniform(int location, const glm::bvec4& vector);
+    static void uploadUniform(int location, const glm::vec2& vector);
+    static void uploadUniform(int location, const glm::vec3& vector);
+    static void uploadUniform(int location, const glm::vec4& vector);
+    static void uploadUniform(int location, const glm::ivec2& vector);
+    static void uploadUniform(int location, const glm::ivec3& vector);
+    static void uploadUniform(int location, const glm::ivec4& vector);
+    static void uploadUniform(int location, const glm::uvec2& vector);
+    static void uploadUniform(int location, const glm::uvec3& vector);
+    static void uploadUniform(int location, const glm::uvec4& vector);
+    static void uploadUniform(int location, const glm::mat2& matrix);
+    static void uploadUniform(int location, const glm::mat3& matrix);
+    static void uploadUniform(int location, const glm::mat4& matrix);
+    // No bool vec arrays cause the would have to be converted to int array (to have int pointer, wich opengl expects)
+    static void uploadUniform(int location, const int* values, size_t count);
+    static void uploadUniform(int location, const unsigned int* values, size_t count);
+    static void uploadUniform(int location, const float* values, size_t count);
+    static void uploadUniform(int location, const glm::vec2* vectors, size_t count);
+    static void uploadUniform(int location, const glm::vec3* vectors, size_t count);
+    static void uploadUniform(int location, const glm::vec4* vectors, size_t count);
+    static void uploadUniform(int location, const glm::ivec2* vectors, size_t count);
+    static void uploadUniform(int location, const glm::ivec3* vectors, size_t count);
+    static void uploadUniform(int location, const glm::ivec4* vectors, size_t count);
+    static void uploadUniform(int location, const glm::uvec2* vectors, size_t count);
+    static void uploadUniform(int location, const glm::uvec3* vectors, size_t count);
+    static void uploadUniform(int location, const glm::uvec4* vectors, size_t count);
+    static void uploadUniform(int location, const glm::mat2* matrices, size_t count);
+    static void uploadUniform(int location, const glm::mat3* matrices, size_t count);
+    static void uploadUniform(int location, const glm::mat4* matrices, size_t count);
+
     Shader(
         const std::unordered_map<unsigned int, std::string>& shaderTypeAndSource,
         const ShaderDefines& defines,
@@ -110,45 +220,27 @@ public:
      */
     void use() const;
 
-    void bindUniformBuffer(const std::string& name, const UniformBuffer& ubo);
-
-    void bindShaderStorageBuffer(const std::string& name, const ShaderStorageBuffer& ssbo);
-
-    void setUniform(const std::string& name, bool value);
-    void setUniform(const std::string& name, int value);
-    void setUniform(const std::string& name, unsigned int value);
-    void setUniform(const std::string& name, float value);
-    void setUniform(const std::string& name, const glm::bvec2& vector);
-    void setUniform(const std::string& name, const glm::bvec3& vector);
-    void setUniform(const std::string& name, const glm::bvec4& vector);
-    void setUniform(const std::string& name, const glm::vec2& vector);
-    void setUniform(const std::string& name, const glm::vec3& vector);
-    void setUniform(const std::string& name, const glm::vec4& vector);
-    void setUniform(const std::string& name, const glm::ivec2& vector);
-    void setUniform(const std::string& name, const glm::ivec3& vector);
-    void setUniform(const std::string& name, const glm::ivec4& vector);
-    void setUniform(const std::string& name, const glm::uvec2& vector);
-    void setUniform(const std::string& name, const glm::uvec3& vector);
-    void setUniform(const std::string& name, const glm::uvec4& vector);
-    void setUniform(const std::string& name, const glm::mat2& matrix);
-    void setUniform(const std::string& name, const glm::mat3& matrix);
-    void setUniform(const std::string& name, const glm::mat4& matrix);
-    // No bool vec arrays cause the would have to be converted to int array (to have int pointer, wich opengl expects)
-    void setUniform(const std::string& name, const int* values, size_t count);
-    void setUniform(const std::string& name, const unsigned int* values, size_t count);
-    void setUniform(const std::string& name, const float* values, size_t count);
-    void setUniform(const std::string& name, const glm::vec2* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::vec3* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::vec4* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::ivec2* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::ivec3* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::ivec4* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::uvec2* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::uvec3* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::uvec4* vectors, size_t count);
-    void setUniform(const std::string& name, const glm::mat2* matrices, size_t count);
-    void setUniform(const std::string& name, const glm::mat3* matrices, size_t count);
-    void setUniform(const std::string& name, const glm::mat4* matrices, size_t count);
+    void bindUniformBuffer(const UniformName& name, const UniformBuffer& ubo);
+
+    void bindShaderStorageBuffer(const UniformName& name, const ShaderStorageBuffer& ssbo);
+
+    /**
+     * @brief Backs a uniform block with a range of a buffer, e.g. constants streamed for a single draw.
+     *
+     * @throws std::runtime_error If the range is invalid.
+     */
+    void bindUniformBufferRange(const UniformName& name, const UniformBufferRange& range);
+
+    /**
+     * @brief Sets a uniform variable, accepts every value type (and array pointer with count) OpenGL supports.
+     *
+     * @param name The name of the uniform, use operator[] of UniformName to address array elements.
+     */
+    template <typename... Values>
+    void setUniform(const UniformName& name, const Values&... values) {
+        use();
+        uploadUniform(getUniformLocation(name), values...);
+    }
 
     Shader& operator=(Shader&& other) noexcept;
 };
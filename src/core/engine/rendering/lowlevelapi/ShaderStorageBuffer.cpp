@@ -111,7 +111,7 @@ ShaderStorageBuffer& ShaderStorageBuffer::operator=(ShaderStorageBuffer&& other)
             }
         }
 
-        m_rendererId = other.m_rendererId;
+        RenderApiObject::operator=(std::move(other));
         m_size = other.m_size;
     }
     return *this;
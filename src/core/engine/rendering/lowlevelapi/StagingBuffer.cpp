@@ -0,0 +1,76 @@
+#include "StagingBuffer.h"
+
+#include <GL/glew.h>
+
+#include <stdexcept>
+
+#include "Logger.h"
+#include "engine/rendering/GLUtils.h"
+
+static constexpr GLbitfield STAGING_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+StagingBuffer::StagingBuffer(size_t size) : m_mapped(nullptr), m_size(size) {
+    GLCALL(glGenBuffers(1, &m_rendererId));
+    GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_rendererId));
+    GLCALL(glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, STAGING_MAP_FLAGS));
+    GLCALL(m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, STAGING_MAP_FLAGS)));
+
+    if (!m_mapped) {
+        GLCALL(glDeleteBuffers(1, &m_rendererId));
+        m_rendererId = 0;
+        throw std::runtime_error("Failed to persistently map staging buffer");
+    }
+}
+
+bool StagingBuffer::isSupported() { return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage; }
+
+StagingBuffer StagingBuffer::create(size_t size) {
+    if (!isSupported()) throw std::runtime_error("Persistent buffer mapping is not supported by this context");
+
+    return StagingBuffer(size);
+}
+
+StagingBuffer::StagingBuffer(StagingBuffer&& other) noexcept
+    : RenderApiObject(std::move(other)), m_mapped(other.m_mapped), m_size(other.m_size) {
+    other.m_mapped = nullptr;
+    other.m_size = 0;
+}
+
+StagingBuffer::~StagingBuffer() {
+    if (isValid()) {
+        try {
+            // Deleting a buffer implicitly unmaps it
+            GLCALL(glDeleteBuffers(1, &m_rendererId));
+        } catch (const std::exception&) {
+            lgr::lout.error("Error during StagingBuffer cleanup");
+        }
+    }
+}
+
+void StagingBuffer::copyToBuffer(unsigned int dstBufferId, size_t size, size_t srcOffset, size_t dstOffset) const {
+    if (!isValid()) throw std::runtime_error("Invalid state of StagingBuffer with id 0");
+    if (srcOffset + size > m_size) throw std::runtime_error("Staging buffer copy exceeds buffer size");
+
+    GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_rendererId));
+    GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, dstBufferId));
+
+    GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset, dstOffset, size));
+}
+
+StagingBuffer& StagingBuffer::operator=(StagingBuffer&& other) noexcept {
+    if (this != &other) {
+        if (isValid()) {
+            try {
+                GLCALL(glDeleteBuffers(1, &m_rendererId));
+            } catch (const std::exception&) {
+                lgr::lout.error("Error during StagingBuffer cleanup");
+            }
+        }
+        RenderApiObject::operator=(std::move(other));
+        m_mapped = other.m_mapped;
+        m_size = other.m_size;
+        other.m_mapped = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
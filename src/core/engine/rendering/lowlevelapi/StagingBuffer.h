@@ -0,0 +1,67 @@
+#ifndef TOOMANYBLOCKS_STAGINGBUFFER_H
+#define TOOMANYBLOCKS_STAGINGBUFFER_H
+
+#include <stddef.h>  // For size_t
+
+#include "engine/rendering/lowlevelapi/RenderApiObject.h"
+
+/**
+ * @brief Represents a persistently mapped OpenGL buffer used as an upload source.
+ *
+ * The buffer is created with immutable storage and stays mapped (write, persistent, coherent) for its
+ * whole lifetime. The mapped pointer may be written from any thread, but all OpenGL calls (creation,
+ * copies and destruction) must happen on the thread owning the context.
+ */
+class StagingBuffer : public RenderApiObject {
+private:
+    unsigned char* m_mapped;
+    size_t m_size;
+
+    StagingBuffer(size_t size);
+
+public:
+    /**
+     * @return True if the current context supports immutable, persistently mapped buffer storage
+     * (OpenGL 4.4 or ARB_buffer_storage).
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Creates a staging buffer and maps it persistently.
+     *
+     * @param size Size of the buffer in bytes.
+     *
+     * @throws std::runtime_error If persistent mapping is not supported or mapping the buffer failed.
+     */
+    static StagingBuffer create(size_t size);
+
+    /**
+     * @brief Constructs an uninitialized staging buffer with id 0.
+     */
+    StagingBuffer() noexcept : m_mapped(nullptr), m_size(0) {}
+    StagingBuffer(StagingBuffer&& other) noexcept;
+    virtual ~StagingBuffer();
+
+    /**
+     * @brief Issues a GPU side copy from this staging buffer into another buffer object.
+     *
+     * @param dstBufferId Renderer id of the destination buffer.
+     * @param size Size of the data to copy in bytes.
+     * @param srcOffset Byte offset in this buffer from which to start copying.
+     * @param dstOffset Byte offset in the destination buffer where data should be written.
+     *
+     * @throws std::runtime_error If the source region exceeds the buffer size.
+     * @throws std::runtime_error If the buffer ID is 0 (uninitialized or moved-from).
+     */
+    void copyToBuffer(unsigned int dstBufferId, size_t size, size_t srcOffset = 0, size_t dstOffset = 0) const;
+
+    /** @return Pointer to the start of the mapped memory, or nullptr if uninitialized. */
+    inline unsigned char* mappedData() const { return m_mapped; }
+
+    /** @return The total size of the buffer in bytes. */
+    inline size_t getByteSize() const { return m_size; }
+
+    StagingBuffer& operator=(StagingBuffer&& other) noexcept;
+};
+
+#endif
@@ -29,6 +29,14 @@ void UniformBuffer::syncBinding() {
     UniformBuffer::currentlyBoundUBO = static_cast<unsigned int>(binding);
 }
 
+void UniformBuffer::assignRangeTo(unsigned int bindingPoint, const UniformBufferRange& range) {
+    if (!range.isValid()) throw std::runtime_error("Invalid uniform buffer range with buffer id 0");
+
+    GLCALL(glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, range.bufferId, range.offset, range.size));
+    // Binding a range also binds the buffer to the generic binding point
+    UniformBuffer::currentlyBoundUBO = range.bufferId;
+}
+
 UniformBuffer UniformBuffer::create(const void* data, size_t size) { return UniformBuffer(data, size); }
 
 UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
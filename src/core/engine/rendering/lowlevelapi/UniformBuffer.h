@@ -5,6 +5,17 @@
 
 #include "engine/rendering/lowlevelapi/RenderApiObject.h"
 
+/**
+ * @brief A byte range of any buffer object that can back a uniform block.
+ */
+struct UniformBufferRange {
+    unsigned int bufferId = 0;
+    size_t offset = 0;
+    size_t size = 0;
+
+    inline bool isValid() const { return bufferId != 0; }
+};
+
 /**
  * @brief Represents an OpenGL Uniform Buffer Object (UBO).
  *
@@ -30,6 +41,16 @@ public:
      */
     static void syncBinding();
 
+    /**
+     * @brief Binds a range of a buffer to a global uniform buffer binding point for usage in shaders.
+     *
+     * @param bindingPoint Index in the block binding range.
+     * @param range The range to bind, its offset must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     *
+     * @throws std::runtime_error If the range is invalid.
+     */
+    static void assignRangeTo(unsigned int bindingPoint, const UniformBufferRange& range);
+
     /**
      * @brief Creates a new uniform buffer and uploads initial data.
      *
@@ -4,6 +4,7 @@
 
 #include "Logger.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 thread_local unsigned int VertexArray::currentlyBoundVAO = 0;
 
@@ -87,6 +88,9 @@ void VertexArray::bind() const {
     if (VertexArray::currentlyBoundVAO != m_rendererId) {
         GLCALL(glBindVertexArray(m_rendererId));
         VertexArray::currentlyBoundVAO = m_rendererId;
+        GLStateCache::countIssued();
+    } else {
+        GLStateCache::countElided();
     }
 }
 
@@ -2,24 +2,62 @@
 
 #include <GL/glew.h>
 
+#include <cassert>
 #include <sstream>
 
 #include "Logger.h"
 #include "engine/env/lights/Spotlight.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderScene.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/StaticMesh.h"
+
+// Array uniforms whose elements are set every frame, hashed at compile time
+static constexpr UniformName SHADOW_MAP_ATLAS("u_shadowMapAtlas");
+static constexpr UniformName SHADOW_MAP_ATLAS_SIZES("u_shadowMapAtlasSizes");
+
+Shader& ChunkMaterial::shaderForPass(PassType passType, ChunkMeshFormat format) {
+    ChunkShaderSet& shaders = m_shaders[static_cast<int>(format)];
+    switch (passType) {
+        case PassType::ShadowPass: return shaders.depth.value();
+        case PassType::AmbientOcclusion: return shaders.ssaoGBuff.value();
+        default: return shaders.main.value();
+    }
+}
 
 bool ChunkMaterial::isReady() const {
-    return m_mainShader.isReady() && m_depthShader.isReady() && m_ssaoGBuffShader.isReady() && m_textureAtlas.isReady();
+    for (const ChunkShaderSet& shaders : m_shaders) {
+        if (!shaders.isReady()) return false;
+    }
+    return m_textureAtlas.isReady();
 }
 
 bool ChunkMaterial::supportsPass(PassType passType) const {
     return passType == PassType::ShadowPass || passType == PassType::AmbientOcclusion || passType == PassType::OpaquePass;
 }
 
+unsigned int ChunkMaterial::shaderSortId(PassType passType) const {
+    // bindForPass() leaves the quad format shader in use
+    const ChunkShaderSet& shaders = m_shaders[static_cast<int>(ChunkMeshFormat::Quads)];
+    const Future<Shader>& shader = passType == PassType::ShadowPass       ? shaders.depth
+                                   : passType == PassType::AmbientOcclusion ? shaders.ssaoGBuff
+                                                                            : shaders.main;
+    return shader.isReady() ? shader.value().rendererId() : 0;
+}
+
+unsigned int ChunkMaterial::textureSortId() const {
+    return m_textureAtlas.isReady() ? m_textureAtlas.value().rendererId() : 0;
+}
+
 void ChunkMaterial::bindForPass(PassType passType, const RenderContext& context) {
+    // The shader of the format drawn last stays in use
+    bindShaderForPass(passType, ChunkMeshFormat::Quads, context);
+    bindShaderForPass(passType, ChunkMeshFormat::Vertices, context);
+}
+
+void ChunkMaterial::bindShaderForPass(PassType passType, ChunkMeshFormat format, const RenderContext& context) {
     if (passType == PassType::OpaquePass) {
-        Shader& mainShader = m_mainShader.value();
+        Shader& mainShader = shaderForPass(passType, format);
 
         mainShader.use();
         mainShader.setUniform("u_viewProjection", context.tInfo.viewProjection);
@@ -39,7 +77,16 @@ void ChunkMaterial::bindForPass(PassType passType, const RenderContext& context)
         mainShader.setUniform("u_lightCount", static_cast<int>(context.lInfo.activeLightsCount));
         mainShader.bindUniformBuffer("LightsBlock", *context.lInfo.lightBuff);
         mainShader.bindUniformBuffer("LightViewProjBlock", *context.lInfo.lightViewProjectionBuff);
+        mainShader.setUniform("u_lightClustersEnabled", context.lInfo.lightClustersEnabled);
+        if (context.lInfo.lightClustersEnabled) {
+            mainShader.bindShaderStorageBuffer("LightClusterBlock", *context.lInfo.lightClusterBuff);
+            mainShader.bindShaderStorageBuffer("LightIndexBlock", *context.lInfo.lightIndexBuff);
+            mainShader.setUniform("u_lightClusterDepthParams", context.lInfo.lightClusterDepthParams);
+            mainShader.setUniform("u_cameraForward", context.tInfo.viewportTransform.getForward());
+        }
 
+        // Lower ssao tiers are applied by the resolver
+        mainShader.setUniform("u_ssaoEnabled", context.ssaoInfo.output != nullptr);
         if (context.ssaoInfo.output) {
             context.ssaoInfo.output->bindToUnit(1);
             mainShader.setUniform("u_ssaoTexture", 1);
@@ -47,24 +94,23 @@ void ChunkMaterial::bindForPass(PassType passType, const RenderContext& context)
         mainShader.setUniform("u_screenResolution", context.currScreenRes);
 
         // Pass depth buffers for shadowmapping
-        for (int prio = 0; prio < LightPriority::Count; prio++) {
-            if (const Texture* shadowAtlas = context.lInfo.shadowMapAtlases[prio]) {
-                const std::string strPrio = std::to_string(prio);
-                shadowAtlas->bindToUnit(prio + 2);
-                mainShader.setUniform("u_shadowMapAtlas[" + strPrio + "]", prio + 2);
-                mainShader.setUniform("u_shadowMapAtlasSizes[" + strPrio + "]", shadowAtlas->width());
-                mainShader.setUniform("u_shadowMapSizes[" + strPrio + "]", context.lInfo.shadowMapSizes[prio]);
+        for (int page = 0; page < SHADOW_ATLAS_PAGES; page++) {
+            if (const Texture* shadowAtlas = context.lInfo.shadowMapAtlases[page]) {
+                shadowAtlas->bindToUnit(page + 2);
+                mainShader.setUniform(SHADOW_MAP_ATLAS[page], page + 2);
+                mainShader.setUniform(SHADOW_MAP_ATLAS_SIZES[page], shadowAtlas->width());
             } else {
-                lgr::lout.error("Shadow map atlas for prio " + std::to_string(prio) + " not loaded for ChunkMaterial");
+                lgr::lout.error("Shadow map atlas page " + std::to_string(page) + " not loaded for ChunkMaterial");
             }
         }
+        mainShader.setUniform("u_shadowTileUnit", context.lInfo.shadowTileUnit);
     } else if (passType == PassType::ShadowPass) {
-        Shader& depthShader = m_depthShader.value();
+        Shader& depthShader = shaderForPass(passType, format);
 
         depthShader.use();
         depthShader.setUniform("u_viewProjection", context.tInfo.viewProjection);
     } else if (passType == PassType::AmbientOcclusion) {
-        Shader& ssaoGBuffShader = m_ssaoGBuffShader.value();
+        Shader& ssaoGBuffShader = shaderForPass(passType, format);
         
         ssaoGBuffShader.use();
         ssaoGBuffShader.setUniform("u_view", context.tInfo.view);
@@ -73,20 +119,35 @@ void ChunkMaterial::bindForPass(PassType passType, const RenderContext& context)
 }
 
 void ChunkMaterial::bindForObjectDraw(PassType passType, const RenderContext& context) {
-    if (passType == PassType::OpaquePass) {
-        Shader& mainShader = m_mainShader.value();
+    // Chunks are drawn in batches, per chunk data is read from the arena's draw data buffer
+}
 
-        mainShader.use();
-        mainShader.setUniform("u_chunkPosition", context.tInfo.meshTransform.getPosition());
-    } else if (passType == PassType::ShadowPass) {
-        Shader& depthShader = m_depthShader.value();
+bool ChunkMaterial::drawBatch(
+    PassType passType,
+    const RenderContext& context,
+    const std::vector<const RenderProxy*>& objects
+) {
+    m_arena->beginBatch();
+    for (const RenderProxy* obj : objects) {
+        // Chunk material is only assigned to chunk meshes, which always live in the arena
+        assert(obj->type == DrawPacketType::StaticMesh);
+        const StaticMesh* mesh = static_cast<const StaticMesh*>(obj->renderable);
+        assert(dynamic_cast<const ChunkArenaRenderData*>(mesh->getRenderData()) != nullptr);
+        const ChunkArenaRenderData* renderData = static_cast<const ChunkArenaRenderData*>(mesh->getRenderData());
+        m_arena->addToBatch(renderData->getAllocation(), obj->transform.getPosition());
+    }
 
-        depthShader.use();
-        depthShader.setUniform("u_chunkPosition", context.tInfo.meshTransform.getPosition());
-    } else if (passType == PassType::AmbientOcclusion) {
-        Shader& ssaoGBuffShader = m_ssaoGBuffShader.value();
+    for (int i = 0; i < static_cast<int>(ChunkMeshFormat::Count); i++) {
+        ChunkMeshFormat format = static_cast<ChunkMeshFormat>(i);
+        if (m_arena->batchSize(format) == 0) continue;
 
-        ssaoGBuffShader.use();
-        ssaoGBuffShader.setUniform("u_chunkPosition", context.tInfo.meshTransform.getPosition());
+        Shader& shader = shaderForPass(passType, format);
+        shader.use();
+        shader.bindShaderStorageBuffer("ChunkDrawDataBlock", m_arena->getDrawDataBuffer());
+        if (format == ChunkMeshFormat::Quads) {
+            shader.bindShaderStorageBuffer("ChunkQuadBlock", m_arena->getQuadBuffer());
+        }
+        m_arena->submitBatch(format, GL_TRIANGLES);
     }
+    return true;
 }
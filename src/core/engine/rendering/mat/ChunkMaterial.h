@@ -1,29 +1,41 @@
 #ifndef TOOMANYBLOCKS_CHUNKMATERIAL_H
 #define TOOMANYBLOCKS_CHUNKMATERIAL_H
 
+#include <memory>
+
+#include "engine/rendering/ChunkGeometryArena.h"
 #include "engine/rendering/lowlevelapi/Shader.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
 #include "engine/rendering/mat/Material.h"
 #include "foundation/threading/Future.h"
 
+struct ChunkShaderSet {
+    Future<Shader> main;
+    Future<Shader> depth;
+    Future<Shader> ssaoGBuff;
+
+    inline bool isReady() const { return main.isReady() && depth.isReady() && ssaoGBuff.isReady(); }
+};
+
 class ChunkMaterial : public Material {
 private:
-    Future<Shader> m_mainShader;
-    Future<Shader> m_depthShader;
-    Future<Shader> m_ssaoGBuffShader;
+    // One shader set per chunk mesh format, chunks of both formats may be loaded at the same time
+    ChunkShaderSet m_shaders[static_cast<int>(ChunkMeshFormat::Count)];
     Future<Texture> m_textureAtlas;
+    std::shared_ptr<ChunkGeometryArena> m_arena;
+
+    Shader& shaderForPass(PassType passType, ChunkMeshFormat format);
+
+    void bindShaderForPass(PassType passType, ChunkMeshFormat format, const RenderContext& context);
 
 public:
     ChunkMaterial(
-        Future<Shader> mainShader,
-        Future<Shader> depthShader,
-        Future<Shader> ssaoGBuffShader,
-        Future<Texture> textureAtlas
+        ChunkShaderSet vertexFormatShaders,
+        ChunkShaderSet quadFormatShaders,
+        Future<Texture> textureAtlas,
+        std::shared_ptr<ChunkGeometryArena> arena
     )
-        : m_mainShader(mainShader),
-          m_textureAtlas(textureAtlas),
-          m_ssaoGBuffShader(ssaoGBuffShader),
-          m_depthShader(depthShader) {}
+        : m_shaders{vertexFormatShaders, quadFormatShaders}, m_textureAtlas(textureAtlas), m_arena(arena) {}
 
     virtual ~ChunkMaterial() = default;
 
@@ -31,9 +43,19 @@ public:
 
     bool supportsPass(PassType passType) const override;
 
+    unsigned int shaderSortId(PassType passType) const override;
+
+    unsigned int textureSortId() const override;
+
     void bindForPass(PassType passType, const RenderContext& context) override;
 
     void bindForObjectDraw(PassType passType, const RenderContext& context) override;
+
+    bool drawBatch(
+        PassType passType,
+        const RenderContext& context,
+        const std::vector<const RenderProxy*>& objects
+    ) override;
 };
 
 #endif
\ No newline at end of file
@@ -7,6 +7,10 @@ bool LineMaterial::isReady() const { return m_mainShader.isReady(); }
 
 bool LineMaterial::supportsPass(PassType passType) const { return passType == PassType::OpaquePass; }
 
+unsigned int LineMaterial::shaderSortId(PassType passType) const {
+    return m_mainShader.isReady() ? m_mainShader.value().rendererId() : 0;
+}
+
 void LineMaterial::bindForPass(PassType passType, const RenderContext& context) {
     if (passType == PassType::OpaquePass) {
         Shader& mainShader = m_mainShader.value();
@@ -23,7 +27,7 @@ void LineMaterial::bindForObjectDraw(PassType passType, const RenderContext& con
         Shader& mainShader = m_mainShader.value();
 
         mainShader.use();
-        mainShader.setUniform("u_mvp", context.tInfo.viewProjection * context.tInfo.meshTransform.getModelMatrix());
+        bindObjectConstants(mainShader, context);
     } else {
         lgr::lout.error("Material bound for unsupported pass");
     }
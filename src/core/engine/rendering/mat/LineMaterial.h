@@ -21,6 +21,8 @@ public:
 
     bool supportsPass(PassType passType) const override;
 
+    unsigned int shaderSortId(PassType passType) const override;
+
     void bindForPass(PassType passType, const RenderContext& context) override;
 
     void bindForObjectDraw(PassType passType, const RenderContext& context) override;
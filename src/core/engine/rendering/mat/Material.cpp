@@ -1 +1,22 @@
-#include "Material.h"
\ No newline at end of file
+#include "Material.h"
+
+#include <atomic>
+
+#include "Logger.h"
+#include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/Shader.h"
+
+static std::atomic<uint16_t> nextMaterialSortId{0};
+
+Material::Material() : m_sortId(nextMaterialSortId.fetch_add(1, std::memory_order_relaxed)) {}
+
+
+void Material::bindObjectConstants(Shader& shader, const RenderContext& context) {
+    glm::mat4 mvp = context.tInfo.viewProjection * context.tInfo.meshTransform.getModelMatrix();
+    UniformBufferRange range = context.frameConstants->allocate(&mvp, sizeof(glm::mat4));
+    if (range.isValid()) {
+        shader.bindUniformBufferRange("ObjectConstants", range);
+    } else {
+        lgr::lout.error("Frame constant ring is full, object constants were not updated");
+    }
+}
@@ -1,7 +1,12 @@
 #ifndef TOOMANYBLOCKS_MATERIAL_H
 #define TOOMANYBLOCKS_MATERIAL_H
 
+#include <cstdint>
+#include <vector>
+
 struct RenderContext;
+struct RenderProxy;
+class Shader;
 
 enum PassType {
     TransformFeedback,
@@ -12,13 +17,36 @@ enum PassType {
 };
 
 class Material {
+private:
+    uint16_t m_sortId;
+
+protected:
+    // Streams the model view projection of the current object into the shader's ObjectConstants block
+    static void bindObjectConstants(Shader& shader, const RenderContext& context);
+
 public:
+    Material();
     virtual ~Material() = default;
 
+    // Identifies the material in render queue sort keys, wraps around after 65536 materials
+    inline uint16_t sortId() const { return m_sortId; }
+
+    // Renderer ids of the shader and texture bound for a pass, so draws sharing gpu state are queued next to each other
+    virtual unsigned int shaderSortId(PassType passType) const { return 0; }
+    virtual unsigned int textureSortId() const { return 0; }
+
     virtual bool isReady() const { return false; }
     virtual bool supportsPass(PassType passType) const = 0;
     virtual void bindForPass(PassType passType, const RenderContext& context) = 0;
     virtual void bindForObjectDraw(PassType passType, const RenderContext& context) = 0;
+    // Draws all objects of a batch at once. Returns false if objects must be drawn one by one instead.
+    virtual bool drawBatch(
+        PassType passType,
+        const RenderContext& context,
+        const std::vector<const RenderProxy*>& objects
+    ) {
+        return false;
+    }
 };
 
 #endif
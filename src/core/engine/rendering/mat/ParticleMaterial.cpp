@@ -12,6 +12,15 @@ bool ParticleMaterial::supportsPass(PassType passType) const {
     return passType == PassType::TransformFeedback || passType == PassType::OpaquePass;
 }
 
+unsigned int ParticleMaterial::shaderSortId(PassType passType) const {
+    if (passType == PassType::TransformFeedback) return m_tfShader.isReady() ? m_tfShader.value().rendererId() : 0;
+    return m_mainShader.isReady() ? m_mainShader.value().rendererId() : 0;
+}
+
+unsigned int ParticleMaterial::textureSortId() const {
+    return m_textureAtlas.isReady() ? m_textureAtlas.value().rendererId() : 0;
+}
+
 void ParticleMaterial::bindForPass(PassType passType, const RenderContext& context) {
     if (passType == PassType::TransformFeedback) {
         TransformFeedbackShader& tfShader = m_tfShader.value();
@@ -26,6 +26,10 @@ public:
 
     bool supportsPass(PassType passType) const override;
 
+    unsigned int shaderSortId(PassType passType) const override;
+
+    unsigned int textureSortId() const override;
+
     void bindForPass(PassType passType, const RenderContext& context) override;
 
     void bindForObjectDraw(PassType passType, const RenderContext& context) override;
@@ -1,35 +1,109 @@
 #include "SimpleMaterial.h"
 
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <functional>
+
 #include "Logger.h"
+#include "engine/rendering/RenderScene.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/StaticMesh.h"
+
+bool SimpleMaterial::isReady() const { return m_mainShader.isReady() && m_depthShader.isReady(); }
+
+bool SimpleMaterial::supportsPass(PassType passType) const {
+    return passType == PassType::ShadowPass || passType == PassType::OpaquePass;
+}
+
+Shader& SimpleMaterial::shaderForPass(PassType passType) {
+    return passType == PassType::ShadowPass ? m_depthShader.value() : m_mainShader.value();
+}
 
-bool SimpleMaterial::isReady() const { return m_mainShader.isReady(); }
+unsigned int SimpleMaterial::shaderSortId(PassType passType) const {
+    const Future<Shader>& shader = passType == PassType::ShadowPass ? m_depthShader : m_mainShader;
+    return shader.isReady() ? shader.value().rendererId() : 0;
+}
 
-bool SimpleMaterial::supportsPass(PassType passType) const { return passType == PassType::OpaquePass; }
+unsigned int SimpleMaterial::textureSortId() const { return m_texture.isReady() ? m_texture.value().rendererId() : 0; }
 
 void SimpleMaterial::bindForPass(PassType passType, const RenderContext& context) {
     if (passType == PassType::OpaquePass) {
         Shader& mainShader = m_mainShader.value();
 
         mainShader.use();
+        mainShader.setUniform("u_viewProjection", context.tInfo.viewProjection);
         mainShader.setUniform("u_color", m_color);
         mainShader.setUniform("u_useTexture", m_texture.isReady());
         if (m_texture.isReady()) {
             m_texture.value().bindToUnit(0);
             mainShader.setUniform("u_texture", 0);
         }
+    } else if (passType == PassType::ShadowPass) {
+        Shader& depthShader = m_depthShader.value();
+
+        depthShader.use();
+        depthShader.setUniform("u_viewProjection", context.tInfo.viewProjection);
     } else {
         lgr::lout.error("Material bound for unsupported pass");
     }
 }
 
+void SimpleMaterial::streamInstances(Shader& shader, const RenderContext& context, unsigned int count) {
+    // Only the drawn instances are streamed, the range still covers the whole block as the shader declares it
+    UniformBufferRange range = context.frameConstants->allocate(
+        m_instanceModels.data(), count * sizeof(glm::mat4), m_instanceModels.size() * sizeof(glm::mat4)
+    );
+    if (range.isValid()) {
+        shader.bindUniformBufferRange("InstanceConstants", range);
+    } else {
+        lgr::lout.error("Frame constant ring is full, instance constants were not updated");
+    }
+}
+
 void SimpleMaterial::bindForObjectDraw(PassType passType, const RenderContext& context) {
-    if (passType == PassType::OpaquePass) {
-        Shader& mainShader = m_mainShader.value();
+    if (passType == PassType::OpaquePass || passType == PassType::ShadowPass) {
+        Shader& shader = shaderForPass(passType);
 
-        mainShader.use();
-        mainShader.setUniform("u_mvp", context.tInfo.viewProjection * context.tInfo.meshTransform.getModelMatrix());
+        shader.use();
+        m_instanceModels[0] = context.tInfo.meshTransform.getModelMatrix();
+        streamInstances(shader, context, 1);
     } else {
         lgr::lout.error("Material bound for unsupported pass");
     }
 }
+
+bool SimpleMaterial::drawBatch(
+    PassType passType,
+    const RenderContext& context,
+    const std::vector<const RenderProxy*>& objects
+) {
+    m_batchMeshes.clear();
+    for (const RenderProxy* obj : objects) {
+        if (obj->type != DrawPacketType::StaticMesh) return false;
+        const StaticMesh* mesh = static_cast<const StaticMesh*>(obj->renderable);
+        if (const RenderData* renderData = mesh->getRenderData()) m_batchMeshes.push_back({renderData, obj});
+    }
+
+    // Meshes sharing render data become adjacent, the front to back order only holds between the groups
+    std::sort(m_batchMeshes.begin(), m_batchMeshes.end(), [](const BatchedMesh& a, const BatchedMesh& b) {
+        return std::less<const RenderData*>()(a.renderData, b.renderData);
+    });
+
+    Shader& shader = shaderForPass(passType);
+    shader.use();
+    for (size_t begin = 0; begin < m_batchMeshes.size();) {
+        const RenderData* renderData = m_batchMeshes[begin].renderData;
+        unsigned int count = 0;
+        while (begin + count < m_batchMeshes.size() && count < MAX_MESH_INSTANCES &&
+               m_batchMeshes[begin + count].renderData == renderData) {
+            m_instanceModels[count] = m_batchMeshes[begin + count].proxy->transform.getModelMatrix();
+            count++;
+        }
+
+        streamInstances(shader, context, count);
+        renderData->drawInstancedAs(GL_TRIANGLES, count);
+        begin += count;
+    }
+    return true;
+}
@@ -1,23 +1,54 @@
 #ifndef TOOMANYBLOCKS_SIMPLEMATERIAL_H
 #define TOOMANYBLOCKS_SIMPLEMATERIAL_H
 
+#include <array>
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <vector>
 
 #include "engine/rendering/lowlevelapi/Shader.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
 #include "engine/rendering/mat/Material.h"
 #include "foundation/threading/Future.h"
 
+class RenderData;
+
+// Model matrices streamed per instanced draw, matches the InstanceConstants block of the simple and depth shaders
+constexpr unsigned int MAX_MESH_INSTANCES = 128;
+
 class SimpleMaterial : public Material {
 private:
     Future<Shader> m_mainShader;
+    Future<Shader> m_depthShader;
     Future<Shader> m_trShader;
     glm::vec3 m_color;
     Future<Texture> m_texture;
 
+    // Only used on the main thread while drawing, kept to not allocate per batch
+    struct BatchedMesh {
+        const RenderData* renderData;
+        const RenderProxy* proxy;
+    };
+    std::vector<BatchedMesh> m_batchMeshes;
+    std::array<glm::mat4, MAX_MESH_INSTANCES> m_instanceModels;
+
+    Shader& shaderForPass(PassType passType);
+
+    void streamInstances(Shader& shader, const RenderContext& context, unsigned int count);
+
 public:
-    SimpleMaterial(Future<Shader> mainShader, Future<Shader> trShader, const glm::vec3& color, Future<Texture> texture = Future<Texture>())
-        : m_mainShader(mainShader), m_trShader(trShader), m_color(color), m_texture(texture) {}
+    SimpleMaterial(
+        Future<Shader> mainShader,
+        Future<Shader> depthShader,
+        Future<Shader> trShader,
+        const glm::vec3& color,
+        Future<Texture> texture = Future<Texture>()
+    )
+        : m_mainShader(mainShader),
+          m_depthShader(depthShader),
+          m_trShader(trShader),
+          m_color(color),
+          m_texture(texture) {}
 
     virtual ~SimpleMaterial() = default;
 
@@ -25,9 +56,20 @@ public:
 
     bool supportsPass(PassType passType) const override;
 
+    unsigned int shaderSortId(PassType passType) const override;
+
+    unsigned int textureSortId() const override;
+
     void bindForPass(PassType passType, const RenderContext& context) override;
 
     void bindForObjectDraw(PassType passType, const RenderContext& context) override;
+
+    // Static meshes sharing render data are drawn with one instanced draw per MAX_MESH_INSTANCES meshes
+    bool drawBatch(
+        PassType passType,
+        const RenderContext& context,
+        const std::vector<const RenderProxy*>& objects
+    ) override;
 };
 
 #endif
\ No newline at end of file
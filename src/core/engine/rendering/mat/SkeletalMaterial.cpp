@@ -7,6 +7,12 @@ bool SkeletalMaterial::isReady() const { return m_mainShader.isReady() && m_text
 
 bool SkeletalMaterial::supportsPass(PassType passType) const { return passType == PassType::OpaquePass; }
 
+unsigned int SkeletalMaterial::shaderSortId(PassType passType) const {
+    return m_mainShader.isReady() ? m_mainShader.value().rendererId() : 0;
+}
+
+unsigned int SkeletalMaterial::textureSortId() const { return m_texture.isReady() ? m_texture.value().rendererId() : 0; }
+
 void SkeletalMaterial::bindForPass(PassType passType, const RenderContext& context) {
     if (passType == PassType::OpaquePass) {
         Shader& mainShader = m_mainShader.value();
@@ -28,11 +34,11 @@ void SkeletalMaterial::bindForObjectDraw(PassType passType, const RenderContext&
         Shader& mainShader = m_mainShader.value();
 
         mainShader.use();
-        mainShader.setUniform("u_mvp", context.tInfo.viewProjection * context.tInfo.meshTransform.getModelMatrix());
-        if (context.skInfo.jointMatrices) {
-            mainShader.bindUniformBuffer("JointMatrices", *context.skInfo.jointMatrices);
+        bindObjectConstants(mainShader, context);
+        if (context.skInfo.jointMatrices.isValid()) {
+            mainShader.bindUniformBufferRange("JointMatrices", context.skInfo.jointMatrices);
         } else {
-            lgr::lout.error("UBO for joint matrices was not set");
+            lgr::lout.error("Joint matrices were not streamed");
         }
     } else {
         lgr::lout.error("Material bound for unsupported pass");
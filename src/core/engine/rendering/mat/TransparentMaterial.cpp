@@ -7,6 +7,12 @@ bool TransparentMaterial::isReady() const { return m_mainShader.isReady(); }
 
 bool TransparentMaterial::supportsPass(PassType passType) const { return passType == PassType::TransparencyPass; }
 
+unsigned int TransparentMaterial::shaderSortId(PassType passType) const {
+    return m_mainShader.isReady() ? m_mainShader.value().rendererId() : 0;
+}
+
+unsigned int TransparentMaterial::textureSortId() const { return m_texture.isReady() ? m_texture.value().rendererId() : 0; }
+
 void TransparentMaterial::bindForPass(PassType passType, const RenderContext& context) {
     if (passType == PassType::TransparencyPass) {
         Shader& mainShader = m_mainShader.value();
@@ -28,7 +34,7 @@ void TransparentMaterial::bindForObjectDraw(PassType passType, const RenderConte
         Shader& mainShader = m_mainShader.value();
 
         mainShader.use();
-        mainShader.setUniform("u_mvp", context.tInfo.viewProjection * context.tInfo.meshTransform.getModelMatrix());
+        bindObjectConstants(mainShader, context);
     } else {
         lgr::lout.error("Material bound for unsupported pass");
     }
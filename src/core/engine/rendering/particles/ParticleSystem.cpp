@@ -21,7 +21,8 @@ static constexpr float particleQuad[] = {
 };
 
 ParticleSystem::ParticleSystem(const std::vector<GenericGPUParticleModule>& modules)
-    : m_switched(false),
+    : Renderable(nullptr, DrawPacketType::ParticleSystem),
+      m_switched(false),
       m_accumulatedTime(0.0f),
       m_spawnAccumulator(0.0f),
       m_spawnRate(0.0f),
@@ -0,0 +1,136 @@
+#include "DepthSSAORenderpass.h"
+
+#include <GL/glew.h>
+
+#include <memory>
+
+#include "AppConstants.h"
+#include "Application.h"
+#include "engine/GameInstance.h"
+#include "engine/rendering/Camera.h"
+#include "engine/rendering/GLUtils.h"
+#include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
+#include "engine/resource/loaders/ShaderLoader.h"
+
+static unsigned int samplesPerFrame(SSAOQuality quality) {
+    switch (quality) {
+        case SSAOQuality::Low: return SSAO_SAMPLE_COUNT / 4;
+        case SSAOQuality::Medium: return SSAO_SAMPLE_COUNT / 2;
+        default: return 0;
+    }
+}
+
+DepthSSAORenderpass::DepthSSAORenderpass()
+    : m_currentHistory(0),
+      m_historyValid(false),
+      m_previousViewProjection(1.0f),
+      m_frameIndex(0),
+      m_depthInput(-1),
+      m_samplesPerFrame(0) {
+    SSAOProcessor::createKernel(m_kernelSamples.data());
+    for (FrameBuffer& historyBuffer : m_historyBuffers) {
+        historyBuffer = FrameBuffer::create();
+    }
+
+    CPUShader cpuShader = loadShaderFromFile(Res::Shader::SSAO_DEPTH, ShaderLoadOption::VertexAndFragment);
+    m_ssaoShader = Shader::create(cpuShader.vertexShader, cpuShader.fragmentShader);
+}
+
+void DepthSSAORenderpass::validateHistory(glm::uvec2 size) {
+    const std::vector<std::shared_ptr<Texture>>& attached = m_historyBuffers[0].getAttachedTextures();
+    if (!attached.empty() && attached[0]->width() == size.x && attached[0]->height() == size.y) return;
+
+    for (FrameBuffer& historyBuffer : m_historyBuffers) {
+        historyBuffer.clearAttachedTextures();
+        historyBuffer.attachTexture(
+            std::make_shared<Texture>(Texture::create(
+                TextureType::Float16, size.x, size.y, 2, nullptr, TextureFilter::Nearest, TextureWrap::ClampToEdge
+            ))
+        );
+    }
+    m_historyValid = false;
+}
+
+void DepthSSAORenderpass::prepare(
+    RenderContext& context,
+    RenderResources& resources,
+    const ApplicationContext& appContext
+) {
+    glm::uvec2 halfRes = glm::max(context.currScreenRes / 2u, glm::uvec2(2));
+    validateHistory(halfRes);
+
+    m_currentHistory ^= 1;
+    m_historyBuffers[m_currentHistory].bind();
+    GLStateCache::setViewport(0, 0, halfRes.x, halfRes.y);
+}
+
+void DepthSSAORenderpass::execute(
+    RenderContext& context,
+    RenderResources& resources,
+    const ApplicationContext& appContext
+) {
+    std::shared_ptr<Camera> camera = appContext.instance->m_player->getCamera();
+    glm::mat4 projection = camera->getProjectionMatrix();
+    glm::mat4 view = camera->getViewMatrix();
+
+    m_ssaoShader.use();
+    resources.renderGraph->getTexture(m_depthInput)->bindToUnit(0);
+    m_ssaoShader.setUniform("u_depthTexture", 0);
+    m_historyBuffers[m_currentHistory ^ 1].getAttachedTextures().at(0)->bindToUnit(1);
+    m_ssaoShader.setUniform("u_historyTexture", 1);
+    m_ssaoShader.setUniform("u_historyValid", m_historyValid);
+
+    m_ssaoShader.setUniform("u_kernelSamples", m_kernelSamples.data(), SSAO_SAMPLE_COUNT);
+    m_ssaoShader.setUniform("u_sampleCount", m_samplesPerFrame);
+    m_ssaoShader.setUniform("u_frameIndex", m_frameIndex);
+    m_ssaoShader.setUniform("u_projection", projection);
+    m_ssaoShader.setUniform("u_inverseProjection", glm::inverse(projection));
+    m_ssaoShader.setUniform("u_viewToPreviousClip", m_previousViewProjection * glm::inverse(view));
+
+    appContext.renderer->drawFullscreenQuad();
+
+    m_previousViewProjection = projection * view;
+}
+
+void DepthSSAORenderpass::cleanup(
+    RenderContext& context,
+    RenderResources& resources,
+    const ApplicationContext& appContext
+) {
+    context.ssaoInfo.resolveOutput = m_historyBuffers[m_currentHistory].getAttachedTextures().at(0).get();
+    m_historyValid = true;
+    m_frameIndex++;
+}
+
+const char* DepthSSAORenderpass::name() { return "Depth SSAO Renderpass"; }
+
+void DepthSSAORenderpass::declareResources(RenderGraphBuilder& builder) {
+    m_depthInput = builder.read("Scene depth");
+    builder.writeExternal("Reconstructed ambient occlusion");
+}
+
+bool DepthSSAORenderpass::collectWork(RenderContext& context, RenderResources& resources) {
+    m_samplesPerFrame = samplesPerFrame(context.ssaoInfo.quality);
+    return m_samplesPerFrame > 0 && !resources.cameraVisibleObjects.empty();
+}
+
+void DepthSSAORenderpass::skip(RenderContext& context) {
+    context.ssaoInfo.resolveOutput = nullptr;
+    m_samplesPerFrame = 0;
+
+    // Stale history would be blended in once the pass runs again
+    m_historyValid = false;
+    if (context.ssaoInfo.quality == SSAOQuality::Off || context.ssaoInfo.quality == SSAOQuality::High) {
+        for (FrameBuffer& historyBuffer : m_historyBuffers) {
+            if (!historyBuffer.getAttachedTextures().empty()) historyBuffer.clearAttachedTextures();
+        }
+    }
+}
+
+void DepthSSAORenderpass::putDebugInfo(DebugReport& report) {
+    report.beginGroup(name());
+    report.addTimeMs("Processing Time", m_lastRunTimeMs);
+    report.addCounter("Samples per frame", static_cast<int>(m_samplesPerFrame));
+    report.endGroup();
+}
@@ -0,0 +1,68 @@
+#ifndef TOOMANYBLOCKS_DEPTHSSAORENDERPASS_H
+#define TOOMANYBLOCKS_DEPTHSSAORENDERPASS_H
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "engine/rendering/RenderGraph.h"
+#include "engine/rendering/lowlevelapi/FrameBuffer.h"
+#include "engine/rendering/lowlevelapi/Shader.h"
+#include "engine/rendering/renderpasses/Renderpass.h"
+#include "engine/rendering/renderpasses/processors/SSAOProcessor.h"
+
+/**
+ * Computes ambient occlusion at half resolution from the depth of the opaque pass, without a geometry pass of its
+ * own. Every frame takes a different subset of the sample kernel and blends into the previous result reprojected
+ * onto the current view, so few samples per frame converge to the full kernel while the camera moves slowly.
+ */
+class DepthSSAORenderpass : public Renderpass {
+private:
+    Shader m_ssaoShader;
+    std::array<glm::vec3, SSAO_SAMPLE_COUNT> m_kernelSamples;
+
+    // Occlusion and view depth, the result of the last frame is read while the other one is written
+    std::array<FrameBuffer, 2> m_historyBuffers;
+    int m_currentHistory;
+    bool m_historyValid;
+    glm::mat4 m_previousViewProjection;
+    uint32_t m_frameIndex;
+
+    RenderGraphResource m_depthInput;
+    unsigned int m_samplesPerFrame;
+
+    void validateHistory(glm::uvec2 size);
+
+protected:
+    virtual void prepare(
+        RenderContext& context,
+        RenderResources& resources,
+        const ApplicationContext& appContext
+    ) override;
+    virtual void execute(
+        RenderContext& context,
+        RenderResources& resources,
+        const ApplicationContext& appContext
+    ) override;
+    virtual void cleanup(
+        RenderContext& context,
+        RenderResources& resources,
+        const ApplicationContext& appContext
+    ) override;
+
+public:
+    DepthSSAORenderpass();
+    virtual ~DepthSSAORenderpass() = default;
+
+    virtual const char* name() override;
+
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
+
+    virtual void skip(RenderContext& context) override;
+
+    virtual void putDebugInfo(DebugReport& report) override;
+};
+
+#endif
@@ -10,83 +10,90 @@
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 void OpaqueRenderpass::prepare(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
-    if (context.screenResChanged) {
-        createBuffers(context);
-    }
-
+    resources.renderGraph->attachTargets(m_opaqueBuffer, {m_colorTarget, m_depthTarget});
     m_opaqueBuffer.bind();
     GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
     glm::uvec2 screenRes = context.currScreenRes;
-    GLCALL(glViewport(0, 0, screenRes.x, screenRes.y));
+    GLStateCache::setViewport(0, 0, screenRes.x, screenRes.y);
     context.tInfo.viewProjection = appContext.instance->m_player->getCamera()->getViewProjMatrix();
     context.tInfo.projection = appContext.instance->m_player->getCamera()->getProjectionMatrix();
     context.tInfo.view = appContext.instance->m_player->getCamera()->getViewMatrix();
     context.tInfo.viewportTransform = appContext.instance->m_player->getCamera()->getGlobalTransform();
 
-    if (m_debugPolygonModeEnabled) {
-        GLCALL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
-    }
+    GLStateCache::setPolygonMode(m_debugPolygonModeEnabled ? GL_LINE : GL_FILL);
 }
 
 void OpaqueRenderpass::execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
     m_objectsProcessed = 0;
+    m_chunksOccluded = resources.occludedChunks;
 
-    cullObjectsOutOfView(*resources.objectsToRender, resources.culledObjectsBuffer, context.tInfo.viewProjection);
-    batchByMaterialForPass(resources.culledObjectsBuffer, PassType::OpaquePass);
+    for (size_t begin = 0, end = 0; begin < m_renderQueue.size(); begin = end) {
+        end = m_renderQueue.runEnd(begin);
+        Material* material = m_renderQueue[begin].material;
 
-    for (const auto& batch : m_materialBatches) {
-        batch.first->bindForPass(PassType::OpaquePass, context);
+        material->bindForPass(PassType::OpaquePass, context);
+        if (material->drawBatch(PassType::OpaquePass, context, m_renderQueue.runObjects(begin, end))) {
+            m_objectsProcessed += end - begin;
+            continue;
+        }
 
-        for (const Renderable* obj : batch.second) {
-            if (const SkeletalMesh* sMesh = dynamic_cast<const SkeletalMesh*>(obj)) {
-                context.skInfo.jointMatrices = sMesh->getJointMatrices();
-            } else if (const ParticleSystem* pSys = dynamic_cast<const ParticleSystem*>(obj)) {
-                context.pInfo.flags = pSys->getFlags();
+        for (size_t i = begin; i < end; i++) {
+            const RenderProxy& packet = m_renderQueue[i];
+            if (packet.type == DrawPacketType::SkeletalMesh) {
+                context.skInfo.jointMatrices =
+                    static_cast<const SkeletalMesh*>(packet.renderable)->streamJointMatrices(*context.frameConstants);
+            } else if (packet.type == DrawPacketType::ParticleSystem) {
+                context.pInfo.flags = static_cast<const ParticleSystem*>(packet.renderable)->getFlags();
             }
-            context.tInfo.meshTransform = obj->getRenderableTransform();
-            batch.first->bindForObjectDraw(PassType::OpaquePass, context);
-            obj->draw();
+            context.tInfo.meshTransform = packet.transform;
+            material->bindForObjectDraw(PassType::OpaquePass, context);
+            packet.renderable->draw();
 
             m_objectsProcessed++;
         }
     }
-
-    m_materialBatches.clear();
 }
 
 void OpaqueRenderpass::cleanup(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
     context.opaqueInfo.output = m_opaqueBuffer.getAttachedTextures().at(0).get();
 
-    if (m_debugPolygonModeEnabled) {
-        GLCALL(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
-    }
+    GLStateCache::setPolygonMode(GL_FILL);
 }
 
-OpaqueRenderpass::OpaqueRenderpass() : m_debugPolygonModeEnabled(false), m_objectsProcessed(0) {
+OpaqueRenderpass::OpaqueRenderpass()
+    : m_colorTarget(-1),
+      m_depthTarget(-1),
+      m_debugPolygonModeEnabled(false),
+      m_objectsProcessed(0),
+      m_chunksOccluded(0) {
     m_opaqueBuffer = FrameBuffer::create();
 }
 
 const char* OpaqueRenderpass::name() { return "Main Renderpass"; }
 
+void OpaqueRenderpass::declareResources(RenderGraphBuilder& builder) {
+    m_colorTarget = builder.createTexture("Scene color", {TextureType::Color, 3});
+    m_depthTarget = builder.createTexture("Scene depth", {TextureType::Depth, 1});
+    builder.read("Particle state", true);
+    builder.read("Light data", true);
+    builder.read("Ambient occlusion", true);
+}
+
+bool OpaqueRenderpass::collectWork(RenderContext& context, RenderResources& resources) {
+    m_renderQueue.build(resources.cameraVisibleObjects, PassType::OpaquePass, resources.cameraPosition);
+    // Runs even without objects, the cleared scene color is still resolved to the screen
+    return true;
+}
+
 void OpaqueRenderpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
     report.addCounter("Objects processed", static_cast<int>(m_objectsProcessed));
+    report.addCounter("Occlusion culled chunks", static_cast<int>(m_chunksOccluded));
     report.endGroup();
 }
-
-void OpaqueRenderpass::createBuffers(RenderContext& context) {
-    m_opaqueBuffer.clearAttachedTextures();
-    m_opaqueBuffer.attachTexture(
-        std::make_shared<Texture>(
-            Texture::create(TextureType::Color, context.currScreenRes.x, context.currScreenRes.y, 3)
-        )
-    );
-    m_opaqueBuffer.attachTexture(
-        std::make_shared<Texture>(Texture::create(TextureType::Depth, context.currScreenRes.x, context.currScreenRes.y))
-    );
-    context.opaqueInfo.usedDepthTexture = m_opaqueBuffer.getAttachedDepthTexture();
-}
@@ -1,14 +1,18 @@
 #ifndef TOOMANYBLOCKS_MAINRENDERPASS_H
 #define TOOMANYBLOCKS_MAINRENDERPASS_H
 
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/renderpasses/Renderpass.h"
 #include "engine/rendering/lowlevelapi/FrameBuffer.h"
 
 class OpaqueRenderpass : public Renderpass {
 private:
     FrameBuffer m_opaqueBuffer;
+    RenderGraphResource m_colorTarget;
+    RenderGraphResource m_depthTarget;
     bool m_debugPolygonModeEnabled;
     size_t m_objectsProcessed;
+    size_t m_chunksOccluded;
     
 protected:
     virtual void prepare(
@@ -33,9 +37,11 @@ public:
 
     virtual const char* name() override;
 
-    virtual void putDebugInfo(DebugReport& report) override;
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
 
-    void createBuffers(RenderContext& context);
+    virtual void putDebugInfo(DebugReport& report) override;
 
     inline bool isDebugPolygonModeEnabled() const { return m_debugPolygonModeEnabled; }
 
@@ -1,9 +1,9 @@
 #ifndef TOOMANYBLOCKS_RENDERPASS_H
 #define TOOMANYBLOCKS_RENDERPASS_H
 
-#include <unordered_map>
 #include <vector>
 
+#include "engine/rendering/RenderQueue.h"
 #include "engine/rendering/Renderable.h"
 #include "engine/rendering/mat/Material.h"
 #include "engine/rendering/renderpasses/DebugReport.h"
@@ -11,23 +11,31 @@
 struct RenderContext;
 struct RenderResources;
 struct ApplicationContext;
+class RenderGraphBuilder;
 
 class Renderpass {
 protected:
-    std::unordered_map<Material*, std::vector<Renderable*>> m_materialBatches;
+    RenderQueue m_renderQueue;
     float m_lastRunTimeMs;
 
     virtual void prepare(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {};
     virtual void execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) = 0;
     virtual void cleanup(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {};
 
-    void batchByMaterialForPass(const std::vector<Renderable*>& meshBuff, PassType type);
-
 public:
     virtual ~Renderpass() = default;
 
     virtual const char* name() = 0;
 
+    // Declares the resources read and written by the pass, called once when it is added to the render graph
+    virtual void declareResources(RenderGraphBuilder& builder) = 0;
+
+    // Gathers the work of this frame before any pass runs, passes returning false are culled
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) { return true; }
+
+    // Called instead of run() in frames the pass is culled, resets what the pass publishes in the context
+    virtual void skip(RenderContext& context) {}
+
     void run(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext);
 
     virtual void putDebugInfo(DebugReport& report) = 0;
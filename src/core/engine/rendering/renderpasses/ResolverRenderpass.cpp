@@ -6,9 +6,11 @@
 #include "Application.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
 #include "engine/resource/loaders/ShaderLoader.h"
 #include "engine/rendering/lowlevelapi/FrameBuffer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 void ResolverRenderpass::prepare(
     RenderContext& context,
@@ -18,7 +20,7 @@ void ResolverRenderpass::prepare(
     FrameBuffer::bindDefault();
     GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
     glm::uvec2 screenRes = context.currScreenRes;
-    GLCALL(glViewport(0, 0, screenRes.x, screenRes.y));
+    GLStateCache::setViewport(0, 0, screenRes.x, screenRes.y);
 }
 
 void ResolverRenderpass::execute(
@@ -30,10 +32,26 @@ void ResolverRenderpass::execute(
     context.opaqueInfo.output->bindToUnit(0);
     m_resolverShader.setUniform("u_opaquePassResult", 0);
 
-    context.transparencyInfo.accumOutput->bindToUnit(1);
-    m_resolverShader.setUniform("u_transparencyAccumTexture", 1);
-    context.transparencyInfo.revealOutput->bindToUnit(2);
-    m_resolverShader.setUniform("u_transparencyRevealTexture", 2);
+    // The transparency pass is culled while no transparent object is visible
+    bool hasTransparency = context.transparencyInfo.accumOutput != nullptr;
+    m_resolverShader.setUniform("u_hasTransparency", hasTransparency);
+    if (hasTransparency) {
+        context.transparencyInfo.accumOutput->bindToUnit(1);
+        m_resolverShader.setUniform("u_transparencyAccumTexture", 1);
+        context.transparencyInfo.revealOutput->bindToUnit(2);
+        m_resolverShader.setUniform("u_transparencyRevealTexture", 2);
+    }
+
+    bool hasAmbientOcclusion = context.ssaoInfo.resolveOutput != nullptr;
+    m_resolverShader.setUniform("u_hasAmbientOcclusion", hasAmbientOcclusion);
+    if (hasAmbientOcclusion) {
+        context.ssaoInfo.resolveOutput->bindToUnit(3);
+        m_resolverShader.setUniform("u_ambientOcclusionTexture", 3);
+        resources.renderGraph->getTexture(m_depthInput)->bindToUnit(4);
+        m_resolverShader.setUniform("u_sceneDepthTexture", 4);
+        const glm::mat4& projection = context.tInfo.projection;
+        m_resolverShader.setUniform("u_depthUnproject", glm::vec2(projection[2][2], projection[3][2]));
+    }
 
     appContext.renderer->drawFullscreenQuad();
 }
@@ -44,7 +62,7 @@ void ResolverRenderpass::cleanup(
     const ApplicationContext& appContext
 ) {}
 
-ResolverRenderpass::ResolverRenderpass() {
+ResolverRenderpass::ResolverRenderpass() : m_depthInput(-1) {
     ApplicationContext* context = Application::getContext();
     CPUShader cpuShader = loadShaderFromFile(Res::Shader::RESOLVER, ShaderLoadOption::VertexAndFragment);
 
@@ -54,6 +72,15 @@ ResolverRenderpass::ResolverRenderpass() {
 
 const char* ResolverRenderpass::name() { return "Resolver Renderpass"; }
 
+void ResolverRenderpass::declareResources(RenderGraphBuilder& builder) {
+    builder.read("Scene color");
+    m_depthInput = builder.read("Scene depth");
+    builder.read("Reconstructed ambient occlusion", true);
+    builder.read("Transparency accumulation", true);
+    builder.read("Transparency reveal", true);
+    builder.writeOutput("Screen");
+}
+
 void ResolverRenderpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
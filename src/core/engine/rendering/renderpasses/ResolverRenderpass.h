@@ -1,12 +1,14 @@
 #ifndef TOOMANYBLOCKS_RESOLVERRENDERPASS_H
 #define TOOMANYBLOCKS_RESOLVERRENDERPASS_H
 
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/lowlevelapi/Shader.h"
 #include "engine/rendering/renderpasses/Renderpass.h"
 
 class ResolverRenderpass : public Renderpass {
 private:
     Shader m_resolverShader;
+    RenderGraphResource m_depthInput;
 
 protected:
     virtual void prepare(
@@ -31,6 +33,8 @@ public:
 
     virtual const char* name() override;
 
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
     virtual void putDebugInfo(DebugReport& report) override;
 };
 
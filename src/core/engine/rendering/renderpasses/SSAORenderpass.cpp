@@ -10,6 +10,7 @@
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
 
 void SSAORenderpass::prepare(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
@@ -17,37 +18,38 @@ void SSAORenderpass::prepare(RenderContext& context, RenderResources& resources,
     context.tInfo.projection = appContext.instance->m_player->getCamera()->getProjectionMatrix();
     context.tInfo.view = appContext.instance->m_player->getCamera()->getViewMatrix();
     context.tInfo.viewportTransform = appContext.instance->m_player->getCamera()->getGlobalTransform();
-    m_ssaoProcessor.validateBuffers(appContext);  // Possible resize sssao textures if resize happened
+    m_ssaoProcessor.attachTargets(*resources.renderGraph);
 }
 
 void SSAORenderpass::execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
-    cullObjectsOutOfView(*resources.objectsToRender, resources.culledObjectsBuffer, context.tInfo.viewProjection);
-    batchByMaterialForPass(resources.culledObjectsBuffer, PassType::AmbientOcclusion);
-
     m_objectsProcessed = 0;
-    if (!m_materialBatches.empty()) {
-        m_ssaoProcessor.prepareSSAOGBufferPass(appContext);
-
-        for (const auto& batch : m_materialBatches) {
-            batch.first->bindForPass(PassType::AmbientOcclusion, context);
+    m_ssaoProcessor.prepareSSAOGBufferPass(appContext);
 
-            for (const Renderable* obj : batch.second) {
-                context.tInfo.meshTransform = obj->getRenderableTransform();
-                batch.first->bindForObjectDraw(PassType::AmbientOcclusion, context);
-                obj->draw();
+    for (size_t begin = 0, end = 0; begin < m_renderQueue.size(); begin = end) {
+        end = m_renderQueue.runEnd(begin);
+        Material* material = m_renderQueue[begin].material;
 
-                m_objectsProcessed++;
-            }
+        material->bindForPass(PassType::AmbientOcclusion, context);
+        if (material->drawBatch(PassType::AmbientOcclusion, context, m_renderQueue.runObjects(begin, end))) {
+            m_objectsProcessed += end - begin;
+            continue;
         }
 
-        m_ssaoProcessor.prepareSSAOPass(appContext);
-        appContext.renderer->drawFullscreenQuad();
+        for (size_t i = begin; i < end; i++) {
+            const RenderProxy& packet = m_renderQueue[i];
+            context.tInfo.meshTransform = packet.transform;
+            material->bindForObjectDraw(PassType::AmbientOcclusion, context);
+            packet.renderable->draw();
 
-        m_ssaoProcessor.prepareSSAOBlurPass(appContext);
-        appContext.renderer->drawFullscreenQuad();
+            m_objectsProcessed++;
+        }
     }
 
-    m_materialBatches.clear();
+    m_ssaoProcessor.prepareSSAOPass(appContext);
+    appContext.renderer->drawFullscreenQuad();
+
+    m_ssaoProcessor.prepareSSAOBlurPass(appContext);
+    appContext.renderer->drawFullscreenQuad();
 }
 
 void SSAORenderpass::cleanup(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
@@ -56,6 +58,22 @@ void SSAORenderpass::cleanup(RenderContext& context, RenderResources& resources,
 
 const char* SSAORenderpass::name() { return "SSAO Renderpass"; }
 
+void SSAORenderpass::declareResources(RenderGraphBuilder& builder) { m_ssaoProcessor.declareTargets(builder); }
+
+bool SSAORenderpass::collectWork(RenderContext& context, RenderResources& resources) {
+    // Lower tiers are computed from the opaque depth by the depth SSAO pass instead
+    if (context.ssaoInfo.quality != SSAOQuality::High) return false;
+
+    m_renderQueue.build(resources.cameraVisibleObjects, PassType::AmbientOcclusion, resources.cameraPosition);
+    return !m_renderQueue.empty();
+}
+
+void SSAORenderpass::skip(RenderContext& context) {
+    context.ssaoInfo.output = nullptr;
+    m_ssaoProcessor.releaseTargets();
+    m_objectsProcessed = 0;
+}
+
 void SSAORenderpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
@@ -33,6 +33,12 @@ public:
 
     virtual const char* name() override;
 
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
+
+    virtual void skip(RenderContext& context) override;
+
     virtual void putDebugInfo(DebugReport& report) override;
 
     inline SSAOProcessor& getSSAOProcessor() { return m_ssaoProcessor; }
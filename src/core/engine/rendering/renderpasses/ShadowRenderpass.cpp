@@ -2,6 +2,7 @@
 
 #include <GL/glew.h>
 
+#include <cstring>
 #include <glm/vec2.hpp>
 
 #include "Application.h"
@@ -10,69 +11,273 @@
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
 
-void ShadowRenderpass::prepare(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
-    m_lightProcessor.clearShadowMaps();
+static constexpr uint64_t SIGNATURE_OFFSET_BASIS = 14695981039346656037ull;
+static constexpr uint64_t SIGNATURE_PRIME = 1099511628211ull;
+
+static inline uint64_t hashWords(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)) {
+        uint32_t word;
+        std::memcpy(&word, bytes + i, sizeof(uint32_t));
+        hash = (hash ^ word) * SIGNATURE_PRIME;
+    }
+    return hash;
+}
+
+// Hashes the light view and everything queued for its tile. Zero if the tile cannot be cached.
+static uint64_t computeShadowTileSignature(const glm::mat4& lightViewProjection, const RenderQueue& queue) {
+    uint64_t hash = hashWords(SIGNATURE_OFFSET_BASIS, &lightViewProjection, sizeof(glm::mat4));
+    for (size_t i = 0; i < queue.size(); i++) {
+        const RenderProxy& packet = queue[i];
+        uint64_t revision = packet.contentRevision;
+        if (revision == Renderable::DYNAMIC_CONTENT) return LightProcessor::UNCACHEABLE_SHADOW_TILE;
+
+        glm::vec3 position = packet.transform.getPosition();
+        glm::quat rotation = packet.transform.getRotationQuat();
+        float scale = packet.transform.getScale();
+        uintptr_t object = reinterpret_cast<uintptr_t>(packet.renderable);
+        uint16_t material = packet.material->sortId();
+
+        hash = hashWords(hash, &object, sizeof(object));
+        hash = hashWords(hash, &revision, sizeof(revision));
+        hash = hashWords(hash, &position, sizeof(position));
+        hash = hashWords(hash, &rotation, sizeof(rotation));
+        hash = hashWords(hash, &scale, sizeof(scale));
+        hash = (hash ^ material) * SIGNATURE_PRIME;
+    }
+    return hash == LightProcessor::UNCACHEABLE_SHADOW_TILE ? 1 : hash;
+}
+
+// Names of the caster culling groups by shadow tile size, the smallest tile is 128 texels
+static const char* const CASTER_CULLING_GROUPS[ShadowRenderpass::TILE_SIZE_CLASSES] = {
+    "128px shadow tiles", "256px shadow tiles", "512px shadow tiles", "1024px shadow tiles", "2048px shadow tiles"
+};
+
+static int tileSizeClass(const Light* light) {
+    unsigned int sizeUnits = light->getShadowTile() >> 16;
+    int sizeClass = 0;
+    while (sizeUnits > 1 && sizeClass < ShadowRenderpass::TILE_SIZE_CLASSES - 1) {
+        sizeUnits >>= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+// Bounds of the region casters of a light have to lie in to shadow any visible receiver. False if the light does not
+// reach any visible receiver, so nothing drawn into its tile could ever be sampled.
+static bool computeCasterBounds(
+    const Light* light,
+    const glm::mat4& lightViewProjection,
+    const std::vector<BoundingBox>& receiverBounds,
+    BoundingBox& casterBounds
+) {
+    // World bounds of the light frustum
+    glm::mat4 inverseViewProjection = glm::inverse(lightViewProjection);
+    BoundingBox frustumBounds = BoundingBox::invalid();
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec4 ndc(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f, 1.0f);
+        glm::vec4 world = inverseViewProjection * ndc;
+        glm::vec3 point = glm::vec3(world) / world.w;
+        frustumBounds.min = glm::min(frustumBounds.min, point);
+        frustumBounds.max = glm::max(frustumBounds.max, point);
+    }
+
+    // Visible receivers lit by the light, clipped to its frustum
+    const Frustum lightFrustum(lightViewProjection);
+    BoundingBox litBounds = BoundingBox::invalid();
+    for (const BoundingBox& receiver : receiverBounds) {
+        if (glm::any(glm::lessThan(receiver.max, frustumBounds.min)) ||
+            glm::any(glm::greaterThan(receiver.min, frustumBounds.max))) {
+            continue;
+        }
+        if (!lightFrustum.isBoxInside(receiver.min, receiver.max)) continue;
+
+        litBounds.min = glm::min(litBounds.min, receiver.min);
+        litBounds.max = glm::max(litBounds.max, receiver.max);
+    }
+    if (litBounds.isInvalid()) return false;
+    litBounds.min = glm::max(litBounds.min, frustumBounds.min);
+    litBounds.max = glm::min(litBounds.max, frustumBounds.max);
+
+    // Casters lie between the light and the lit receivers
+    if (light->getType() == LightType::Directional) {
+        glm::vec3 towardsLight = -light->getGlobalTransform().getForward() * light->getRange();
+        casterBounds = {
+            glm::min(litBounds.min, litBounds.min + towardsLight), glm::max(litBounds.max, litBounds.max + towardsLight)
+        };
+    } else {
+        glm::vec3 lightPosition = light->getGlobalTransform().getPosition();
+        casterBounds = {glm::min(litBounds.min, lightPosition), glm::max(litBounds.max, lightPosition)};
+    }
+    return true;
+}
 
-    context.tInfo.viewProjection = appContext.instance->m_player->getCamera()->getViewProjMatrix();
-    context.tInfo.viewportTransform = appContext.instance->m_player->getCamera()->getGlobalTransform();
-    m_lastLightCountPerPrio = LightProcessor::prioritizeLights(
-        *resources.lightsToRender, resources.priodLightsBuffer, m_lightProcessor.getShadowMapCounts(), context
+// Removes casters whose bounds do not overlap the caster bounds, keeping the order of the others
+static size_t clipCasters(const BoundingBox& casterBounds, std::vector<const RenderProxy*>& casters) {
+    size_t kept = 0;
+    for (const RenderProxy* caster : casters) {
+        const BoundingBox& bounds = caster->worldBounds;
+        if (glm::any(glm::lessThan(bounds.max, casterBounds.min)) ||
+            glm::any(glm::greaterThan(bounds.min, casterBounds.max))) {
+            continue;
+        }
+        casters[kept++] = caster;
+    }
+    size_t clipped = casters.size() - kept;
+    casters.resize(kept);
+    return clipped;
+}
+
+void ShadowRenderpass::prepare(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
+    std::shared_ptr<Camera> camera = appContext.instance->m_player->getCamera();
+    context.tInfo.viewProjection = camera->getViewProjMatrix();
+    context.tInfo.projection = camera->getProjectionMatrix();
+    context.tInfo.viewportTransform = camera->getGlobalTransform();
+    m_lightProcessor.assignShadowTiles(
+        *resources.lightsToRender, resources.priodLightsBuffer, context, m_lastRunTimeMs
     );
     context.lInfo.activeLightsCount = resources.priodLightsBuffer.size();
+    m_lastLightCount = resources.priodLightsBuffer.size();
     m_lightProcessor.updateBuffers(resources.priodLightsBuffer);
+
+    // Clusters are assigned on the workers while the shadow draws are recorded
+    context.lInfo.lightClustersEnabled = m_lightClusterProcessor.isEnabled();
+    if (m_lightClusterProcessor.isEnabled()) {
+        m_lightClusterProcessor.beginAssignment(
+            m_lightProcessor.getLightBuffer(), camera->getViewMatrix(), context.tInfo.projection,
+            camera->getViewDistance()
+        );
+    }
 }
 
 void ShadowRenderpass::execute(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
     m_objectsProcessed = 0;
+    m_casterCulling.fill({});
 
     for (int i = 0; i < resources.priodLightsBuffer.size(); i++) {
         const Light* light = resources.priodLightsBuffer[i];
-        context.lInfo.currentLightPrio = light->getPriotity();
-        context.lInfo.lightShadowAtlasIndex = light->getShadowAtlasIndex();
         context.tInfo.viewProjection = light->getViewProjMatrix();
         context.tInfo.viewportTransform = light->getGlobalTransform();
 
-        m_lightProcessor.prepareShadowPass(light);
+        // Cached tiles are signed and drawn with every caster in the light frustum, so a reused tile still holds the
+        // casters of receivers that came into view after it was drawn. Casters unable to shadow a visible receiver
+        // are only skipped in tiles that are redrawn every frame anyway.
+        CasterCullingStats& stats = m_casterCulling[tileSizeClass(light)];
+        stats.lights++;
+        resources.culledObjectsBuffer.clear();
+        BoundingBox casterBounds;
+        bool reachesReceivers = computeCasterBounds(
+            light, context.tInfo.viewProjection, resources.receiverBounds, casterBounds
+        );
+        if (reachesReceivers) {
+            const Frustum lightFrustum(context.tInfo.viewProjection);
+            cullBounds(lightFrustum, *resources.objectBounds, resources.culledObjectsBuffer);
+            if (resources.chunkGrid) resources.chunkGrid->query(lightFrustum, resources.culledObjectsBuffer);
+        } else {
+            stats.lightsWithoutReceivers++;
+        }
+        m_renderQueue.build(
+            resources.culledObjectsBuffer, PassType::ShadowPass, context.tInfo.viewportTransform.getPosition()
+        );
 
-        cullObjectsOutOfView(*resources.objectsToRender, resources.culledObjectsBuffer, context.tInfo.viewProjection);
-        batchByMaterialForPass(resources.culledObjectsBuffer, PassType::ShadowPass);
+        uint64_t signature = computeShadowTileSignature(context.tInfo.viewProjection, m_renderQueue);
+        if (reachesReceivers && signature == LightProcessor::UNCACHEABLE_SHADOW_TILE) {
+            stats.clippedCasters += clipCasters(casterBounds, resources.culledObjectsBuffer);
+            m_renderQueue.build(
+                resources.culledObjectsBuffer, PassType::ShadowPass, context.tInfo.viewportTransform.getPosition()
+            );
+        } else if (reachesReceivers) {
+            stats.unclippedLights++;
+        }
+        stats.casters += resources.culledObjectsBuffer.size();
+        if (!m_lightProcessor.prepareShadowTile(light, signature)) continue;
 
-        for (const auto& batch : m_materialBatches) {
-            batch.first->bindForPass(PassType::ShadowPass, context);
+        for (size_t begin = 0, end = 0; begin < m_renderQueue.size(); begin = end) {
+            end = m_renderQueue.runEnd(begin);
+            Material* material = m_renderQueue[begin].material;
+
+            material->bindForPass(PassType::ShadowPass, context);
+            if (material->drawBatch(PassType::ShadowPass, context, m_renderQueue.runObjects(begin, end))) {
+                m_objectsProcessed += end - begin;
+                continue;
+            }
 
-            for (const Renderable* obj : batch.second) {
-                context.tInfo.meshTransform = obj->getRenderableTransform();
-                batch.first->bindForObjectDraw(PassType::ShadowPass, context);
-                obj->draw();
+            for (size_t i = begin; i < end; i++) {
+                const RenderProxy& packet = m_renderQueue[i];
+                context.tInfo.meshTransform = packet.transform;
+                material->bindForObjectDraw(PassType::ShadowPass, context);
+                packet.renderable->draw();
 
                 m_objectsProcessed++;
             }
         }
-        m_materialBatches.clear();
     }
 }
 
 void ShadowRenderpass::cleanup(RenderContext& context, RenderResources& resources, const ApplicationContext& appContext) {
+    m_lightProcessor.finishShadowTiles();
+    m_lightProcessor.takeShadowTileCounts(m_lastReusedTiles, m_lastRedrawnTiles, m_lastReassignedTiles);
 
+    if (context.lInfo.lightClustersEnabled) {
+        m_lightClusterProcessor.finishAssignment();
+        context.lInfo.lightClusterDepthParams = m_lightClusterProcessor.getDepthSliceParams();
+    }
 }
 
 const char* ShadowRenderpass::name() { return "Shadow Pass"; }
 
+void ShadowRenderpass::declareResources(RenderGraphBuilder& builder) { builder.writeExternal("Light data"); }
+
+bool ShadowRenderpass::collectWork(RenderContext& context, RenderResources& resources) {
+    return !resources.lightsToRender->empty();
+}
+
+void ShadowRenderpass::skip(RenderContext& context) {
+    context.lInfo.activeLightsCount = 0;
+    context.lInfo.lightClustersEnabled = false;
+    m_objectsProcessed = 0;
+    m_lastLightCount = 0;
+    m_casterCulling.fill({});
+}
+
 void ShadowRenderpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
     report.addCounter("Objects processed", static_cast<int>(m_objectsProcessed));
+    report.addCounter("Lights processed", static_cast<int>(m_lastLightCount));
+    report.addCounter("Shadow atlas usage %", static_cast<int>(m_lightProcessor.getShadowAtlasUsage() * 100.0f));
+    report.addCounter("Shadow quality %", static_cast<int>(m_lightProcessor.getShadowQuality() * 100.0f));
+    report.addCounter("Reassigned shadow tiles", m_lastReassignedTiles);
+    report.addCounter("Reused shadow tiles", m_lastReusedTiles);
+    report.addCounter("Redrawn shadow tiles", m_lastRedrawnTiles);
+
+    report.beginGroup("Caster culling");
+    for (int sizeClass = 0; sizeClass < TILE_SIZE_CLASSES; sizeClass++) {
+        const CasterCullingStats& stats = m_casterCulling[sizeClass];
+        if (stats.lights == 0) continue;
 
-    int totalLightCount = 0;
-    for (int prio = LightPriority::High; prio <= LightPriority::Count; prio++) {
-        totalLightCount += static_cast<int>(m_lastLightCountPerPrio[prio]);
+        size_t candidates = stats.casters + stats.clippedCasters;
+        report.beginGroup(CASTER_CULLING_GROUPS[sizeClass]);
+        report.addCounter("Lights", static_cast<int>(stats.lights));
+        report.addCounter("Lights without visible receivers", static_cast<int>(stats.lightsWithoutReceivers));
+        report.addCounter("Lights drawn unclipped", static_cast<int>(stats.unclippedLights));
+        report.addCounter("Casters drawn", static_cast<int>(stats.casters));
+        report.addCounter(
+            "Casters culled %", candidates ? static_cast<int>(stats.clippedCasters * 100 / candidates) : 0
+        );
+        report.endGroup();
     }
+    report.endGroup();
 
-    report.addCounter("Lights processed", static_cast<int>(totalLightCount));
-    report.addCounter("- [HIGH] Prio Lights", static_cast<int>(m_lastLightCountPerPrio[LightPriority::High]));
-    report.addCounter("- [MEDIUM] Prio Lights", static_cast<int>(m_lastLightCountPerPrio[LightPriority::Medium]));
-    report.addCounter("- [LOW] Prio Lights", static_cast<int>(m_lastLightCountPerPrio[LightPriority::Low]));
+    if (m_lightClusterProcessor.isEnabled()) {
+        report.addTimeMs("Light cluster assignment", m_lightClusterProcessor.lastAssignmentTimeMs());
+        report.addCounter("Clustered light indices", static_cast<int>(m_lightClusterProcessor.lastIndexCount()));
+        report.addCounter(
+            "Max lights per cluster", static_cast<int>(m_lightClusterProcessor.lastMaxLightsPerCluster())
+        );
+    }
     report.endGroup();
 }
@@ -3,14 +3,34 @@
 
 #include <stddef.h>
 
+#include <array>
+
 #include "engine/rendering/renderpasses/Renderpass.h"
+#include "engine/rendering/renderpasses/processors/LightClusterProcessor.h"
 #include "engine/rendering/renderpasses/processors/LightProcessor.h"
 
 class ShadowRenderpass : public Renderpass {
+public:
+    // Shadow tile sizes from 128 to 2048 texels, caster culling is reported per size
+    static constexpr int TILE_SIZE_CLASSES = 5;
+
 private:
+    struct CasterCullingStats {
+        size_t lights;
+        size_t lightsWithoutReceivers;
+        size_t unclippedLights;  // Cacheable tiles, they draw every caster in the light frustum
+        size_t casters;
+        size_t clippedCasters;  // Inside the light frustum, but unable to shadow a visible receiver
+    };
+
     LightProcessor m_lightProcessor;
+    LightClusterProcessor m_lightClusterProcessor;
     size_t m_objectsProcessed;
-    std::array<unsigned int, LightPriority::Count> m_lastLightCountPerPrio;
+    size_t m_lastLightCount;
+    int m_lastReusedTiles;
+    int m_lastRedrawnTiles;
+    int m_lastReassignedTiles;
+    std::array<CasterCullingStats, TILE_SIZE_CLASSES> m_casterCulling;
 
 protected:
     virtual void prepare(
@@ -34,9 +54,17 @@ public:
 
     virtual const char* name() override;
 
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
+
+    virtual void skip(RenderContext& context) override;
+
     virtual void putDebugInfo(DebugReport& report) override;
 
     inline LightProcessor& getLightProcessor() { return m_lightProcessor; };
+
+    inline LightClusterProcessor& getLightClusterProcessor() { return m_lightClusterProcessor; };
 };
 
 #endif
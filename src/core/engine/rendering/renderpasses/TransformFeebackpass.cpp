@@ -10,7 +10,9 @@
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 #include "engine/rendering/particles/ParticleSystem.h"
 
 void TransformFeedbackpass::prepare(
@@ -18,7 +20,7 @@ void TransformFeedbackpass::prepare(
     RenderResources& resources,
     const ApplicationContext& appContext
 ) {
-    GLCALL(glEnable(GL_RASTERIZER_DISCARD));
+    GLStateCache::setRasterizerDiscard(true);
     context.tInfo.viewProjection = appContext.instance->m_player->getCamera()->getViewProjMatrix();
     context.tInfo.viewportTransform = appContext.instance->m_player->getCamera()->getGlobalTransform();
 }
@@ -28,30 +30,28 @@ void TransformFeedbackpass::execute(
     RenderResources& resources,
     const ApplicationContext& appContext
 ) {
-    cullObjectsOutOfView(*resources.objectsToRender, resources.culledObjectsBuffer, context.tInfo.viewProjection);
-    batchByMaterialForPass(resources.culledObjectsBuffer, PassType::TransformFeedback);
+    for (size_t begin = 0, end = 0; begin < m_renderQueue.size(); begin = end) {
+        end = m_renderQueue.runEnd(begin);
+        Material* material = m_renderQueue[begin].material;
+        material->bindForPass(PassType::TransformFeedback, context);
 
-    m_objectsProcessed = 0;
-    for (auto& batch : m_materialBatches) {
-        batch.first->bindForPass(PassType::TransformFeedback, context);
-
-        for (Renderable* obj : batch.second) {
-            if (ParticleSystem* ps = dynamic_cast<ParticleSystem*>(obj)) {
+        for (size_t i = begin; i < end; i++) {
+            const RenderProxy& packet = m_renderQueue[i];
+            if (packet.type == DrawPacketType::ParticleSystem) {
+                ParticleSystem* ps = static_cast<ParticleSystem*>(packet.renderable);
                 ps->switchBuffers();
-                context.tInfo.meshTransform = ps->getRenderableTransform();
+                context.tInfo.meshTransform = packet.transform;
                 context.pInfo.pModulesBuff = ps->getModulesUBO();
                 context.pInfo.spawnCount = ps->getSpawnCount();
                 context.pInfo.particleSpawnOffset = ps->getParticleSpawnOffset();
                 context.pInfo.allocatedParticleCount = ps->getAllocatedParticleCount();
                 context.pInfo.flags = ps->getFlags();
-                batch.first->bindForObjectDraw(PassType::TransformFeedback, context);
+                material->bindForObjectDraw(PassType::TransformFeedback, context);
                 ps->compute();
             }
             m_objectsProcessed++;
         }
     }
-
-    m_materialBatches.clear();
 }
 
 void TransformFeedbackpass::cleanup(
@@ -59,11 +59,19 @@ void TransformFeedbackpass::cleanup(
     RenderResources& resources,
     const ApplicationContext& appContext
 ) {
-    GLCALL(glDisable(GL_RASTERIZER_DISCARD));
+    GLStateCache::setRasterizerDiscard(false);
 }
 
 const char* TransformFeedbackpass::name() { return "Transform Feedback Pass"; }
 
+void TransformFeedbackpass::declareResources(RenderGraphBuilder& builder) { builder.writeExternal("Particle state"); }
+
+bool TransformFeedbackpass::collectWork(RenderContext& context, RenderResources& resources) {
+    m_objectsProcessed = 0;
+    m_renderQueue.build(resources.cameraVisibleObjects, PassType::TransformFeedback, resources.cameraPosition);
+    return !m_renderQueue.empty();
+}
+
 void TransformFeedbackpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
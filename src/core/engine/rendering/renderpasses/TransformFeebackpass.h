@@ -31,6 +31,10 @@ public:
 
     virtual const char* name() override;
 
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
+
     virtual void putDebugInfo(DebugReport& report) override;
 };
 
@@ -8,7 +8,9 @@
 #include "engine/rendering/Camera.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 static constexpr float zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
 static constexpr float one[] = {1.0f, 1.0f, 1.0f, 1.0f};
@@ -18,23 +20,19 @@ void TransparencyRenderpass::prepare(
     RenderResources& resources,
     const ApplicationContext& appContext
 ) {
-    if (context.screenResChanged) {
-        createBuffers(context);
-    }
-
+    // Depth tested against the opaque scene
+    resources.renderGraph->attachTargets(m_accAndResBuffer, {m_accumTarget, m_revealTarget, m_depthTarget});
     m_accAndResBuffer.bind();
     GLCALL(glClearBufferfv(GL_COLOR, 0, zero));
     GLCALL(glClearBufferfv(GL_COLOR, 1, one));  // Reveal target must start at 1.0f
 
-    GLCALL(glEnable(GL_BLEND));
+    GLStateCache::setBlend(true);
 
-    GLCALL(glBlendEquationi(0, GL_FUNC_ADD));
-    GLCALL(glBlendFunci(0, GL_ONE, GL_ONE));
-    GLCALL(glBlendEquationi(1, GL_FUNC_ADD));
-    GLCALL(glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR));
+    GLStateCache::setBlendForBuffer(0, GL_FUNC_ADD, GL_ONE, GL_ONE);
+    GLStateCache::setBlendForBuffer(1, GL_FUNC_ADD, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
 
     // Disable depth write, transparent pixels do not cover objects
-    GLCALL(glDepthMask(GL_FALSE));
+    GLStateCache::setDepthMask(false);
 
     context.tInfo.viewProjection = appContext.instance->m_player->getCamera()->getViewProjMatrix();
     context.tInfo.projection = appContext.instance->m_player->getCamera()->getProjectionMatrix();
@@ -49,22 +47,20 @@ void TransparencyRenderpass::execute(
 ) {
     m_objectsProcessed = 0;
 
-    cullObjectsOutOfView(*resources.objectsToRender, resources.culledObjectsBuffer, context.tInfo.viewProjection);
-    batchByMaterialForPass(resources.culledObjectsBuffer, PassType::TransparencyPass);
+    for (size_t begin = 0, end = 0; begin < m_renderQueue.size(); begin = end) {
+        end = m_renderQueue.runEnd(begin);
+        Material* material = m_renderQueue[begin].material;
+        material->bindForPass(PassType::TransparencyPass, context);
 
-    for (const auto& batch : m_materialBatches) {
-        batch.first->bindForPass(PassType::TransparencyPass, context);
-
-        for (const Renderable* obj : batch.second) {
-            context.tInfo.meshTransform = obj->getRenderableTransform();
-            batch.first->bindForObjectDraw(PassType::TransparencyPass, context);
-            obj->draw();
+        for (size_t i = begin; i < end; i++) {
+            const RenderProxy& packet = m_renderQueue[i];
+            context.tInfo.meshTransform = packet.transform;
+            material->bindForObjectDraw(PassType::TransparencyPass, context);
+            packet.renderable->draw();
 
             m_objectsProcessed++;
         }
     }
-
-    m_materialBatches.clear();
 }
 
 void TransparencyRenderpass::cleanup(
@@ -72,36 +68,46 @@ void TransparencyRenderpass::cleanup(
     RenderResources& resources,
     const ApplicationContext& appContext
 ) {
-    GLCALL(glDisable(GL_BLEND));
-    GLCALL(glDepthMask(GL_TRUE));
+    GLStateCache::setBlend(false);
+    GLStateCache::setDepthMask(true);
 
     context.transparencyInfo.accumOutput = m_accAndResBuffer.getAttachedTextures().at(0).get();
     context.transparencyInfo.revealOutput = m_accAndResBuffer.getAttachedTextures().at(1).get();
 }
 
-TransparencyRenderpass::TransparencyRenderpass() { m_accAndResBuffer = FrameBuffer::create(); }
+TransparencyRenderpass::TransparencyRenderpass()
+    : m_accumTarget(-1), m_revealTarget(-1), m_depthTarget(-1), m_objectsProcessed(0) {
+    m_accAndResBuffer = FrameBuffer::create();
+}
 
 const char* TransparencyRenderpass::name() { return "Transparency Renderpass"; }
 
+void TransparencyRenderpass::declareResources(RenderGraphBuilder& builder) {
+    m_accumTarget = builder.createTexture("Transparency accumulation", {TextureType::Float16, 4});
+    m_revealTarget = builder.createTexture("Transparency reveal", {TextureType::Float16, 1});
+    m_depthTarget = builder.read("Scene depth");
+    builder.read("Particle state", true);
+    builder.read("Light data", true);
+}
+
+bool TransparencyRenderpass::collectWork(RenderContext& context, RenderResources& resources) {
+    // Weighted blended transparency is order independent, sorting only groups shared state
+    m_renderQueue.build(resources.cameraVisibleObjects, PassType::TransparencyPass, resources.cameraPosition);
+    return !m_renderQueue.empty();
+}
+
+void TransparencyRenderpass::skip(RenderContext& context) {
+    context.transparencyInfo.accumOutput = nullptr;
+    context.transparencyInfo.revealOutput = nullptr;
+    m_objectsProcessed = 0;
+
+    // Attached targets would stay allocated after the pool drops them
+    if (!m_accAndResBuffer.getAttachedTextures().empty()) m_accAndResBuffer.clearAttachedTextures();
+}
+
 void TransparencyRenderpass::putDebugInfo(DebugReport& report) {
     report.beginGroup(name());
     report.addTimeMs("Processing Time", m_lastRunTimeMs);
     report.addCounter("Objects processed", static_cast<int>(m_objectsProcessed));
     report.endGroup();
 }
-
-void TransparencyRenderpass::createBuffers(RenderContext& context) {
-    m_accAndResBuffer.clearAttachedTextures();
-    m_accAndResBuffer.attachTexture(
-        std::make_shared<Texture>(  // Color accumulate render target
-            Texture::create(TextureType::Float16, context.currScreenRes.x, context.currScreenRes.y, 4)
-        )
-    );
-    m_accAndResBuffer.attachTexture(
-        std::make_shared<Texture>(  // Reveal alpha render target
-            Texture::create(TextureType::Float16, context.currScreenRes.x, context.currScreenRes.y, 1)
-        )
-    );
-    // Use same depth buffer as opaque pass !!! OPAQUE PASS MUST RESIZE !!!
-    m_accAndResBuffer.attachTexture(context.opaqueInfo.usedDepthTexture);
-}
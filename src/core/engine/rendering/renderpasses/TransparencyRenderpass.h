@@ -1,6 +1,7 @@
 #ifndef TOOMANYBLOCKS_TRANSPARENCYRENDERPASS_H
 #define TOOMANYBLOCKS_TRANSPARENCYRENDERPASS_H
 
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/lowlevelapi/FrameBuffer.h"
 #include "engine/rendering/lowlevelapi/Shader.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
@@ -9,6 +10,9 @@
 class TransparencyRenderpass : public Renderpass {
 private:
     FrameBuffer m_accAndResBuffer;
+    RenderGraphResource m_accumTarget;
+    RenderGraphResource m_revealTarget;
+    RenderGraphResource m_depthTarget;
     size_t m_objectsProcessed;
 
 protected:
@@ -34,9 +38,13 @@ public:
 
     virtual const char* name() override;
 
-    virtual void putDebugInfo(DebugReport& report) override;
+    virtual void declareResources(RenderGraphBuilder& builder) override;
+
+    virtual bool collectWork(RenderContext& context, RenderResources& resources) override;
 
-    void createBuffers(RenderContext& context);
+    virtual void skip(RenderContext& context) override;
+
+    virtual void putDebugInfo(DebugReport& report) override;
 };
 
 #endif
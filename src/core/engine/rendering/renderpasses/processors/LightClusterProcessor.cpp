@@ -0,0 +1,203 @@
+#include "LightClusterProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Application.h"
+#include "foundation/threading/Future.h"
+#include "foundation/threading/ThreadPool.h"
+
+static constexpr int CLUSTER_COUNT = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z;
+static constexpr size_t INITIAL_INDEX_CAPACITY = 16 * 1024;
+
+// Fewer slices per job are not worth the scheduling overhead
+static constexpr int MIN_SLICES_PER_JOB = 4;
+
+static inline bool sphereIntersectsBox(
+    const glm::vec3& center, float radius, const glm::vec3& min, const glm::vec3& max
+) {
+    glm::vec3 closest = glm::clamp(center, min, max);
+    glm::vec3 delta = center - closest;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+LightClusterProcessor::LightClusterProcessor()
+    : m_state(std::make_shared<AssignmentState>()),
+      m_assignmentRunning(false),
+      m_enabled(true),
+      m_lastIndexCount(0),
+      m_lastMaxLightsPerCluster(0),
+      m_lastAssignmentTimeMs(0.0f) {
+    m_state->clusters.resize(CLUSTER_COUNT);
+    m_state->depthScale = 0.0f;
+    m_state->depthBias = 0.0f;
+
+    m_clusterBuffer.resize(CLUSTER_COUNT);
+    m_indexBuffer.reserve(INITIAL_INDEX_CAPACITY);
+    m_clusterStorage = ShaderStorageBuffer::create(nullptr, CLUSTER_COUNT * sizeof(glm::uvec2));
+    m_indexStorage = ShaderStorageBuffer::create(nullptr, INITIAL_INDEX_CAPACITY * sizeof(uint32_t));
+}
+
+float LightClusterProcessor::sliceDepth(const AssignmentState& state, int slice) {
+    if (slice <= 0) return 0.0f;
+    if (slice >= LIGHT_CLUSTERS_Z) return state.farDepth;
+    return LIGHT_CLUSTER_NEAR_DEPTH * std::exp(static_cast<float>(slice - 1) / state.depthScale);
+}
+
+void LightClusterProcessor::assignSlice(AssignmentState& state, int slice) {
+    float nearDepth = sliceDepth(state, slice);
+    float farDepth = sliceDepth(state, slice + 1);
+
+    // Only lights reaching into the depth range of the slice are tested against its clusters
+    thread_local std::vector<uint32_t> sliceLights;
+    sliceLights.clear();
+    for (size_t i = 0; i < state.lights.size(); i++) {
+        const ClusterLight& light = state.lights[i];
+        float depth = -light.center.z;
+        if (light.global || (depth + light.radius >= nearDepth && depth - light.radius <= farDepth)) {
+            sliceLights.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    std::vector<uint32_t>& indices = state.sliceIndices[slice];
+    indices.clear();
+    for (int y = 0; y < LIGHT_CLUSTERS_Y; y++) {
+        float ndcMinY = -1.0f + 2.0f * static_cast<float>(y) / LIGHT_CLUSTERS_Y;
+        float ndcMaxY = -1.0f + 2.0f * static_cast<float>(y + 1) / LIGHT_CLUSTERS_Y;
+        float minY = std::min(ndcMinY * nearDepth, ndcMinY * farDepth) * state.unprojectScale.y;
+        float maxY = std::max(ndcMaxY * nearDepth, ndcMaxY * farDepth) * state.unprojectScale.y;
+
+        for (int x = 0; x < LIGHT_CLUSTERS_X; x++) {
+            float ndcMinX = -1.0f + 2.0f * static_cast<float>(x) / LIGHT_CLUSTERS_X;
+            float ndcMaxX = -1.0f + 2.0f * static_cast<float>(x + 1) / LIGHT_CLUSTERS_X;
+            float minX = std::min(ndcMinX * nearDepth, ndcMinX * farDepth) * state.unprojectScale.x;
+            float maxX = std::max(ndcMaxX * nearDepth, ndcMaxX * farDepth) * state.unprojectScale.x;
+
+            glm::vec3 boxMin(minX, minY, -farDepth);
+            glm::vec3 boxMax(maxX, maxY, -nearDepth);
+            uint32_t offset = static_cast<uint32_t>(indices.size());
+            for (uint32_t lightIndex : sliceLights) {
+                const ClusterLight& light = state.lights[lightIndex];
+                if (light.global || sphereIntersectsBox(light.center, light.radius, boxMin, boxMax)) {
+                    indices.push_back(lightIndex);
+                }
+            }
+
+            int cluster = (slice * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x;
+            state.clusters[cluster] = glm::uvec2(offset, static_cast<uint32_t>(indices.size()) - offset);
+        }
+    }
+}
+
+void LightClusterProcessor::assignPendingSlices(AssignmentState& state) {
+    for (int slice = state.nextSlice.fetch_add(1); slice < LIGHT_CLUSTERS_Z; slice = state.nextSlice.fetch_add(1)) {
+        assignSlice(state, slice);
+        state.finishedSlices.fetch_add(1);
+    }
+}
+
+void LightClusterProcessor::beginAssignment(
+    const std::vector<GPULight>& lights, const glm::mat4& view, const glm::mat4& projection, float farDepth
+) {
+    if (m_assignmentRunning) finishAssignment();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Jobs of the last frame may still be queued, but they can not claim a slice before the counters are reset
+    AssignmentState& state = *m_state;
+    state.farDepth = std::max(farDepth, LIGHT_CLUSTER_NEAR_DEPTH * 2.0f);
+    state.depthScale = static_cast<float>(LIGHT_CLUSTERS_Z - 1) / std::log(state.farDepth / LIGHT_CLUSTER_NEAR_DEPTH);
+    state.depthBias = -std::log(LIGHT_CLUSTER_NEAR_DEPTH) * state.depthScale;
+    state.unprojectScale = glm::vec2(1.0f / projection[0][0], 1.0f / projection[1][1]);
+
+    state.lights.clear();
+    for (const GPULight& light : lights) {
+        ClusterLight clusterLight{glm::vec3(0.0f), 0.0f, false};
+        LightType type = static_cast<LightType>(light.lightType);
+        if (type == LightType::Directional) {
+            clusterLight.global = true;
+        } else if (type == LightType::Spot) {
+            // Tightest sphere around the cone, either around its cap or through its apex and cap rim
+            float halfAngle = glm::radians(light.fovy * 0.5f);
+            float cosHalfAngle = std::cos(halfAngle);
+            glm::vec3 center;
+            if (halfAngle > glm::radians(45.0f)) {
+                center = light.lightPosition + light.direction * (light.range * cosHalfAngle);
+                clusterLight.radius = light.range * std::sin(halfAngle);
+            } else {
+                clusterLight.radius = light.range / (2.0f * cosHalfAngle);
+                center = light.lightPosition + light.direction * clusterLight.radius;
+            }
+            clusterLight.center = glm::vec3(view * glm::vec4(center, 1.0f));
+        } else {
+            clusterLight.center = glm::vec3(view * glm::vec4(light.lightPosition, 1.0f));
+            clusterLight.radius = light.range;
+        }
+        state.lights.push_back(clusterLight);
+    }
+
+    state.finishedSlices.store(0);
+    state.nextSlice.store(0);
+    m_assignmentRunning = true;
+
+    // Jobs still queued from earlier frames pick up slices as well, only top up to one job per worker
+    ThreadPool* pool = Application::getContext()->workerPool;
+    int wantedJobs = std::min(static_cast<int>(pool->threadCount()), LIGHT_CLUSTERS_Z / MIN_SLICES_PER_JOB);
+    while (state.queuedJobs.load() < wantedJobs) {
+        state.queuedJobs.fetch_add(1);
+        Future<void> job([shared = m_state]() {
+            assignPendingSlices(*shared);
+            shared->queuedJobs.fetch_sub(1);
+        });
+        job.start();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastAssignmentTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void LightClusterProcessor::finishAssignment() {
+    if (!m_assignmentRunning) return;
+    m_assignmentRunning = false;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Help with slices no worker picked up yet, then wait for the ones in progress
+    AssignmentState& state = *m_state;
+    assignPendingSlices(state);
+    while (state.finishedSlices.load() < LIGHT_CLUSTERS_Z) {
+        std::this_thread::yield();
+    }
+
+    // Concatenate the lists of all slices and rebase the cluster offsets onto the combined list
+    m_indexBuffer.clear();
+    m_lastMaxLightsPerCluster = 0;
+    for (int slice = 0; slice < LIGHT_CLUSTERS_Z; slice++) {
+        uint32_t base = static_cast<uint32_t>(m_indexBuffer.size());
+        const std::vector<uint32_t>& indices = state.sliceIndices[slice];
+        m_indexBuffer.insert(m_indexBuffer.end(), indices.begin(), indices.end());
+
+        int first = slice * LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+        for (int cluster = first; cluster < first + LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y; cluster++) {
+            m_clusterBuffer[cluster] = glm::uvec2(state.clusters[cluster].x + base, state.clusters[cluster].y);
+            m_lastMaxLightsPerCluster = std::max(m_lastMaxLightsPerCluster, state.clusters[cluster].y);
+        }
+    }
+    m_lastIndexCount = m_indexBuffer.size();
+
+    size_t indexBytes = m_indexBuffer.size() * sizeof(uint32_t);
+    if (indexBytes > m_indexStorage.getByteSize()) {
+        m_indexStorage = ShaderStorageBuffer::create(nullptr, std::max(indexBytes, m_indexStorage.getByteSize() * 2));
+    }
+    m_clusterStorage.updateData(m_clusterBuffer.data(), m_clusterBuffer.size() * sizeof(glm::uvec2));
+    if (indexBytes > 0) m_indexStorage.updateData(m_indexBuffer.data(), indexBytes);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastAssignmentTimeMs += std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+glm::vec2 LightClusterProcessor::getDepthSliceParams() const {
+    return glm::vec2(m_state->depthScale, m_state->depthBias);
+}
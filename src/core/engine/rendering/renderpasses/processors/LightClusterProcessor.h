@@ -0,0 +1,109 @@
+#ifndef TOOMANYBLOCKS_LIGHTCLUSTERPROCESSOR_H
+#define TOOMANYBLOCKS_LIGHTCLUSTERPROCESSOR_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "engine/env/lights/Light.h"
+#include "engine/rendering/lowlevelapi/ShaderStorageBuffer.h"
+
+// Froxel grid, must match the defines of the chunk shader
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+
+// The first depth slice covers everything closer than this, the others are spaced logarithmically up to the far plane
+#define LIGHT_CLUSTER_NEAR_DEPTH 1.0f
+
+/**
+ * @brief Assigns lights to the clusters of a view frustum aligned grid, so shaders only evaluate nearby lights.
+ *
+ * Depth slices are assigned by worker threads while the shadow pass records its draws, the main thread helps with
+ * any slice not picked up yet once the result is needed. The result is uploaded as one (offset, count) pair per
+ * cluster and a compact list of light indices.
+ */
+class LightClusterProcessor {
+private:
+    // Bounding sphere of a light in view space, directional lights reach every cluster
+    struct ClusterLight {
+        glm::vec3 center;
+        float radius;
+        bool global;
+    };
+
+    // Shared with the assignment jobs, which may outlive a frame if the worker pool is busy
+    struct AssignmentState {
+        std::vector<ClusterLight> lights;
+        float depthScale;
+        float depthBias;
+        float farDepth;
+        glm::vec2 unprojectScale;  // View space extent per unit of view depth at the edge of the screen
+
+        std::vector<glm::uvec2> clusters;  // Offset into the list of its slice and light count
+        std::array<std::vector<uint32_t>, LIGHT_CLUSTERS_Z> sliceIndices;
+
+        std::atomic<int> nextSlice{LIGHT_CLUSTERS_Z};
+        std::atomic<int> finishedSlices{LIGHT_CLUSTERS_Z};
+        std::atomic<int> queuedJobs{0};
+    };
+
+    std::shared_ptr<AssignmentState> m_state;
+    bool m_assignmentRunning;
+    bool m_enabled;
+
+    std::vector<glm::uvec2> m_clusterBuffer;
+    std::vector<uint32_t> m_indexBuffer;
+    ShaderStorageBuffer m_clusterStorage;
+    ShaderStorageBuffer m_indexStorage;
+
+    size_t m_lastIndexCount;
+    uint32_t m_lastMaxLightsPerCluster;
+    float m_lastAssignmentTimeMs;
+
+    static float sliceDepth(const AssignmentState& state, int slice);
+    static void assignSlice(AssignmentState& state, int slice);
+    static void assignPendingSlices(AssignmentState& state);
+
+public:
+    LightClusterProcessor();
+
+    /**
+     * @brief Starts assigning the given lights to clusters on the worker threads.
+     *
+     * @param lights Lights in the order of the light uniform buffer, cluster lists index into it.
+     * @param view View matrix of the camera.
+     * @param projection Symmetric perspective projection of the camera.
+     * @param farDepth Distance of the far plane.
+     */
+    void beginAssignment(
+        const std::vector<GPULight>& lights, const glm::mat4& view, const glm::mat4& projection, float farDepth
+    );
+
+    /**
+     * @brief Completes the assignment started last and uploads the clusters.
+     */
+    void finishAssignment();
+
+    /** @return Scale and bias mapping the log of a view depth to its depth slice. */
+    glm::vec2 getDepthSliceParams() const;
+
+    inline bool isEnabled() const { return m_enabled; }
+
+    inline void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    inline const ShaderStorageBuffer* getClusterBuffer() const { return &m_clusterStorage; }
+
+    inline const ShaderStorageBuffer* getIndexBuffer() const { return &m_indexStorage; }
+
+    inline size_t lastIndexCount() const { return m_lastIndexCount; }
+
+    inline uint32_t lastMaxLightsPerCluster() const { return m_lastMaxLightsPerCluster; }
+
+    inline float lastAssignmentTimeMs() const { return m_lastAssignmentTimeMs; }
+};
+
+#endif
@@ -2,28 +2,74 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "engine/env/lights/Spotlight.h"
 #include "engine/geometry/BoundingVolume.h"
 #include "engine/rendering/Frustum.h"
 #include "engine/rendering/GLUtils.h"
 #include "engine/rendering/Renderer.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 
 #define SHADOWMAP_ATLAS_RESOLUTION 4096
-#define HIGHPRIO_SHADOWMAP_SIZE    2048
-#define MEDIUMPRIO_SHADOWMAP_SIZE  1024
-#define LOWPRIO_SHADOWMAP_SIZE     512
+#define MAX_SHADOWMAP_SIZE         2048
+#define MIN_SHADOWMAP_SIZE         128
+
+static constexpr float SHADOW_PASS_BUDGET_MS = 4.0f;
+static constexpr float MIN_SHADOW_QUALITY = 0.25f;
 
-std::array<unsigned int, LightPriority::Count> LightProcessor::prioritizeLights(
+static unsigned int packShadowTile(const ShadowAtlasTile& tile, int tileSize, int tileUnit) {
+    unsigned int unitsPerTile = static_cast<unsigned int>(tileSize / tileUnit);
+    unsigned int x = static_cast<unsigned int>(tile.x) * unitsPerTile;
+    unsigned int y = static_cast<unsigned int>(tile.y) * unitsPerTile;
+    return x | (y << 8) | (unitsPerTile << 16);
+}
+
+int LightProcessor::tileLevelForLight(const Light* light, const RenderContext& context) const {
+    // Projected radius of the light's range in units of half the screen height
+    glm::vec3 cameraPosition = context.tInfo.viewportTransform.getPosition();
+    float distance = glm::distance(cameraPosition, light->getGlobalTransform().getPosition());
+    float projectedRadius = 1.0f;
+    if (distance > light->getRange()) {
+        projectedRadius = light->getRange() / distance * context.tInfo.projection[1][1];
+    }
+    float wantedSize = projectedRadius * static_cast<float>(context.currScreenRes.y) * m_shadowQuality;
+
+    int level = m_atlasAllocator.levelCount() - 1;
+    while (level > 0 && m_atlasAllocator.tileSize(level) < MAX_SHADOWMAP_SIZE &&
+           static_cast<float>(m_atlasAllocator.tileSize(level)) < wantedSize) {
+        level--;
+    }
+    return level;
+}
+
+void LightProcessor::assignTile(ShadowTileAssignment& assignment, const ShadowAtlasTile& tile) {
+    assignment.tile = tile;
+    assignment.signature = UNCACHEABLE_SHADOW_TILE;
+    m_reassignedShadowTiles++;
+}
+
+void LightProcessor::assignShadowTiles(
     const std::vector<Light*>& lights,
     std::vector<Light*>& outputBuffer,
-    const std::array<unsigned int, LightPriority::Count>& maxShadowMapsPerPriority,
-    const RenderContext& context
+    const RenderContext& context,
+    float lastShadowPassMs
 ) {
     struct ScoredLight {
         Light* valPtr;
         float score;
+        int level;
+        ShadowTileAssignment* assignment;
     };
 
+    m_frame++;
+    if (lastShadowPassMs > SHADOW_PASS_BUDGET_MS) {
+        m_shadowQuality = std::max(m_shadowQuality * 0.9f, MIN_SHADOW_QUALITY);
+    } else if (lastShadowPassMs < SHADOW_PASS_BUDGET_MS * 0.5f) {
+        m_shadowQuality = std::min(m_shadowQuality * 1.05f, 1.0f);
+    }
+
     const Frustum cameraFrustum(context.tInfo.viewProjection);
 
     // Calculate scores for lights
@@ -37,79 +83,100 @@ std::array<unsigned int, LightPriority::Count> LightProcessor::prioritizeLights(
         }
         float distance = glm::distance(cameraPosition, light->getGlobalTransform().getPosition());
         float score = (1.0f / (distance + 1.0f)) * light->getRange();
-        scoredLights.push_back({light, score});
+        scoredLights.push_back({light, score, 0, nullptr});
     }
 
     // Sort lights by score in descending order
     std::sort(scoredLights.begin(), scoredLights.end(), [](const ScoredLight& a, const ScoredLight& b) {
         return a.score > b.score;
     });
+    if (scoredLights.size() > m_totalSupportedLights) scoredLights.resize(m_totalSupportedLights);
+
+    // Keep tiles whose size is still close to the wanted one, so cached shadows survive small camera movements
+    for (ScoredLight& sLight : scoredLights) {
+        sLight.level = tileLevelForLight(sLight.valPtr, context);
+        sLight.assignment = &m_shadowTiles[sLight.valPtr];
+        sLight.assignment->lastUsedFrame = m_frame;
+
+        ShadowAtlasTile& tile = sLight.assignment->tile;
+        if (tile.isValid() && std::abs(tile.level - sLight.level) > 1) {
+            m_atlasAllocator.free(tile);
+            tile = ShadowAtlasTile();
+        }
+    }
 
-    // Assign priorities and shadow atlas indices
-    std::array<unsigned int, LightPriority::Count> currentShadowMapCounts = {0, 0, 0};
+    // Release tiles of lights that are not rendered anymore
+    for (auto it = m_shadowTiles.begin(); it != m_shadowTiles.end();) {
+        if (it->second.lastUsedFrame != m_frame) {
+            m_atlasAllocator.free(it->second.tile);
+            it = m_shadowTiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-    outputBuffer.clear();
-    for (const auto& sLight : scoredLights) {
-        for (int prio = LightPriority::High; prio <= LightPriority::Low; prio++) {
-            if (currentShadowMapCounts[prio] < maxShadowMapsPerPriority[prio]) {
-                sLight.valPtr->setPriotity(static_cast<LightPriority>(prio));
-                sLight.valPtr->setShadowAtlasIndex(currentShadowMapCounts[prio]++);
-                outputBuffer.push_back(sLight.valPtr);
+    // Allocate missing tiles in score order, falling back to smaller tiles and evicting the lowest scored lights
+    for (size_t i = 0; i < scoredLights.size(); i++) {
+        ScoredLight& sLight = scoredLights[i];
+        if (sLight.assignment->tile.isValid()) continue;
+
+        size_t evictCandidate = scoredLights.size();
+        while (true) {
+            ShadowAtlasTile tile;
+            for (int level = sLight.level; level < m_atlasAllocator.levelCount() && !tile.isValid(); level++) {
+                tile = m_atlasAllocator.allocate(level);
+            }
+            if (tile.isValid()) {
+                assignTile(*sLight.assignment, tile);
                 break;
             }
+
+            while (evictCandidate > i + 1 && !scoredLights[evictCandidate - 1].assignment->tile.isValid()) {
+                evictCandidate--;
+            }
+            if (evictCandidate <= i + 1) break;
+
+            ShadowAtlasTile& evicted = scoredLights[--evictCandidate].assignment->tile;
+            m_atlasAllocator.free(evicted);
+            evicted = ShadowAtlasTile();
         }
     }
 
-    return currentShadowMapCounts;
+    int tileUnit = static_cast<int>(getShadowTileUnit());
+    outputBuffer.clear();
+    for (const ScoredLight& sLight : scoredLights) {
+        const ShadowAtlasTile& tile = sLight.assignment->tile;
+        if (!tile.isValid()) continue;  // No space left, the light is not rendered
+
+        int tileSize = m_atlasAllocator.tileSize(tile.level);
+        sLight.valPtr->setShadowTile(static_cast<unsigned int>(tile.page), packShadowTile(tile, tileSize, tileUnit));
+        outputBuffer.push_back(sLight.valPtr);
+    }
 }
 
-LightProcessor::LightProcessor() : m_totalSupportedLights(0) {
+LightProcessor::LightProcessor()
+    : m_totalSupportedLights(MAX_LIGHTS),
+      m_atlasAllocator(SHADOW_ATLAS_PAGES, SHADOWMAP_ATLAS_RESOLUTION, MIN_SHADOWMAP_SIZE),
+      m_frame(0),
+      m_shadowQuality(1.0f),
+      m_shadowTileCachingEnabled(true),
+      m_reusedShadowTiles(0),
+      m_redrawnShadowTiles(0),
+      m_reassignedShadowTiles(0) {
     // Create buffers for shadowmapping
-    m_shadowMapAtlases[LightPriority::High] = FrameBuffer::create();
-    m_shadowMapAtlases[LightPriority::High].attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Depth,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-    m_shadowMapSizes[LightPriority::High] = HIGHPRIO_SHADOWMAP_SIZE;
-    m_shadowMapAtlases[LightPriority::Medium] = FrameBuffer::create();
-    m_shadowMapAtlases[LightPriority::Medium].attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Depth,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-    m_shadowMapSizes[LightPriority::Medium] = MEDIUMPRIO_SHADOWMAP_SIZE;
-    m_shadowMapAtlases[LightPriority::Low] = FrameBuffer::create();
-    m_shadowMapAtlases[LightPriority::Low].attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Depth,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            SHADOWMAP_ATLAS_RESOLUTION,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-    m_shadowMapSizes[LightPriority::Low] = LOWPRIO_SHADOWMAP_SIZE;
-
-    m_totalSupportedLights = 0;
-    for (int i = 0; i < LightPriority::Count; i++) {
-        m_maxShadowMapsPerPriority[i] = m_shadowMapAtlases[i].getAttachedDepthTexture()->width() / m_shadowMapSizes[i];
-        m_maxShadowMapsPerPriority[i] *= m_maxShadowMapsPerPriority[i];
-        m_totalSupportedLights += m_maxShadowMapsPerPriority[i];
+    for (int page = 0; page < SHADOW_ATLAS_PAGES; page++) {
+        m_shadowMapAtlases[page] = FrameBuffer::create();
+        m_shadowMapAtlases[page].attachTexture(
+            std::make_shared<Texture>(Texture::create(
+                TextureType::Depth,
+                SHADOWMAP_ATLAS_RESOLUTION,
+                SHADOWMAP_ATLAS_RESOLUTION,
+                1,
+                nullptr,
+                TextureFilter::Nearest,
+                TextureWrap::ClampToEdge
+            ))
+        );
     }
 
     m_lightViewProjectionBuffer.reserve(m_totalSupportedLights);
@@ -119,25 +186,44 @@ LightProcessor::LightProcessor() : m_totalSupportedLights(0) {
     m_lightViewProjectionUniformBuffer = UniformBuffer::create(nullptr, m_totalSupportedLights * sizeof(glm::mat4));
 }
 
-void LightProcessor::clearShadowMaps() {
-    for (int i = 0; i < LightPriority::Count; i++) {
-        m_shadowMapAtlases[i].bind();
-        GLCALL(glClear(GL_DEPTH_BUFFER_BIT));
+bool LightProcessor::prepareShadowTile(const Light* light, uint64_t signature) {
+    auto it = m_shadowTiles.find(light);
+    if (it == m_shadowTiles.end() || !it->second.tile.isValid()) return false;
+
+    // Tiles are only redrawn if the light moved, got another tile or any caster changed
+    ShadowTileAssignment& assignment = it->second;
+    bool reusable = m_shadowTileCachingEnabled && signature != UNCACHEABLE_SHADOW_TILE;
+    if (reusable && assignment.signature == signature) {
+        m_reusedShadowTiles++;
+        return false;
     }
+    assignment.signature = reusable ? signature : UNCACHEABLE_SHADOW_TILE;
+    m_redrawnShadowTiles++;
+
+    const ShadowAtlasTile& tile = assignment.tile;
+    int tileSize = m_atlasAllocator.tileSize(tile.level);
+    int x = tile.x * tileSize;
+    int y = tile.y * tileSize;
+
+    m_shadowMapAtlases[tile.page].bind();
+    GLStateCache::setViewport(x, y, tileSize, tileSize);
+
+    // Only clear this tile, the other tiles of the atlas may still be valid
+    GLStateCache::setScissorTest(true);
+    GLStateCache::setScissor(x, y, tileSize, tileSize);
+    GLCALL(glClear(GL_DEPTH_BUFFER_BIT));
+    return true;
 }
 
-void LightProcessor::prepareShadowPass(const Light* light) {
-    LightPriority prio = light->getPriotity();
-    int atlasBufferSize = m_shadowMapAtlases[prio].getAttachedDepthTexture()->width();
-    int tileSize = m_shadowMapSizes[prio];
-    int atlasIndex = light->getShadowAtlasIndex();
-
-    int tilesPerRow = atlasBufferSize / tileSize;
-    int x = (atlasIndex % tilesPerRow) * tileSize;
-    int y = (atlasIndex / tilesPerRow) * tileSize;
+void LightProcessor::finishShadowTiles() { GLStateCache::setScissorTest(false); }
 
-    m_shadowMapAtlases[prio].bind();
-    GLCALL(glViewport(x, y, tileSize, tileSize));
+void LightProcessor::takeShadowTileCounts(int& reused, int& redrawn, int& reassigned) {
+    reused = m_reusedShadowTiles;
+    redrawn = m_redrawnShadowTiles;
+    reassigned = m_reassignedShadowTiles;
+    m_reusedShadowTiles = 0;
+    m_redrawnShadowTiles = 0;
+    m_reassignedShadowTiles = 0;
 }
 
 void LightProcessor::updateBuffers(const std::vector<Light*>& activeLights) {
@@ -155,9 +241,9 @@ void LightProcessor::updateBuffers(const std::vector<Light*>& activeLights) {
     );
 }
 
-std::array<Texture*, LightPriority::Count> LightProcessor::getShadowMapAtlases() const {
-    std::array<Texture*, LightPriority::Count> shadowMapsTextures;
-    for (int i = 0; i < LightPriority::Count; i++) {
+std::array<Texture*, SHADOW_ATLAS_PAGES> LightProcessor::getShadowMapAtlases() const {
+    std::array<Texture*, SHADOW_ATLAS_PAGES> shadowMapsTextures;
+    for (int i = 0; i < SHADOW_ATLAS_PAGES; i++) {
         shadowMapsTextures[i] = m_shadowMapAtlases[i].getAttachedDepthTexture().get();
     }
     return shadowMapsTextures;
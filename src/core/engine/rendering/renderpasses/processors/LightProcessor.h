@@ -2,22 +2,45 @@
 #define TOOMANYBLOCKS_LIGHTPROCESSOR_H
 
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <unordered_map>
 #include <vector>
 
 #include "engine/env/lights/Light.h"
 #include "engine/rendering/lowlevelapi/FrameBuffer.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
 #include "engine/rendering/lowlevelapi/UniformBuffer.h"
+#include "engine/rendering/renderpasses/processors/ShadowAtlasAllocator.h"
 
 struct RenderContext;
 
 class LightProcessor {
+public:
+    // Signature of shadow tiles that must be redrawn every frame
+    static constexpr uint64_t UNCACHEABLE_SHADOW_TILE = 0;
+
 private:
+    // Atlas tile owned by a light, kept across frames so cached shadows stay valid
+    struct ShadowTileAssignment {
+        ShadowAtlasTile tile;
+        uint64_t signature = UNCACHEABLE_SHADOW_TILE;
+        uint64_t lastUsedFrame = 0;
+    };
+
     size_t m_totalSupportedLights;
-    std::array<FrameBuffer, LightPriority::Count> m_shadowMapAtlases;
-    std::array<unsigned int, LightPriority::Count> m_shadowMapSizes;
-    std::array<unsigned int, LightPriority::Count> m_maxShadowMapsPerPriority;
+    std::array<FrameBuffer, SHADOW_ATLAS_PAGES> m_shadowMapAtlases;
+    ShadowAtlasAllocator m_atlasAllocator;
+    std::unordered_map<const Light*, ShadowTileAssignment> m_shadowTiles;
+    uint64_t m_frame;
+
+    // Scales all requested tile sizes to keep the shadow pass within its time budget
+    float m_shadowQuality;
+
+    bool m_shadowTileCachingEnabled;
+    int m_reusedShadowTiles;
+    int m_redrawnShadowTiles;
+    int m_reassignedShadowTiles;
 
     std::vector<GPULight> m_lightBuffer;
     UniformBuffer m_lightUniformBuffer;
@@ -25,32 +48,58 @@ private:
     std::vector<glm::mat4> m_lightViewProjectionBuffer;
     UniformBuffer m_lightViewProjectionUniformBuffer;
 
+    int tileLevelForLight(const Light* light, const RenderContext& context) const;
+
+    void assignTile(ShadowTileAssignment& assignment, const ShadowAtlasTile& tile);
+
 public:
-    static std::array<unsigned int, LightPriority::Count> prioritizeLights(
+    LightProcessor();
+
+    /**
+     * Picks the lights to render, ordered by how much they contribute to the camera view, and assigns their shadow
+     * atlas tiles. Tile sizes follow the projected size of a light on screen, lights keep their tile as long as the
+     * wanted size stays close to it.
+     *
+     * @param lastShadowPassMs Duration of the previous shadow pass, used to adapt tile sizes to the time budget.
+     */
+    void assignShadowTiles(
         const std::vector<Light*>& lights,
         std::vector<Light*>& outputBuffer,
-        const std::array<unsigned int, LightPriority::Count>& maxShadowMapsPerPriority,
-        const RenderContext& context
+        const RenderContext& context,
+        float lastShadowPassMs
     );
 
-    LightProcessor();
+    // Binds and clears the atlas tile of a light for drawing. Returns false if the tile already holds the shadow
+    // of the given signature, which covers the light view and all casters drawn into it.
+    bool prepareShadowTile(const Light* light, uint64_t signature);
 
-    void clearShadowMaps();
+    // Restores state changed while drawing shadow tiles
+    void finishShadowTiles();
 
-    void prepareShadowPass(const Light* light);
+    void takeShadowTileCounts(int& reused, int& redrawn, int& reassigned);
 
     void updateBuffers(const std::vector<Light*>& activeLights);
 
-    std::array<Texture*, LightPriority::Count> getShadowMapAtlases() const;
+    std::array<Texture*, SHADOW_ATLAS_PAGES> getShadowMapAtlases() const;
 
     inline size_t totalSupportedLights() const { return m_totalSupportedLights; }
 
-    inline const std::array<unsigned int, LightPriority::Count>& getShadowMapSizes() const { return m_shadowMapSizes; }
-
-    inline const std::array<unsigned int, LightPriority::Count>& getShadowMapCounts() const {
-        return m_maxShadowMapsPerPriority;
+    // Size of the smallest tile, shaders receive tile positions and sizes in multiples of it
+    inline unsigned int getShadowTileUnit() const {
+        return static_cast<unsigned int>(m_atlasAllocator.tileSize(m_atlasAllocator.levelCount() - 1));
     }
 
+    inline float getShadowAtlasUsage() const { return m_atlasAllocator.usage(); }
+
+    inline float getShadowQuality() const { return m_shadowQuality; }
+
+    inline bool isShadowTileCachingEnabled() const { return m_shadowTileCachingEnabled; }
+
+    inline void setShadowTileCachingEnabled(bool enabled) { m_shadowTileCachingEnabled = enabled; }
+
+    // Lights as uploaded by the last call to updateBuffers()
+    inline const std::vector<GPULight>& getLightBuffer() const { return m_lightBuffer; }
+
     inline const UniformBuffer* getShaderLightUniformBuffer() const { return &m_lightUniformBuffer; }
 
     inline const UniformBuffer* getLightViewProjectionUniformBuffer() const {
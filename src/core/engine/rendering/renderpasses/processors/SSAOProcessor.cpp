@@ -12,82 +12,29 @@
 #include "engine/GameInstance.h"
 #include "engine/entity/Player.h"
 #include "engine/rendering/GLUtils.h"
+#include "engine/rendering/lowlevelapi/GLStateCache.h"
 #include "engine/resource/loaders/ShaderLoader.h"
 
 static constexpr float PI = 3.14159265f;
 static constexpr size_t NOISE_TEXTURE_SIZE = 4U;
 
-void SSAOProcessor::createBuffers() {
-    m_ssaoGBuffer.clearAttachedTextures();
-    m_ssaoGBuffer.attachTexture( // Position render target
-        std::make_shared<Texture>(Texture::create(TextureType::Float16, m_ssaoBufferWidth, m_ssaoBufferHeight, 3))
-    );
-    m_ssaoGBuffer.attachTexture( // Normals render target
-        std::make_shared<Texture>(Texture::create(TextureType::Float16, m_ssaoBufferWidth, m_ssaoBufferHeight, 3))
-    );
-    m_ssaoGBuffer.attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Depth,
-            m_ssaoBufferWidth,
-            m_ssaoBufferHeight,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-
-    m_ssaoPassBuffer.clearAttachedTextures();
-    m_ssaoPassBuffer.attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Float16,
-            m_ssaoBufferWidth,
-            m_ssaoBufferHeight,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-
-    m_ssaoBlurBuffer.clearAttachedTextures();
-    m_ssaoBlurBuffer.attachTexture(
-        std::make_shared<Texture>(Texture::create(
-            TextureType::Float16,
-            m_ssaoBufferWidth,
-            m_ssaoBufferHeight,
-            1,
-            nullptr,
-            TextureFilter::Nearest,
-            TextureWrap::ClampToEdge
-        ))
-    );
-}
-
-SSAOProcessor::SSAOProcessor() : m_ssaoBufferWidth(0), m_ssaoBufferHeight(0), m_ssaoSamples(nullptr) {
-    ApplicationContext* context = Application::getContext();
-
+SSAOProcessor::SSAOProcessor()
+    : m_ssaoBufferWidth(0),
+      m_ssaoBufferHeight(0),
+      m_ssaoSamples(nullptr),
+      m_positionTarget(-1),
+      m_normalTarget(-1),
+      m_depthTarget(-1),
+      m_occlusionTarget(-1),
+      m_blurredOcclusionTarget(-1) {
     srand(time(NULL));
     m_ssaoGBuffer = FrameBuffer::create();
     m_ssaoPassBuffer = FrameBuffer::create();
     m_ssaoBlurBuffer = FrameBuffer::create();
-    validateBuffers(*context);
 
     // Random samples kernel in tagent space
     m_ssaoSamples = new glm::vec3[SSAO_SAMPLE_COUNT];
-    for (int i = 0; i < SSAO_SAMPLE_COUNT; i++) {
-        // Create random sample in hemisphere
-        glm::vec3 sample(
-            (float)rand() / RAND_MAX * 2.0f - 1.0f, (float)rand() / RAND_MAX * 2.0f - 1.0f, (float)rand() / RAND_MAX
-        );
-        sample = glm::normalize(sample);
-        sample *= (float)rand() / RAND_MAX;
-
-        // Scale sample points to cluster closer to origin
-        float scale = (float)i / static_cast<float>(SSAO_SAMPLE_COUNT);
-        sample *= glm::mix(0.1f, 1.0f, scale * scale);
-        m_ssaoSamples[i] = sample;
-    }
+    createKernel(m_ssaoSamples);
 
     // Random noise texture of 2D unit vectors
     size_t pixelCount = NOISE_TEXTURE_SIZE * NOISE_TEXTURE_SIZE;
@@ -122,26 +69,64 @@ SSAOProcessor::~SSAOProcessor() {
     }
 }
 
-void SSAOProcessor::validateBuffers(const ApplicationContext& context) {
-    unsigned int halfWidth = std::max<unsigned int>(context.state.screenWidth / 2, 2);
-    unsigned int halfHeight = std::max<unsigned int>(context.state.screenHeight / 2, 2);
-    if (m_ssaoBufferWidth != halfWidth || m_ssaoBufferHeight != halfHeight) {
-        m_ssaoBufferWidth = halfWidth;
-        m_ssaoBufferHeight = halfHeight;
-        createBuffers();
+void SSAOProcessor::createKernel(glm::vec3* samples) {
+    for (int i = 0; i < SSAO_SAMPLE_COUNT; i++) {
+        // Create random sample in hemisphere
+        glm::vec3 sample(
+            (float)rand() / RAND_MAX * 2.0f - 1.0f, (float)rand() / RAND_MAX * 2.0f - 1.0f, (float)rand() / RAND_MAX
+        );
+        sample = glm::normalize(sample);
+        sample *= (float)rand() / RAND_MAX;
+
+        // Scale sample points to cluster closer to origin
+        float scale = (float)i / static_cast<float>(SSAO_SAMPLE_COUNT);
+        sample *= glm::mix(0.1f, 1.0f, scale * scale);
+        samples[i] = sample;
+    }
+}
+
+void SSAOProcessor::declareTargets(RenderGraphBuilder& builder) {
+    TransientTextureDesc gBufferDesc = {TextureType::Float16, 3, TransientTextureSize::HalfScreen};
+    TransientTextureDesc occlusionDesc = {
+        TextureType::Float16, 1, TransientTextureSize::HalfScreen, TextureFilter::Nearest, TextureWrap::ClampToEdge
+    };
+    m_positionTarget = builder.createTexture("SSAO positions", gBufferDesc);
+    m_normalTarget = builder.createTexture("SSAO normals", gBufferDesc);
+    m_depthTarget = builder.createTexture(
+        "SSAO depth",
+        {TextureType::Depth, 1, TransientTextureSize::HalfScreen, TextureFilter::Nearest, TextureWrap::ClampToEdge}
+    );
+    m_occlusionTarget = builder.createTexture("SSAO occlusion", occlusionDesc);
+    m_blurredOcclusionTarget = builder.createTexture("Ambient occlusion", occlusionDesc);
+}
+
+void SSAOProcessor::attachTargets(const RenderGraph& graph) {
+    graph.attachTargets(m_ssaoGBuffer, {m_positionTarget, m_normalTarget, m_depthTarget});
+    graph.attachTargets(m_ssaoPassBuffer, {m_occlusionTarget});
+    graph.attachTargets(m_ssaoBlurBuffer, {m_blurredOcclusionTarget});
+
+    const Texture& positions = *m_ssaoGBuffer.getAttachedTextures().at(0);
+    m_ssaoBufferWidth = positions.width();
+    m_ssaoBufferHeight = positions.height();
+}
+
+void SSAOProcessor::releaseTargets() {
+    // Lets the graph delete the pooled textures while the pass stays culled
+    for (FrameBuffer* frameBuffer : {&m_ssaoGBuffer, &m_ssaoPassBuffer, &m_ssaoBlurBuffer}) {
+        if (!frameBuffer->getAttachedTextures().empty()) frameBuffer->clearAttachedTextures();
     }
 }
 
 void SSAOProcessor::prepareSSAOGBufferPass(const ApplicationContext& context) {
     m_ssaoGBuffer.bind();
     GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-    GLCALL(glViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight));
+    GLStateCache::setViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight);
 }
 
 void SSAOProcessor::prepareSSAOPass(const ApplicationContext& context) {
     m_ssaoPassBuffer.bind();
     GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-    GLCALL(glViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight));
+    GLStateCache::setViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight);
 
     m_ssaoPassShader.use();
     m_ssaoGBuffer.getAttachedTextures().at(0)->bindToUnit(0);
@@ -160,7 +145,7 @@ void SSAOProcessor::prepareSSAOPass(const ApplicationContext& context) {
 void SSAOProcessor::prepareSSAOBlurPass(const ApplicationContext& context) {
     m_ssaoBlurBuffer.bind();
     GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-    GLCALL(glViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight));
+    GLStateCache::setViewport(0, 0, m_ssaoBufferWidth, m_ssaoBufferHeight);
 
     m_ssaoBlurShader.use();
     m_ssaoPassBuffer.getAttachedTextures().at(0)->bindToUnit(0);
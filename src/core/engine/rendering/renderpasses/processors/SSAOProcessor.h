@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <memory>
 
+#include "engine/rendering/RenderGraph.h"
 #include "engine/rendering/lowlevelapi/FrameBuffer.h"
 #include "engine/rendering/lowlevelapi/Shader.h"
 #include "engine/rendering/lowlevelapi/Texture.h"
@@ -14,6 +15,15 @@
 
 struct ApplicationContext;
 
+// Low and Medium reconstruct positions from the opaque depth at half resolution and accumulate their samples over
+// frames. High draws the chunks into a separate geometry buffer and takes every sample each frame.
+enum class SSAOQuality {
+    Off,
+    Low,
+    Medium,
+    High,
+};
+
 class SSAOProcessor {
 private:
     unsigned int m_ssaoBufferWidth;
@@ -26,13 +36,23 @@ private:
     Texture m_ssaoNoiseTexture;
     glm::vec3* m_ssaoSamples;
 
-    void createBuffers();
+    RenderGraphResource m_positionTarget;
+    RenderGraphResource m_normalTarget;
+    RenderGraphResource m_depthTarget;
+    RenderGraphResource m_occlusionTarget;
+    RenderGraphResource m_blurredOcclusionTarget;
 
 public:
     SSAOProcessor();
     ~SSAOProcessor();
 
-    void validateBuffers(const ApplicationContext& context);
+    // Fills SSAO_SAMPLE_COUNT tangent space samples of the hemisphere, denser towards its origin
+    static void createKernel(glm::vec3* samples);
+
+    // Only the blurred occlusion outlives the pass, the other targets are released to the graph right after it
+    void declareTargets(RenderGraphBuilder& builder);
+    void attachTargets(const RenderGraph& graph);
+    void releaseTargets();
     void prepareSSAOGBufferPass(const ApplicationContext& context);
     void prepareSSAOPass(const ApplicationContext& context);
     void prepareSSAOBlurPass(const ApplicationContext& context);
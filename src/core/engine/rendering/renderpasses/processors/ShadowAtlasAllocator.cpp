@@ -0,0 +1,100 @@
+#include "ShadowAtlasAllocator.h"
+
+#include <stdexcept>
+
+ShadowAtlasAllocator::ShadowAtlasAllocator(int pageCount, int pageSize, int minTileSize)
+    : m_pageSize(pageSize), m_levelCount(1), m_usedArea(0) {
+    if (minTileSize <= 0 || pageSize < minTileSize) throw std::runtime_error("Invalid shadow atlas tile size");
+
+    while ((minTileSize << (m_levelCount - 1)) < pageSize) {
+        m_levelCount++;
+    }
+    if ((minTileSize << (m_levelCount - 1)) != pageSize) {
+        throw std::runtime_error("Shadow atlas page size must be a power of two multiple of the tile size");
+    }
+
+    m_pages.assign(pageCount, std::vector<NodeState>(levelOffset(m_levelCount), Free));
+}
+
+bool ShadowAtlasAllocator::allocateInNode(
+    int page, int level, int x, int y, int targetLevel, bool allowSplit, ShadowAtlasTile& tile
+) {
+    NodeState& state = node(page, level, x, y);
+    if (level == targetLevel) {
+        if (state != Free) return false;
+
+        state = Used;
+        tile = {page, level, x, y};
+        return true;
+    }
+
+    if (state == Used) return false;
+    if (state == Free) {
+        if (!allowSplit) return false;
+        // Children of a free node are always free
+        state = Split;
+    }
+
+    for (int child = 0; child < 4; child++) {
+        int childX = x * 2 + (child & 1);
+        int childY = y * 2 + (child >> 1);
+        if (allocateInNode(page, level + 1, childX, childY, targetLevel, allowSplit, tile)) return true;
+    }
+
+    if (allowSplit && node(page, level + 1, x * 2, y * 2) == Free && node(page, level + 1, x * 2 + 1, y * 2) == Free &&
+        node(page, level + 1, x * 2, y * 2 + 1) == Free && node(page, level + 1, x * 2 + 1, y * 2 + 1) == Free) {
+        // Undo the split, nothing fit below
+        state = Free;
+    }
+    return false;
+}
+
+ShadowAtlasTile ShadowAtlasAllocator::allocate(int level) {
+    ShadowAtlasTile tile;
+    if (level < 0 || level >= m_levelCount) return tile;
+
+    // Fill holes in split nodes first, so free nodes stay available for large tiles
+    for (bool allowSplit : {false, true}) {
+        for (int page = 0; page < static_cast<int>(m_pages.size()); page++) {
+            if (allocateInNode(page, 0, 0, 0, level, allowSplit, tile)) {
+                m_usedArea += 1 << (2 * (m_levelCount - 1 - level));
+                return tile;
+            }
+        }
+    }
+    return tile;
+}
+
+void ShadowAtlasAllocator::free(const ShadowAtlasTile& tile) {
+    if (!tile.isValid()) return;
+
+    NodeState& state = node(tile.page, tile.level, tile.x, tile.y);
+    if (state != Used) return;
+    state = Free;
+    m_usedArea -= 1 << (2 * (m_levelCount - 1 - tile.level));
+
+    // Merge free siblings back into their parents
+    int level = tile.level;
+    int x = tile.x & ~1;
+    int y = tile.y & ~1;
+    while (level > 0) {
+        if (node(tile.page, level, x, y) != Free || node(tile.page, level, x + 1, y) != Free ||
+            node(tile.page, level, x, y + 1) != Free || node(tile.page, level, x + 1, y + 1) != Free) {
+            break;
+        }
+
+        level--;
+        x /= 2;
+        y /= 2;
+        node(tile.page, level, x, y) = Free;
+        x &= ~1;
+        y &= ~1;
+    }
+}
+
+float ShadowAtlasAllocator::usage() const {
+    if (m_pages.empty()) return 0.0f;
+
+    float pageArea = static_cast<float>(1 << (2 * (m_levelCount - 1)));
+    return static_cast<float>(m_usedArea) / (pageArea * static_cast<float>(m_pages.size()));
+}
@@ -0,0 +1,73 @@
+#ifndef TOOMANYBLOCKS_SHADOWATLASALLOCATOR_H
+#define TOOMANYBLOCKS_SHADOWATLASALLOCATOR_H
+
+#include <cstdint>
+#include <vector>
+
+struct ShadowAtlasTile {
+    int page = -1;
+    int level = 0;  // Level 0 covers the whole page, each level halves the tile size
+    int x = 0;      // Position in tiles of this level
+    int y = 0;
+
+    inline bool isValid() const { return page >= 0; }
+};
+
+/**
+ * @brief Quadtree allocator for square power of two tiles in a set of equally sized atlas pages.
+ *
+ * Every node of the quadtree is either free, split into four children or used by one tile. Freeing a tile merges
+ * its siblings back into their parent once all of them are free, so large tiles become available again.
+ */
+class ShadowAtlasAllocator {
+private:
+    enum NodeState : uint8_t {
+        Free,
+        Split,
+        Used
+    };
+
+    int m_pageSize;
+    int m_levelCount;
+    std::vector<std::vector<NodeState>> m_pages;
+    int m_usedArea;  // In tiles of the deepest level
+
+    static inline int levelOffset(int level) { return ((1 << (2 * level)) - 1) / 3; }
+
+    inline NodeState& node(int page, int level, int x, int y) {
+        return m_pages[page][levelOffset(level) + y * (1 << level) + x];
+    }
+
+    bool allocateInNode(int page, int level, int x, int y, int targetLevel, bool allowSplit, ShadowAtlasTile& tile);
+
+public:
+    ShadowAtlasAllocator() : m_pageSize(0), m_levelCount(0), m_usedArea(0) {}
+
+    /**
+     * @param pageCount Number of atlas pages.
+     * @param pageSize Size of a page in texels.
+     * @param minTileSize Smallest tile size in texels, pageSize must be a power of two multiple of it.
+     */
+    ShadowAtlasAllocator(int pageCount, int pageSize, int minTileSize);
+
+    /**
+     * @brief Allocates a tile, preferring space in already split nodes over splitting free ones.
+     *
+     * @param level Level of the tile, its size is pageSize >> level.
+     * @return The tile, invalid if no page has space left.
+     */
+    ShadowAtlasTile allocate(int level);
+
+    void free(const ShadowAtlasTile& tile);
+
+    inline int pageSize() const { return m_pageSize; }
+
+    inline int levelCount() const { return m_levelCount; }
+
+    inline int tileSize(int level) const { return m_pageSize >> level; }
+
+    /** @return Fraction of the total atlas area in use. */
+    float usage() const;
+};
+
+#endif
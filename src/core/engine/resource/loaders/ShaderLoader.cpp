@@ -1,7 +1,46 @@
 #include "ShaderLoader.h"
 
+#include <stdexcept>
+
 #include "foundation/util/Utility.h"
 
+static const std::string INCLUDE_DIRECTIVE = "#include";
+
+/**
+ * Replaces #include "file" lines with the content of the file, relative to the directory containing all shaders.
+ * Includes are resolved before compilation, so they are spliced in even when inside a disabled #ifdef block.
+ */
+static std::string resolveIncludes(const std::string& source, const std::filesystem::path& shaderRoot) {
+    std::string resolved;
+    resolved.reserve(source.size());
+
+    size_t lineStart = 0;
+    while (lineStart < source.size()) {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = source.size();
+
+        size_t directivePos = source.find_first_not_of(" \t", lineStart);
+        bool isInclude = directivePos < lineEnd &&
+                         source.compare(directivePos, INCLUDE_DIRECTIVE.size(), INCLUDE_DIRECTIVE) == 0;
+        if (isInclude) {
+            size_t nameStart = source.find('"', directivePos);
+            size_t nameEnd = nameStart < lineEnd ? source.find('"', nameStart + 1) : std::string::npos;
+            if (nameEnd >= lineEnd) {
+                throw std::runtime_error("Malformed shader include: " + source.substr(lineStart, lineEnd - lineStart));
+            }
+            std::filesystem::path includePath = shaderRoot / source.substr(nameStart + 1, nameEnd - nameStart - 1);
+            resolved += resolveIncludes(readFile(includePath), shaderRoot);
+            if (!resolved.empty() && resolved.back() != '\n') resolved += '\n';
+        } else {
+            resolved.append(source, lineStart, lineEnd - lineStart);
+            if (lineEnd < source.size()) resolved += '\n';
+        }
+        lineStart = lineEnd + 1;
+    }
+
+    return resolved;
+}
+
 CPUShader loadShaderFromFile(const std::string& shaderPath, ShaderLoadOption option) {
     CPUShader shader;
 
@@ -10,15 +49,17 @@ CPUShader loadShaderFromFile(const std::string& shaderPath, ShaderLoadOption opt
     if (pos != std::string::npos) {
         basename = shaderPath.substr(pos + 1);
     }
+    // Every shader lives in its own directory, shared sources next to those directories
+    std::filesystem::path shaderRoot = std::filesystem::path(shaderPath).parent_path();
 
     if (option == ShaderLoadOption::VertexAndFragment || option == ShaderLoadOption::VertexOnly) {
         std::string vertFile = shaderPath + "/" + basename + ".vert";
-        shader.vertexShader = readFile(vertFile);
+        shader.vertexShader = resolveIncludes(readFile(vertFile), shaderRoot);
     }
     if (option == ShaderLoadOption::VertexAndFragment || option == ShaderLoadOption::FragmentOnly) {
         std::string fragFile = shaderPath + "/" + basename + ".frag";
-        shader.fragmentShader = readFile(fragFile);
+        shader.fragmentShader = resolveIncludes(readFile(fragFile), shaderRoot);
     }
 
     return shader;
-}
\ No newline at end of file
+}
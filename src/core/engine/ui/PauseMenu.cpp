@@ -5,6 +5,8 @@
 #include "Application.h"
 #include "engine/GameInstance.h"
 #include "engine/controllers/PlayerController.h"
+#include "engine/env/World.h"
+#include "engine/rendering/Renderer.h"
 
 namespace UI {
     void UI::PauseMenu::render() {
@@ -20,7 +22,7 @@ namespace UI {
                                         ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar;
 
         ImVec2 screenSize = ImGui::GetIO().DisplaySize;
-        ImVec2 windowSize = ImVec2(300, 200);  // Customize as needed
+        ImVec2 windowSize = ImVec2(300, 420);  // Customize as needed
         ImVec2 windowPos = ImVec2((screenSize.x - windowSize.x) * 0.5f, (screenSize.y - windowSize.y) * 0.5f);
 
         ImGui::SetNextWindowPos(windowPos, ImGuiCond_Always);
@@ -38,6 +40,44 @@ namespace UI {
                 context->instance->gameState.gamePaused = false;
                 navigateToWidget("GameOverlay");
             }
+            bool quadMeshes = context->instance->m_world->getChunkMeshFormat() == ChunkMeshFormat::Quads;
+            if (ImGui::Checkbox("Quad chunk meshes", &quadMeshes)) {
+                context->instance->m_world->setChunkMeshFormat(
+                    quadMeshes ? ChunkMeshFormat::Quads : ChunkMeshFormat::Vertices
+                );
+            }
+            bool occlusionCulling = context->renderer->isChunkOcclusionCullingEnabled();
+            if (ImGui::Checkbox("Chunk occlusion culling", &occlusionCulling)) {
+                context->renderer->setChunkOcclusionCullingEnabled(occlusionCulling);
+            }
+            bool shadowTileCaching = context->renderer->isShadowTileCachingEnabled();
+            if (ImGui::Checkbox("Shadow tile caching", &shadowTileCaching)) {
+                context->renderer->setShadowTileCachingEnabled(shadowTileCaching);
+            }
+            bool clusteredShading = context->renderer->isClusteredShadingEnabled();
+            if (ImGui::Checkbox("Clustered light culling", &clusteredShading)) {
+                context->renderer->setClusteredShadingEnabled(clusteredShading);
+            }
+            // Baked occlusion replaces ssao, so its passes are culled on machines that can not afford them
+            SSAOQuality ssaoQuality = context->renderer->getSSAOQuality();
+            int ambientOcclusion = ssaoQuality != SSAOQuality::Off ? static_cast<int>(ssaoQuality) + 1 : 0;
+            if (context->instance->m_world->isBakedAmbientOcclusionEnabled()) ambientOcclusion = 1;
+            if (ImGui::Combo(
+                    "Ambient occlusion", &ambientOcclusion, "Off\0Baked\0SSAO Low\0SSAO Medium\0SSAO High\0"
+                )) {
+                context->instance->m_world->setBakedAmbientOcclusionEnabled(ambientOcclusion == 1);
+                context->renderer->setSSAOQuality(
+                    ambientOcclusion >= 2 ? static_cast<SSAOQuality>(ambientOcclusion - 1) : SSAOQuality::Off
+                );
+            }
+            bool lightStressTest = context->instance->isLightStressTestEnabled();
+            if (ImGui::Checkbox("Light stress test", &lightStressTest)) {
+                context->instance->setLightStressTestEnabled(lightStressTest);
+            }
+            bool propStressTest = context->instance->isPropStressTestEnabled();
+            if (ImGui::Checkbox("Prop stress test", &propStressTest)) {
+                context->instance->setPropStressTestEnabled(propStressTest);
+            }
             if (ImGui::Button("Exit", ImVec2(-1, 0))) {
                 context->instance->gameState.gamePaused = false;
                 context->instance->deinitWorld();
@@ -11,6 +11,7 @@
 #include "engine/entity/Entity.h"
 #include "engine/rendering/Renderer.h"
 #include "engine/ui/UiUtil.h"
+#include "foundation/threading/CancellationToken.h"
 #include "foundation/util/PrettyPrint.h"
 #include "foundation/time/Timer.h"
 
@@ -69,6 +70,30 @@ void UI::StatScreen::render() {
         ImGui::Text("Loaded chunks: %lu", context->instance->m_world->loadedChunks().size());
         glm::ivec3 currChunkOrigin = Chunk::worldToChunkOrigin(playerPos);
         ImGui::Text("Current chunk origin: (%d,%d,%d)", currChunkOrigin.x, currChunkOrigin.y, currChunkOrigin.z);
+        const ChunkGeometryArena& arena = context->instance->m_world->chunkArena();
+        ImGui::Text(
+            "Chunk arena: %lu / %lu vertices (%lu free ranges)", arena.verticesInUse(), arena.vertexCapacity(),
+            arena.freeVertexRanges()
+        );
+        ImGui::Text("Chunk arena: %lu / %lu quads", arena.quadsInUse(), arena.quadCapacity());
+        const ChunkCache& chunkCache = context->instance->m_world->chunkCache();
+        ImGui::Text(
+            "Chunk cache: %s / %s (%lu chunks)", formatBytes(chunkCache.usedBytes(), ByteUnit::Bytes),
+            formatBytes(chunkCache.budget(), ByteUnit::Bytes), chunkCache.size()
+        );
+        ImGui::Text(
+            "Chunk cache: %lu hits | %lu misses | %lu evictions", chunkCache.hits(), chunkCache.misses(),
+            chunkCache.evictions()
+        );
+        ImGui::Text(
+            "Cancelled tasks: %lu skipped | %lu wasted", CancellationStats::skippedTasks.load(),
+            CancellationStats::wastedTasks.load()
+        );
+        ImGui::Text(
+            "Block snapshots: %s/s copied | %s/s shared",
+            formatBytes(context->stats.blockBytesCopiedPerSecond, ByteUnit::Bytes),
+            formatBytes(context->stats.blockBytesSharedPerSecond, ByteUnit::Bytes)
+        );
 
         ImGui::SeparatorText("Player");
         ImGui::Text("Player Position: x=%.1f, y=%.1f, z=%.1f", playerPos.x, playerPos.y, playerPos.z);
@@ -0,0 +1,46 @@
+#ifndef TOOMANYBLOCKS_CANCELLATIONTOKEN_H
+#define TOOMANYBLOCKS_CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Process wide counters of how cancellation affected scheduled tasks.
+ */
+struct CancellationStats {
+    // Tasks that were skipped because their token was cancelled before they started
+    static inline std::atomic<uint64_t> skippedTasks{0};
+    // Tasks that ran to completion although their token was cancelled in the meantime
+    static inline std::atomic<uint64_t> wastedTasks{0};
+};
+
+/**
+ * Shared flag that signals all futures holding a copy of the token that their result is no longer needed.
+ *
+ * Copies refer to the same flag, so one token can be handed to a whole chain of futures. An empty token
+ * (default constructed) can never be cancelled.
+ */
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+
+public:
+    static inline CancellationToken create() {
+        CancellationToken token;
+        token.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    CancellationToken() noexcept = default;
+
+    inline void cancel() const {
+        if (m_cancelled) m_cancelled->store(true, std::memory_order_relaxed);
+    }
+
+    inline bool isCancelled() const { return m_cancelled && m_cancelled->load(std::memory_order_relaxed); }
+
+    inline bool isEmpty() const { return !m_cancelled; }
+};
+
+#endif
@@ -13,6 +13,8 @@
 #include <stdexcept>
 #include <vector>
 
+#include "CancellationToken.h"
+
 constexpr uint64_t DEFAULT_TASKCONTEXT = 0;
 
 enum class Executor {
@@ -80,6 +82,8 @@ private:
         std::atomic<int> unresolvedDeps{0};
         std::vector<std::shared_ptr<FutureBase>> dependents;
 
+        CancellationToken cancelToken;
+
         std::function<T()> task;
         std::conditional_t<!std::is_void_v<T>, std::optional<T>, char> value;
         std::exception_ptr exception;
@@ -193,6 +197,21 @@ public:
         return *this;
     }
 
+    /**
+     * Ties this future to a cancellation token. Once the token is cancelled, the task is skipped if it has not
+     * started yet and the future fails like a canceled one. Tokens are checked right before the task runs, so
+     * handing the same token to every future of a chain stops the chain between stages.
+     */
+    inline Future<T>& cancelledBy(const CancellationToken& token) {
+        if (isEmpty()) throw std::runtime_error("Cannot add a cancellation token to an empty future");
+
+        if (state->status.load() != FutureStatus::Building)
+            throw std::runtime_error("Trying to add a cancellation token to a finalized future");
+
+        state->cancelToken = token;
+        return *this;
+    }
+
     inline Future<T>& start() {
         if (isEmpty()) throw std::runtime_error("Cannot start empty future");
 
@@ -216,6 +235,12 @@ public:
         std::function<T()> tmpTask = std::move(state->task);
         state->task = {};  // Force release of captures
 
+        if (state->cancelToken.isCancelled()) {
+            CancellationStats::skippedTasks.fetch_add(1, std::memory_order_relaxed);
+            completeFailure(std::make_exception_ptr(std::runtime_error("Task canceled")));
+            return;
+        }
+
         try {
             if constexpr (std::is_void_v<T>) {
                 tmpTask();
@@ -227,6 +252,10 @@ public:
         } catch (...) {
             completeFailure(std::current_exception());
         }
+
+        if (state->cancelToken.isCancelled()) {
+            CancellationStats::wastedTasks.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     virtual inline void cancel() override {
@@ -13,8 +13,8 @@ static_assert(
 );
 
 #define SET_BITS(target, value, bitmask, position) \
-    (target = (target & ~(bitmask << position)) | ((value & bitmask) << position))
-#define GET_BITS(target, bitmask, position) ((target >> position) & bitmask)
+    ((target) = ((target) & ~((bitmask) << (position))) | (((value) & (bitmask)) << (position)))
+#define GET_BITS(target, bitmask, position) (((target) >> (position)) & (bitmask))
 
 template <typename T>
 std::string bitString(const T& value) {
@@ -0,0 +1,76 @@
+#include "RangeAllocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(size_t capacity) : m_capacity(capacity), m_used(0) {
+    if (capacity > 0) m_freeRanges.emplace(0, capacity);
+}
+
+size_t RangeAllocator::allocate(size_t size) {
+    if (size == 0) return INVALID_OFFSET;
+
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it) {
+        if (it->second < size) continue;
+
+        size_t offset = it->first;
+        size_t remaining = it->second - size;
+        m_freeRanges.erase(it);
+        if (remaining > 0) {
+            m_freeRanges.emplace(offset + size, remaining);
+        }
+
+        m_used += size;
+        return offset;
+    }
+
+    return INVALID_OFFSET;
+}
+
+void RangeAllocator::free(size_t offset, size_t size) {
+    if (size == 0 || offset == INVALID_OFFSET) return;
+    if (offset + size > m_capacity) throw std::runtime_error("Freed range exceeds allocator capacity");
+
+    m_used -= size;
+
+    size_t mergedOffset = offset;
+    size_t mergedSize = size;
+    auto next = m_freeRanges.lower_bound(offset);
+
+    // Merge with preceding free range
+    if (next != m_freeRanges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            mergedOffset = prev->first;
+            mergedSize += prev->second;
+            m_freeRanges.erase(prev);
+        }
+    }
+
+    // Merge with following free range
+    if (next != m_freeRanges.end() && offset + size == next->first) {
+        mergedSize += next->second;
+        m_freeRanges.erase(next);
+    }
+
+    m_freeRanges.emplace(mergedOffset, mergedSize);
+}
+
+void RangeAllocator::grow(size_t newCapacity) {
+    if (newCapacity < m_capacity) throw std::runtime_error("Range allocator cannot shrink");
+    if (newCapacity == m_capacity) return;
+
+    size_t addedOffset = m_capacity;
+    size_t addedSize = newCapacity - m_capacity;
+    m_capacity = newCapacity;
+
+    // Append new space, merging with a free range that ends at the old capacity
+    if (!m_freeRanges.empty()) {
+        auto last = std::prev(m_freeRanges.end());
+        if (last->first + last->second == addedOffset) {
+            last->second += addedSize;
+            return;
+        }
+    }
+    m_freeRanges.emplace(addedOffset, addedSize);
+}
@@ -0,0 +1,59 @@
+#ifndef TOOMANYBLOCKS_RANGEALLOCATOR_H
+#define TOOMANYBLOCKS_RANGEALLOCATOR_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <map>
+
+/**
+ * @brief First fit sub-allocator managing ranges inside a linear address space (e.g. a gpu buffer).
+ *
+ * The allocator only does the bookkeeping, it never touches memory itself. Freed ranges are coalesced
+ * with their neighbours to keep fragmentation low.
+ */
+class RangeAllocator {
+private:
+    std::map<size_t, size_t> m_freeRanges;  // Offset -> size, ordered by offset for coalescing
+    size_t m_capacity;
+    size_t m_used;
+
+public:
+    static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+
+    RangeAllocator(size_t capacity = 0);
+
+    /**
+     * @brief Allocates a contiguous range using the first free range that is large enough.
+     *
+     * @param size Size of the range in elements.
+     * @return Offset of the allocated range, or INVALID_OFFSET if no free range is large enough.
+     */
+    size_t allocate(size_t size);
+
+    /**
+     * @brief Returns a previously allocated range and merges it with adjacent free ranges.
+     *
+     * @param offset Offset returned by allocate().
+     * @param size Size that was passed to allocate().
+     */
+    void free(size_t offset, size_t size);
+
+    /**
+     * @brief Extends the managed address space. The new space is appended as a free range.
+     *
+     * @param newCapacity New total capacity, must not be smaller than the current capacity.
+     */
+    void grow(size_t newCapacity);
+
+    /** @return Size of the managed address space. */
+    inline size_t capacity() const { return m_capacity; }
+
+    /** @return Sum of all currently allocated range sizes. */
+    inline size_t used() const { return m_used; }
+
+    /** @return Number of disjoint free ranges, a rough measure of fragmentation. */
+    inline size_t freeRangeCount() const { return m_freeRanges.size(); }
+};
+
+#endif